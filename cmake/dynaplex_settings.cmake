@@ -12,6 +12,14 @@ set(CMAKE_CXX_VISIBILITY_PRESET default)
 set(CMAKE_VISIBILITY_INLINES_HIDDEN OFF)
 set(CMAKE_INTERPROCEDURAL_OPTIMIZATION OFF)
 
+#hot loops in the type-erasure layer validate their inputs once per call, and then skip per-element checks. 
+#dynaplex_full_checks (and any Debug build) restores the per-element checks. 
+if(dynaplex_full_checks)
+add_compile_definitions(DP_FULL_CHECKS)
+else()
+add_compile_definitions($<$<CONFIG:Debug>:DP_FULL_CHECKS>)
+endif()
+
 #for succesfully linking on linux to desired paths, i.e. to enable GPU
 #note that this will require some manual steps and is not enabled for now. 
 #set(CMAKE_SKIP_RPATH TRUE)
@@ -0,0 +1,339 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <limits>
+#include <string>
+#include <vector>
+#include "dynaplex/dynaplexprovider.h"
+#include "dynaplex/vargroup.h"
+#include "dynaplex/modelling/discretedist.h"
+#include "dynaplex/sequentialhalving.h"
+#include "dynaplex/sample.h"
+
+/**
+ * Microbenchmarks for the hot paths of DynaPlex, for tracking performance regressions between releases.
+ *
+ * For every MDP registered in RegistrationManager::RegisterAll, and every mdp_config_*.json that is available for it under
+ * IO_DynaPlex/mdp_config_examples/<id>/, measures:
+ * - IncorporateUntilAction and IncorporateAction: steps per second (one step is one trajectory advanced by one call),
+ * - GetFlatFeatures: states per second and features per second,
+ * - Clone(): states per second,
+ * - SequentialHalving::SetAction: samples per second.
+ * In addition, DiscreteDist::GetSample, and DiscreteDist::GetSamples with an RNG and with a MultiLaneRNG, are timed for a
+ * number of distributions.
+ *
+ * Results are written as JSON in the layout of Google Benchmark (--benchmark_format=json), so that existing tooling for comparing
+ * runs can be used. Usage:
+ *   dynaplex_bench [--out=<file.json>] [--min_time=<seconds per benchmark>] [--filter=<substring of benchmark name>]
+ * By default, output is written to IO_DynaPlex/benchmarks/dynaplex_bench.json.
+ */
+
+using namespace DynaPlex;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+	struct Settings {
+		double min_time = 0.5;
+		std::string out_path;
+		std::string filter;
+		//number of trajectories that are advanced together, as in PolicyComparer.
+		int64_t num_trajectories = 64;
+		int64_t sh_M = 1000;
+		int64_t rng_seed = 15112017;
+	};
+
+	/// Outcome of a single timed iteration: time spent in the measured code, and number of items processed.
+	struct Timing {
+		double seconds;
+		int64_t items;
+	};
+
+	class Runner {
+	public:
+		explicit Runner(const Settings& settings) : settings{ settings } {}
+
+		/**
+		 * Calls iteration repeatedly until the measured time exceeds min_time (or the wall-clock time exceeds 10*min_time, which
+		 * happens if most time is spent in untimed setup). Records the result under name.
+		 */
+		void Run(const std::string& name, const std::function<Timing()>& iteration, int64_t features_per_item = 0)
+		{
+			if (!settings.filter.empty() && name.find(settings.filter) == std::string::npos)
+				return;
+			auto wall_start = Clock::now();
+			double seconds = 0.0;
+			int64_t items = 0, iterations = 0;
+			while (iterations == 0 || (seconds < settings.min_time
+				&& std::chrono::duration<double>(Clock::now() - wall_start).count() < 10 * settings.min_time))
+			{
+				auto timing = iteration();
+				seconds += timing.seconds;
+				items += timing.items;
+				iterations++;
+			}
+
+			double items_per_second = seconds > 0.0 ? items / seconds : 0.0;
+			DynaPlex::VarGroup result{
+				{"name", name},
+				{"run_type", "iteration"},
+				{"iterations", iterations},
+				{"real_time", seconds * 1e9 / iterations},
+				{"time_unit", "ns"},
+				{"items", items},
+				{"items_per_second", items_per_second}
+			};
+			if (features_per_item > 0)
+				result.Add("features_per_second", items_per_second * features_per_item);
+			benchmarks.push_back(result);
+			std::cout << name << ": " << items_per_second << " items/s" << std::endl;
+		}
+
+		const std::vector<DynaPlex::VarGroup>& Results() const
+		{
+			return benchmarks;
+		}
+
+	private:
+		Settings settings;
+		std::vector<DynaPlex::VarGroup> benchmarks;
+	};
+
+	template<typename Func>
+	double TimeSeconds(Func&& func)
+	{
+		auto start = Clock::now();
+		func();
+		return std::chrono::duration<double>(Clock::now() - start).count();
+	}
+
+	/// Lists the paths of the mdp_config_*.json files that are available for the MDP with this id.
+	std::vector<std::filesystem::path> ConfigFiles(const DynaPlex::System& system, const std::string& id)
+	{
+		std::vector<std::filesystem::path> files;
+		auto dir = std::filesystem::path(system.IOLocation()) / "mdp_config_examples" / id;
+		if (!std::filesystem::is_directory(dir))
+			return files;
+		for (const auto& entry : std::filesystem::directory_iterator(dir))
+		{
+			auto filename = entry.path().filename().string();
+			if (entry.is_regular_file() && filename.starts_with("mdp_config_") && entry.path().extension() == ".json")
+				files.push_back(entry.path());
+		}
+		std::sort(files.begin(), files.end());
+		return files;
+	}
+
+	/**
+	 * Advances the trajectories until all await an action, re-initiating trajectories that reach a final state.
+	 * Returns the time spent in IncorporateUntilAction.
+	 */
+	double AdvanceToAction(const DynaPlex::MDP& mdp, std::span<Trajectory> trajectories)
+	{
+		double seconds = 0.0;
+		bool all_await_action = false;
+		while (!all_await_action)
+		{
+			seconds += TimeSeconds([&]() { all_await_action = mdp->IncorporateUntilAction(trajectories); });
+			if (!all_await_action)
+				for (auto& traj : trajectories)
+					if (traj.Category.IsFinal())
+						mdp->InitiateState({ &traj,1 });
+		}
+		return seconds;
+	}
+
+	void BenchmarkMDP(Runner& runner, const Settings& settings, const DynaPlex::MDP& mdp, const std::string& prefix)
+	{
+		auto policy = mdp->GetPolicy("random");
+		int64_t n = settings.num_trajectories;
+
+		std::vector<Trajectory> trajectories(n);
+		for (int64_t i = 0; i < n; i++)
+			trajectories[i].RNGProvider.SeedEventStreams(true, settings.rng_seed, i);
+		mdp->InitiateState(trajectories);
+		AdvanceToAction(mdp, trajectories);
+
+		runner.Run(prefix + "/IncorporateUntilAction", [&]() {
+			policy->SetAction(trajectories);
+			mdp->IncorporateAction(trajectories);
+			return Timing{ AdvanceToAction(mdp, trajectories), n };
+			});
+
+		runner.Run(prefix + "/IncorporateAction", [&]() {
+			policy->SetAction(trajectories);
+			double seconds = TimeSeconds([&]() { mdp->IncorporateAction(trajectories); });
+			AdvanceToAction(mdp, trajectories);
+			return Timing{ seconds, n };
+			});
+
+		if (mdp->ProvidesFlatFeatures())
+		{
+			auto num_features = mdp->NumFlatFeatures();
+			std::vector<float> feats(num_features * n);
+			runner.Run(prefix + "/GetFlatFeatures", [&]() {
+				double seconds = TimeSeconds([&]() { mdp->GetFlatFeatures(trajectories, feats); });
+				policy->SetAction(trajectories);
+				mdp->IncorporateAction(trajectories);
+				AdvanceToAction(mdp, trajectories);
+				return Timing{ seconds, n };
+				}, num_features);
+		}
+
+		runner.Run(prefix + "/Clone", [&]() {
+			std::vector<DynaPlex::dp_State> clones(n);
+			double seconds = TimeSeconds([&]() {
+				for (int64_t i = 0; i < n; i++)
+					clones[i] = trajectories[i].GetState()->Clone();
+				});
+			return Timing{ seconds, n };
+			});
+
+		//sequential halving only applies to states with more than a single allowed action.
+		std::vector<Trajectory> sh_trajectory(1);
+		sh_trajectory[0].RNGProvider.SeedEventStreams(true, settings.rng_seed, n);
+		mdp->InitiateState(sh_trajectory);
+		int64_t attempts = 0;
+		while (true)
+		{
+			AdvanceToAction(mdp, sh_trajectory);
+			if (mdp->CountAllowedActions(sh_trajectory[0].GetState()) > 1)
+				break;
+			if (++attempts > 10000)
+				break;
+			policy->SetAction(sh_trajectory);
+			mdp->IncorporateAction(sh_trajectory);
+		}
+		if (attempts <= 10000)
+		{
+			int64_t H = mdp->IsInfiniteHorizon() ? 40 : 256;
+			DynaPlex::MDP sh_mdp = mdp;
+			DynaPlex::DCL::SequentialHalving sh(settings.rng_seed, H, settings.sh_M, sh_mdp, policy);
+			int64_t seed = 0;
+			runner.Run(prefix + "/SequentialHalving_SetAction", [&]() {
+				DynaPlex::NN::Sample sample;
+				Trajectory traj{};
+				traj.RNGProvider.SeedEventStreams(true, settings.rng_seed, n);
+				mdp->InitiateState({ &traj,1 }, sh_trajectory[0].GetState());
+				double seconds = TimeSeconds([&]() { sh.SetAction(traj, sample, seed++); });
+				return Timing{ seconds, 1 };
+				});
+		}
+	}
+
+	void BenchmarkDiscreteDist(Runner& runner, const Settings& settings)
+	{
+		const int64_t draws = 4096;
+		std::vector<std::pair<std::string, DiscreteDist>> dists{
+			{"poisson_mean_5", DiscreteDist::GetPoissonDist(5.0)},
+			{"geometric_mean_3", DiscreteDist::GetGeometricDist(3.0)},
+			{"poisson_mean_50", DiscreteDist::GetPoissonDist(50.0)},
+			{"poisson_mean_50_optimized", DiscreteDist::GetPoissonDist(50.0)},
+			{"poisson_mean_50_alias", DiscreteDist::GetPoissonDist(50.0)}
+		};
+		dists[3].second.OptimizeForSampling();
+		dists[4].second.OptimizeForSampling(true);
+		for (auto& [name, dist] : dists)
+		{
+			DynaPlex::RNG rng(true, settings.rng_seed);
+			runner.Run("DiscreteDist/GetSample/" + name, [&]() {
+				int64_t sum = 0;
+				double seconds = TimeSeconds([&]() {
+					for (int64_t i = 0; i < draws; i++)
+						sum += dist.GetSample(rng);
+					});
+				//prevents the loop from being optimized away.
+				if (sum == std::numeric_limits<int64_t>::min())
+					std::cout << sum;
+				return Timing{ seconds, draws };
+				});
+
+			std::vector<int64_t> samples(draws);
+			runner.Run("DiscreteDist/GetSamples/RNG/" + name, [&]() {
+				double seconds = TimeSeconds([&]() { dist.GetSamples(rng, samples); });
+				return Timing{ seconds, draws };
+				});
+
+			DynaPlex::MultiLaneRNG lane_rng(rng);
+			runner.Run("DiscreteDist/GetSamples/MultiLaneRNG/" + name, [&]() {
+				double seconds = TimeSeconds([&]() { dist.GetSamples(lane_rng, samples); });
+				return Timing{ seconds, draws };
+				});
+		}
+	}
+
+	Settings ParseArguments(int argc, char** argv)
+	{
+		Settings settings{};
+		for (int i = 1; i < argc; i++)
+		{
+			std::string arg = argv[i];
+			auto value_of = [&](const std::string& option) {
+				return arg.substr(option.size());
+			};
+			if (arg.starts_with("--out="))
+				settings.out_path = value_of("--out=");
+			else if (arg.starts_with("--min_time="))
+				settings.min_time = std::stod(value_of("--min_time="));
+			else if (arg.starts_with("--filter="))
+				settings.filter = value_of("--filter=");
+			else
+				throw DynaPlex::Error("dynaplex_bench: unknown argument " + arg + ". Supported: --out=<file.json> --min_time=<seconds> --filter=<substring>.");
+		}
+		return settings;
+	}
+}
+
+int main(int argc, char** argv) {
+	try
+	{
+		auto settings = ParseArguments(argc, argv);
+		auto& dp = DynaPlexProvider::Get();
+		auto& system = dp.System();
+		Runner runner{ settings };
+
+		BenchmarkDiscreteDist(runner, settings);
+
+		auto mdp_list = dp.ListMDPs();
+		for (const auto& id : mdp_list.Keys())
+		{
+			auto files = ConfigFiles(system, id);
+			if (files.empty())
+				std::cout << "dynaplex_bench: no mdp_config_*.json available for " << id << "; skipping." << std::endl;
+			for (const auto& file : files)
+			{
+				auto config = VarGroup::LoadFromFile(file.string());
+				auto mdp = dp.GetMDP(config);
+				BenchmarkMDP(runner, settings, mdp, id + "/" + file.stem().string());
+			}
+		}
+
+#ifdef NDEBUG
+		std::string build_type = "release";
+#else
+		std::string build_type = "debug";
+#endif
+		DynaPlex::VarGroup context{
+			{"executable", "dynaplex_bench"},
+			{"num_cpus", static_cast<int64_t>(system.HardwareThreads())},
+			{"library_build_type", build_type},
+			{"min_time", settings.min_time},
+			{"num_trajectories", settings.num_trajectories}
+		};
+		DynaPlex::VarGroup output{};
+		output.Add("context", context);
+		output.Add("benchmarks", runner.Results());
+
+		auto out_path = settings.out_path.empty() ? system.filepath("benchmarks", "dynaplex_bench.json") : settings.out_path;
+		output.SaveToFile(out_path, 2);
+		std::cout << "dynaplex_bench: results written to " << out_path << std::endl;
+	}
+	catch (const std::exception& e)
+	{
+		std::cout << "exception: " << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -1,6 +1,7 @@
 #include "dynaplex/dcl.h"
 #include "dynaplex/parallel_execute.h"
 #include "dynaplex/policytrainer.h"
+#include "dynaplex/mlpengine.h"
 #include "dynaplex/sampledata.h"
 #include "dynaplex/sample.h"
 
@@ -22,6 +23,8 @@ namespace DynaPlex::Algorithms {
 		config.GetOrDefault("keep_samples_lastgen_only", keep_samples_lastgen_only, false);
 		config.GetOrDefault("resume_gen", resume_gen,0);
 		config.GetOrDefault("num_gens", num_gens, 1);
+		//validated by SampleGenerator:
+		config.GetOrDefault("sample_file_format", sample_file_format, "json");
 
 		//initiate policy_0, defaulting to random. 
 		if (policy_0)
@@ -35,6 +38,10 @@ namespace DynaPlex::Algorithms {
 			config.Get("nn_training", nn_training);
 
 		trainer = DynaPlex::NN::PolicyTrainer(system, mdp, nn_training,rng_seed);
+		if (config.HasKey("nn_inference"))
+			config.Get("nn_inference", nn_inference);
+		nn_inference.GetOrDefault("precision", inference_precision, "float32");
+		DynaPlex::NN::MLPEngine::PrecisionFromString(inference_precision);
 
 		if (config.HasKey("nn_architecture"))
 			config.Get("nn_architecture", nn_architecture);
@@ -52,21 +59,33 @@ namespace DynaPlex::Algorithms {
 
 		if (retrain_lastgen_only)
 		{
-			if(system.WorldRank()==0)
+			if (trainer.DataParallel() || system.WorldRank() == 0)
 				trainer.TrainPolicy(nn_architecture, num_gens, GetPathOfSampleFile(num_gens - 1),silent);
+			if (system.WorldRank() == 0 && inference_precision != "float32")
+				trainer.QuantizePolicy(nn_architecture, num_gens, GetPathOfSampleFile(num_gens - 1), inference_precision, silent);
 		}
 		else
 		{
 			for (int64_t generation = resume_gen; generation < num_gens; generation++) {
 				DynaPlex::Policy policy = GetPolicy(generation);
-				sampleCollector.GenerateStateSamples(policy, GetPathOfSampleFile(generation));
+				if (sample_file_format == "binary")
+					sampleCollector.GenerateSamples(policy, GetPathOfSampleFile(generation));
+				else
+					sampleCollector.GenerateStateSamples(policy, GetPathOfSampleFile(generation));
 				if(!silent)
 					system << "Elapsed time: " << system.Elapsed() << std::endl;
-				if (system.WorldRank() == 0) {
+				if (trainer.DataParallel()) {
+					//all nodes train, once node 0 has written the samples. 
+					system.AddBarrier();
 					trainer.TrainPolicy(nn_architecture, generation + 1, GetPathOfSampleFile(generation), silent);
-					if (delete_samples_after_training || (keep_samples_lastgen_only && generation < num_gens - 1))
-						system.remove_file(GetPathOfSampleFile(generation));
 				}
+				else if (system.WorldRank() == 0)
+					trainer.TrainPolicy(nn_architecture, generation + 1, GetPathOfSampleFile(generation), silent);
+				//calibrated on the samples, hence before these may be removed. 
+				if (system.WorldRank() == 0 && inference_precision != "float32")
+					trainer.QuantizePolicy(nn_architecture, generation + 1, GetPathOfSampleFile(generation), inference_precision, silent);
+				if (system.WorldRank() == 0 && (delete_samples_after_training || (keep_samples_lastgen_only && generation < num_gens - 1)))
+					system.remove_file(GetPathOfSampleFile(generation));
 				system.AddBarrier();
 			}
 		}
@@ -93,14 +112,14 @@ namespace DynaPlex::Algorithms {
 		if (generation == 0)
 			return policy_0;
 
-		return trainer.LoadPolicy(nn_architecture, generation);
+		return trainer.LoadPolicy(nn_architecture, generation, nn_inference);
 	}
 
 
 	std::string DCL::GetPathOfSampleFile(int64_t generation)
 	{
 		std::string filename = "samples_gen" + std::to_string(generation);
-		filename += ".json";
+		filename += sample_file_format == "binary" ? ".dpsf" : ".json";
 		return this->system.filepath(this->mdp->Identifier(), filename);
 	}
 }
\ No newline at end of file
@@ -0,0 +1,104 @@
+#include "rollouts.h"
+#include "dynaplex/trajectory.h"
+#include "dynaplex/trajectoryspanbatch.h"
+#include "dynaplex/parallel_execute.h"
+#include "dynaplex/error.h"
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+#include <memory>
+
+namespace DynaPlex::DCL {
+
+	//processes experiments [start,end) for H steps or until final state.
+	void RolloutChunk(const DynaPlex::MDP& mdp, const DynaPlex::Policy& policy, const DynaPlex::dp_State& root_state,
+		std::span<const RolloutExperiment> experiments, const RolloutSettings& settings, std::span<double> returns, DynaPlex::TrajectoryPool& trajectory_pool, int64_t start, int64_t end)
+	{
+		size_t size = static_cast<size_t>(end - start);
+		//policies of the mdp itself roll out on contiguous typed states; others on pooled trajectories. 
+		std::unique_ptr<DynaPlex::TrajectoryBatchInterface> batch = mdp->CreateTrajectoryBatch(policy, size);
+		if (!batch)
+			batch = std::make_unique<DynaPlex::TrajectorySpanBatch>(*mdp, policy, trajectory_pool.Get(size));
+		//with common random numbers, the experiments for different actions share a traj_seed; their events are drawn only once.
+		//scenarios are local to the chunk, so they are never accessed concurrently. 
+		std::unordered_map<int64_t, std::shared_ptr<DynaPlex::EventScenario>> scenarios;
+		bool share_scenarios = settings.share_scenarios && mdp->SupportsEventScenarios();
+		std::vector<int64_t> actions(size);
+		for (size_t i = 0; i < size; i++)
+		{
+			auto& experiment = experiments[start + i];
+			auto& rng_provider = batch->RNGProvider(i);
+			rng_provider.SeedEventStreams(false, settings.rng_seed, settings.seed, experiment.traj_seed);
+			actions[i] = experiment.action;
+			if (share_scenarios)
+			{
+				auto& scenario = scenarios[experiment.traj_seed];
+				if (!scenario)
+					scenario = mdp->CreateEventScenario();
+				rng_provider.AttachScenario(scenario);
+			}
+		}
+		batch->InitiateState(root_state);
+		batch->IncorporateAction(actions);
+		//other actions use roll-out policy; every trajectory completes within max_steps_until_completion_expected actions. 
+		batch->Evolve(settings.H, false, settings.max_steps_until_completion_expected);
+		//some checks:
+		if (mdp->IsInfiniteHorizon())
+		{
+			for (size_t i = 0; i < size; i++)
+			{
+				if (batch->Category(i).IsFinal())
+					throw DynaPlex::Error(settings.caller + " - state has Final Category but MDP is infinite horizon()");
+				if (batch->PeriodCount(i) != settings.H)
+					throw DynaPlex::Error(settings.caller + " - unexpected value of PeriodCount after rollout");
+			}
+		}
+		else
+		{
+			for (size_t i = 0; i < size; i++)
+				if (!(batch->Category(i).IsFinal() || batch->PeriodCount(i) == settings.H))
+					throw DynaPlex::Error(settings.caller + " - unexpected trajectory status after rollout");
+		}
+		for (size_t i = 0; i < size; i++)
+		{
+			returns[start + i] = batch->CumulativeReturn(i);
+			//pooled trajectories should not keep the scenarios alive. 
+			batch->RNGProvider(i).AttachScenario(nullptr);
+		}
+	}
+
+	void Rollout(const DynaPlex::MDP& mdp, const DynaPlex::Policy& policy, const DynaPlex::dp_State& root_state,
+		std::span<const RolloutExperiment> experiments, const RolloutSettings& settings, std::span<double> returns,
+		std::vector<DynaPlex::TrajectoryPool>& trajectory_pools)
+	{
+		if (experiments.size() != returns.size())
+			throw DynaPlex::Error(settings.caller + " - nonconformant sizes of experiments and returns.");
+		if (experiments.empty())
+			return;
+
+		//iterate over chunks of the experiments, and process those for H steps or until final state. 
+		auto chunks = DynaPlex::Parallel::get_chunks(experiments.size(), settings.max_chunk_size);
+		//a pool per chunk, such that chunks that run concurrently never share a pool. 
+		if (trajectory_pools.size() < chunks.size())
+			trajectory_pools.resize(chunks.size());
+		if (settings.pool && chunks.size() > 1)
+		{
+			int64_t num_chunks = static_cast<int64_t>(chunks.size());
+			settings.pool->ForEach(num_chunks, num_chunks, [&](int64_t begin, int64_t end) {
+				for (int64_t chunk = begin; chunk < end; chunk++)
+				{
+					auto& [start, stop] = chunks[chunk];
+					RolloutChunk(mdp, policy, root_state, experiments, settings, returns, trajectory_pools[chunk], start, stop);
+				}
+				});
+		}
+		else
+		{
+			for (size_t chunk = 0; chunk < chunks.size(); chunk++)
+			{
+				auto& [start, end] = chunks[chunk];
+				RolloutChunk(mdp, policy, root_state, experiments, settings, returns, trajectory_pools[chunk], start, end);
+			}
+		}
+	}
+}
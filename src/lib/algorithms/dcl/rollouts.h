@@ -0,0 +1,49 @@
+#pragma once
+#include <span>
+#include <string>
+#include <vector>
+#include "dynaplex/mdp.h"
+#include "dynaplex/policy.h"
+#include "dynaplex/state.h"
+#include "dynaplex/threadpool.h"
+#include "dynaplex/trajectorypool.h"
+
+namespace DynaPlex::DCL {
+
+	/// A single rollout from the root state: first take action, then follow the roll-out policy.
+	struct RolloutExperiment
+	{
+		int64_t action;
+		//seed of the trajectory, in the sense of RNGProvider::SeedEventStreams
+		int64_t traj_seed;
+	};
+
+	/// Settings shared by the rollouts of a single sample. 
+	struct RolloutSettings
+	{
+		int64_t rng_seed;
+		//sample number, in the sense of RNGProvider::SeedEventStreams
+		int64_t seed;
+		int64_t H;
+		int64_t max_chunk_size;
+		int64_t max_steps_until_completion_expected;
+		//used as prefix of error messages. 
+		std::string caller;
+		//if not null, chunks of rollouts are executed on this pool. Results do not depend on this. 
+		DynaPlex::Parallel::ThreadPool* pool = nullptr;
+		//whether experiments with equal traj_seed within a chunk replay a shared EventScenario (if the MDP supports it). Results do not depend on this. 
+		bool share_scenarios = false;
+	};
+
+	/**
+	 * Rolls out all experiments from root_state for H periods or until final, in chunks of at most max_chunk_size 
+	 * trajectories, and writes the CumulativeReturn of experiments[i] to returns[i]. For policies of the MDP itself, each chunk 
+	 * is a TrajectoryBatch created by MDP->CreateTrajectoryBatch; otherwise, chunk c rolls out on trajectories (and the states they hold)
+	 * of trajectory_pools[c], which is grown to the number of chunks if needed. The pools are owned by the caller, which should hold them 
+	 * for a single sample only, such that no states carry over between samples. Throws if a rollout takes more than max_steps_until_completion_expected actions. 
+	 * Chunks run on settings.pool if provided; since each experiment is seeded individually, returns are identical either way.
+	 */
+	void Rollout(const DynaPlex::MDP& mdp, const DynaPlex::Policy& policy, const DynaPlex::dp_State& root_state,
+		std::span<const RolloutExperiment> experiments, const RolloutSettings& settings, std::span<double> returns,
+		std::vector<DynaPlex::TrajectoryPool>& trajectory_pools);
+}
@@ -3,8 +3,15 @@
 #include "dynaplex/policytrainer.h"
 #include "dynaplex/sampledata.h"
 #include "dynaplex/sample.h"
+#include "dynaplex/samplefile.h"
 #include <algorithm>
 #include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <thread>
 namespace DynaPlex::DCL {
 
 
@@ -15,13 +22,24 @@ namespace DynaPlex::DCL {
 			throw DynaPlex::Error("SampleGenerator: mdp should not be null");
 		//default to 24*60*60=86400 seconds/24 hours:
 		config.GetOrDefault("sampling_time_out", sampling_time_out, 86400);
+		if (sampling_time_out < 0)
+			throw DynaPlex::Error("SampleGenerator :: Invalid sampling_time_out - should be non-negative");
 		if (mdp->IsInfiniteHorizon())
 			config.GetOrDefault("H", H, 40);
 		else
 			config.GetOrDefault("H", H, 256);
 
 		config.GetOrDefault("enable_sequential_halving", enable_sequential_halving, true);
+		//if positive, sequential halving eliminates actions as soon as their paired differences are significant at the level of this z-statistic,
+		//corrected for the number of stages and comparisons. 
+		config.GetOrDefault("target_z_stat", target_z_stat, 0.0);
+		if (target_z_stat < 0.0)
+			throw DynaPlex::Error("SampleGenerator :: Invalid target_z_stat - should be non-negative");
 		config.GetOrDefault("silent", silent, false);
+		config.GetOrDefault("parallel_rollouts", parallel_rollouts, false);
+		config.GetOrDefault("memoize_states", memoize_states, false);
+		if (memoize_states && !mdp->SupportsEqualityTest())
+			throw DynaPlex::Error("SampleGenerator :: memoize_states requires that MDP::State is equality comparable.");
 		config.GetOrDefault("M", M, 1000);
 		config.GetOrDefault("N", N, 5000);
 		config.GetOrDefault("sampling_probability", sampling_probability, 1.0);
@@ -30,6 +48,24 @@ namespace DynaPlex::DCL {
 
 
 		config.GetOrDefault("json_save_format", json_save_format, -1);
+		config.GetOrDefault("sample_file_format", sample_file_format, "json");
+		//by default, samples are sent to node 0 via MPI if available, and via temporary files otherwise.
+		config.GetOrDefault("gather_via_files", gather_via_files, false);
+		config.GetOrDefault("checkpoint", checkpoint, false);
+		if (checkpoint && !mdp->SupportsGetStateFromVarGroup())
+			throw DynaPlex::Error("SampleGenerator :: checkpoint requires that the MDP supports getting states from VarGroup.");
+		if (sample_file_format != "json" && sample_file_format != "binary")
+			throw DynaPlex::Error("SampleGenerator :: Invalid sample_file_format: " + sample_file_format + ". Must be \"json\" or \"binary\".");
+		config.GetOrDefault("load_balancing", load_balancing, "static");
+		if (load_balancing != "static" && load_balancing != "dynamic")
+			throw DynaPlex::Error("SampleGenerator :: Invalid load_balancing: " + load_balancing + ". Must be \"static\" or \"dynamic\".");
+		config.GetOrDefault("block_size", block_size, 8);
+		if (block_size < 1)
+			throw DynaPlex::Error("SampleGenerator :: Invalid block_size - should be positive");
+		//advancing multiple trajectories per thread allows the base policy to act on batches of states.
+		config.GetOrDefault("trajectories_per_thread", trajectories_per_thread, 1);
+		if (trajectories_per_thread < 1)
+			throw DynaPlex::Error("SampleGenerator :: Invalid trajectories_per_thread - should be positive");
 		config.GetOrDefault("rng_seed", rng_seed, 15112017);
 		if (rng_seed < 0)
 			throw DynaPlex::Error("SampleGenerator :: Invalid rng_seed - should be non-negative");
@@ -48,99 +84,212 @@ namespace DynaPlex::DCL {
 		seed_offset = 0;
 	}
 
+	namespace {
+		enum class LanePhase { Start, WarmUp, Collect, Done };
+
+		//a trajectory that collects a contiguous part of the samples of a thread. 
+		struct Lane {
+			std::span<DynaPlex::NN::Sample> samples;
+			int64_t offset;
+			DynaPlex::RNG rng;
+			int64_t num_samples_added = 0;
+			int64_t warm_up_steps = 0;
+			LanePhase phase = LanePhase::Start;
+			bool final_reached_once = false;
+			//whether the trajectory awaits an action of the base policy. 
+			bool awaits_policy = false;
+		};
+	}
+
 	void SampleGenerator::GenerateSamplesOnThread(std::span<DynaPlex::NN::Sample> somesamples, DynaPlex::Policy policy, int64_t thread_offset)
 	{
 		bool use_seed_offset = true; // setting it true will secure different seeding between generations 
 		int64_t seed = use_seed_offset ? seed_offset : 0;
-		int64_t offset = thread_offset + node_sampling_offset + 1 + seed;
-		int64_t num_samples_added = 0;
-		Trajectory trajectory{};
-		trajectory.RNGProvider.SeedEventStreams(false, rng_seed, offset);
-		DynaPlex::RNG rng(false, rng_seed, offset);
-
-		bool final_reached_once = false;
-		while (num_samples_added < somesamples.size())
+
+		//the samples are divided over the lanes; lane k collects the samples as a single-trajectory thread with offset thread_offset+start_k would.
+		int64_t num_lanes = std::min<int64_t>(trajectories_per_thread, somesamples.size());
+		auto splits = DynaPlex::Parallel::get_splits(somesamples.size(), num_lanes);
+		std::vector<Lane> lanes;
+		lanes.reserve(num_lanes);
+		std::vector<Trajectory> trajectories(num_lanes);
+		//each lane memoizes only its own samples, such that the samples do not depend on timing of threads. 
+		std::vector<StateMemo> state_memos(memoize_states ? num_lanes : 0);
+		for (int64_t k = 0; k < num_lanes; k++)
 		{
-			mdp->InitiateState({ &trajectory,1 });
+			auto& [start, end] = splits[k];
+			int64_t offset = thread_offset + start + node_sampling_offset + 1 + seed;
+			lanes.push_back(Lane{ somesamples.subspan(start, end - start), offset, DynaPlex::RNG(false, rng_seed, offset) });
+			trajectories[k].RNGProvider.SeedEventStreams(false, rng_seed, offset);
+			trajectories[k].ExternalIndex = k;
+		}
 
-			if (mdp->IsInfiniteHorizon())
-			{//do a warm-up of L steps. 
-				int64_t actual_steps = 0;
-				while (trajectory.PeriodCount < L)
+		//advances the trajectory until it awaits an action of the base policy (returns true), or until its samples are collected (returns false).
+		auto advance = [&](Lane& lane, Trajectory& trajectory) {
+			while (true)
+			{
+				switch (lane.phase)
 				{
-					if (mdp->IncorporateUntilAction({ &trajectory,1 }, L))
+				case LanePhase::Done:
+					return false;
+				case LanePhase::Start:
+					if (lane.num_samples_added == static_cast<int64_t>(lane.samples.size()) || TimedOut())
 					{
-						mdp->IncorporateAction({ &trajectory,1 }, policy);
-
-
-						if (actual_steps++ > 10000 * L)
-							throw DynaPlex::Error("DCL: GenerateSamplesOnThread - it seems that there are hardly any time-steps in this MDP. Aborting. ");
+						lane.phase = LanePhase::Done;
+						break;
 					}
-					else
-						if (trajectory.Category.IsFinal())
-							throw DynaPlex::Error("DCL: GenerateSamplesOnThread - trajectory has Category.IsFinal() but mdp IsInfiniteHorizon(). ");
-				}
-			}
-			bool final_reached = false;
-			while (!final_reached) {
-				if (mdp->IncorporateUntilAction({ &trajectory,1 }))
-				{
-					if (mdp->IsInfiniteHorizon() && trajectory.PeriodCount == reinitiate_counter + L)
+					mdp->InitiateState({ &trajectory,1 });
+					lane.warm_up_steps = 0;
+					lane.phase = mdp->IsInfiniteHorizon() ? LanePhase::WarmUp : LanePhase::Collect;
+					break;
+				case LanePhase::WarmUp://do a warm-up of L steps. 
+					if (trajectory.PeriodCount >= L)
 					{
-						break;//the while(!final_reached) loop, to start trajectory afresh. 
+						lane.phase = LanePhase::Collect;
+						break;
 					}
-					auto allowed = mdp->AllowedActions(trajectory.GetState());
-
-					if (allowed.size() == 1)
+					if (mdp->IncorporateUntilAction({ &trajectory,1 }, L))
 					{
-						trajectory.NextAction = allowed.front();
+						if (lane.warm_up_steps++ > 10000 * L)
+							throw DynaPlex::Error("DCL: GenerateSamplesOnThread - it seems that there are hardly any time-steps in this MDP. Aborting. ");
+						return true;
 					}
-					else {
-						if (rng.genUniform() < sampling_probability)
+					if (trajectory.Category.IsFinal())
+						throw DynaPlex::Error("DCL: GenerateSamplesOnThread - trajectory has Category.IsFinal() but mdp IsInfiniteHorizon(). ");
+					break;
+				case LanePhase::Collect:
+					if (mdp->IncorporateUntilAction({ &trajectory,1 }))
+					{
+						if (mdp->IsInfiniteHorizon() && trajectory.PeriodCount == reinitiate_counter + L)
 						{
-							auto& sample = somesamples[num_samples_added];
-							if (enable_sequential_halving && (M > std::ceil(std::log(allowed.size()) / std::log(2)))) {
-								sequentialhalving_action_selector.SetAction(trajectory, sample, offset + num_samples_added);
-							}
-							else {
-								uniform_action_selector.SetAction(trajectory, sample, offset + num_samples_added);
-							}
+							lane.phase = LanePhase::Start;//to start trajectory afresh. 
+							break;
+						}
+						auto allowed = mdp->AllowedActions(trajectory.GetState());
 
-							if constexpr (std::atomic<int64_t>::is_always_lock_free)
+						if (allowed.size() == 1)
+						{
+							trajectory.NextAction = allowed.front();
+						}
+						else {
+							if (lane.rng.genUniform() < sampling_probability)
 							{
-								(*total_samples_collected.get())++;
+								if (TimedOut())
+								{//the samples that remain are left without state. 
+									lane.phase = LanePhase::Done;
+									return false;
+								}
+								auto& sample = lane.samples[lane.num_samples_added];
+								StateMemo* state_memo = memoize_states ? &state_memos[trajectory.ExternalIndex] : nullptr;
+								if (state_memo && RecallState(*state_memo, trajectory.GetState(), sample))
+								{
+									sample.sample_number = lane.offset + lane.num_samples_added;
+									//the action selectors query the base policy once; do the same, such that the policy rng advances identically. 
+									policy->SetAction({ &trajectory,1 });
+									trajectory.NextAction = sample.action_label;
+								}
+								else
+								{
+									if (enable_sequential_halving && (M > std::ceil(std::log(allowed.size()) / std::log(2)))) {
+										sequentialhalving_action_selector.SetAction(trajectory, sample, lane.offset + lane.num_samples_added);
+									}
+									else {
+										uniform_action_selector.SetAction(trajectory, sample, lane.offset + lane.num_samples_added);
+									}
+									if (state_memo)
+										MemorizeState(*state_memo, sample);
+								}
+
+								if constexpr (std::atomic<int64_t>::is_always_lock_free)
+								{
+									(*total_samples_collected.get())++;
+								}
+								if (++lane.num_samples_added == static_cast<int64_t>(lane.samples.size()))
+								{
+									lane.phase = LanePhase::Done;//to eventually stop executution. 
+									return false;
+								}
 							}
-							if (++num_samples_added == somesamples.size())
-								break;//the while(!final_reached) loop, to eventually stop executution. 
-						}
-						else
-						{
-							policy->SetAction({ &trajectory,1 });
+							else
+								return true;
 						}
+						mdp->IncorporateAction({ &trajectory,1 });
 					}
-					mdp->IncorporateAction({ &trajectory,1 });
-				}
-				else
-				{
-					if (trajectory.Category.IsFinal())
+					else
 					{
-						final_reached = true;
-						final_reached_once = true;
-						if (mdp->IsInfiniteHorizon())
-							throw DynaPlex::Error("DCL: GenerateSamplesOnThread - trajectory has Category.IsFinal() but mdp IsInfiniteHorizon(). ");
+						if (trajectory.Category.IsFinal())
+						{
+							lane.final_reached_once = true;
+							if (mdp->IsInfiniteHorizon())
+								throw DynaPlex::Error("DCL: GenerateSamplesOnThread - trajectory has Category.IsFinal() but mdp IsInfiniteHorizon(). ");
+							lane.phase = LanePhase::Start;
+						}
+						else
+							if (trajectory.Category.IsAwaitEvent())
+								throw DynaPlex::Error("DCL: GenerateSamplesOnThread - trajectory is AwaitEvent after calling mdp->IncorporateUntilAction (without MaxPeriodCount.)");
 					}
-					else
-						if (trajectory.Category.IsAwaitEvent())
-							throw DynaPlex::Error("DCL: GenerateSamplesOnThread - trajectory is AwaitEvent after calling mdp->IncorporateUntilAction (without MaxPeriodCount.)");
+					break;
 				}
 			}
+			};
+
+		//the lanes advance in lockstep, such that the base policy is called on all lanes that await it at once. 
+		std::span<Trajectory> active = trajectories;
+		while (!active.empty())
+		{
+			for (auto& trajectory : active)
+			{
+				auto& lane = lanes[trajectory.ExternalIndex];
+				lane.awaits_policy = advance(lane, trajectory);
+			}
+			auto partition_point = std::partition(active.begin(), active.end(),
+				[&lanes](const Trajectory& traj) { return lanes[traj.ExternalIndex].awaits_policy; });
+			active = std::span<Trajectory>(active.begin(), partition_point);
+			if (!active.empty())
+				mdp->IncorporateAction(active, policy);
 		}
+
 		if (!silent)
-			if (!mdp->IsInfiniteHorizon() && !final_reached_once && thread_offset == 0)
+			if (!mdp->IsInfiniteHorizon() && thread_offset == 0 && !lanes.empty() && !lanes.front().final_reached_once)
 				system << std::endl << "WARNING possible data skew:  sampling collection did not reach the final state even once for this finite horizon MDP" << std::endl;
 		return;
 	}
 
+	bool SampleGenerator::RecallState(const StateMemo& state_memo, const DynaPlex::dp_State& state, DynaPlex::NN::Sample& sample) const
+	{
+		int64_t hash = mdp->StateHash(state);
+		auto [begin, end] = state_memo.equal_range(hash);
+		for (auto it = begin; it != end; ++it)
+		{
+			auto& earlier = it->second;
+			if (mdp->StatesAreEqual(earlier.state, state))
+			{
+				sample.state = state->Clone();
+				sample.action_label = earlier.action_label;
+				sample.q_hat_vec = earlier.q_hat_vec;
+				sample.z_stat = earlier.z_stat;
+				sample.q_hat = earlier.q_hat;
+				sample.cost_improvement = earlier.cost_improvement;
+				sample.probabilities = earlier.probabilities;
+				sample.memoized = true;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void SampleGenerator::MemorizeState(StateMemo& state_memo, const DynaPlex::NN::Sample& sample) const
+	{
+		int64_t hash = mdp->StateHash(sample.state);
+		DynaPlex::NN::Sample copy{ sample.action_label, sample.state->Clone() };
+		copy.sample_number = sample.sample_number;
+		copy.q_hat_vec = sample.q_hat_vec;
+		copy.z_stat = sample.z_stat;
+		copy.q_hat = sample.q_hat;
+		copy.cost_improvement = sample.cost_improvement;
+		copy.probabilities = sample.probabilities;
+		state_memo.emplace(hash, std::move(copy));
+	}
+
 	std::string SampleGenerator::GetPathOfTempSampleFile(int rank)
 	{
 		std::string filename = "samples_node";
@@ -148,45 +297,167 @@ namespace DynaPlex::DCL {
 		return system.filepath(mdp->Identifier(), "temp", filename);
 	}
 
+	std::string SampleGenerator::GetPathOfCheckpoint(const std::string& output_path, int rank)
+	{
+		return output_path + ".checkpoint_node" + std::to_string(rank);
+	}
+
+	void SampleGenerator::RemoveCompletedCheckpoint(const std::string& output_path)
+	{
+		auto path = GetPathOfCheckpoint(output_path, system.WorldRank());
+		if (checkpoint && collection_complete && std::filesystem::exists(path))
+			system.remove_file(path);
+	}
+
 
 	void SampleGenerator::GenerateSamples(DynaPlex::Policy policy, const std::string& path) {
 
 		if (!policy)
 			policy = mdp->GetPolicy("random");
 
-		auto temp_path = system.filepath(mdp->Identifier(), "temp", "samples_complete.json");
-		GenerateStateSamples(policy, temp_path);
-		//Convert to samples that store features instead of the original states.
+		//features are computed directly from the collected states, without an intermediate file, on the threads of the worker pool. 
+		auto data = CollectSamples(policy, path);
 		if (system.WorldRank() == 0)
 		{
-			DynaPlex::NN::SampleData data{ mdp };
-			data.AddFromFile(mdp, temp_path);
-			std::vector<VarGroup> samples;
-			samples.reserve(data.Samples.size());
-			for (auto& sample : data.Samples)
-				samples.push_back(std::move(sample.ToVarGroupWithFeats(mdp)));
-			VarGroup samples_with_feats{
-				{"samples", samples}
-			};
-			samples_with_feats.SaveToFile(path);
-			system.remove_file(temp_path);
+			if (!silent)
+				data.PrintStatistics();
+			if (sample_file_format == "binary")
+				DynaPlex::NN::SampleFile::Save(mdp, data.Samples, path, &system.WorkerPool());
+			else
+			{//Convert to samples that store features instead of the original states.
+				std::vector<VarGroup> samples(data.Samples.size());
+				auto work = [this, &data](std::span<VarGroup> some_samples, int64_t start) {
+					for (size_t i = 0; i < some_samples.size(); i++)
+						some_samples[i] = data.Samples[start + i].ToVarGroupWithFeats(mdp);
+					};
+				DynaPlex::Parallel::parallel_compute<VarGroup>(samples, work, system.WorkerPool());
+				VarGroup samples_with_feats{
+					{"samples", samples}
+				};
+				samples_with_feats.SaveToFile(path);
+			}
 		}
+		system.AddBarrier();
+		RemoveCompletedCheckpoint(path);
 	}
 
 
 
 
 	void SampleGenerator::GenerateStateSamples(DynaPlex::Policy policy, const std::string& path)
+	{
+		auto sample_data = CollectSamples(policy, path);
+		if (system.WorldRank() == 0)
+			sample_data.SaveToFile(mdp, path, json_save_format, silent);
+		system.AddBarrier();
+		RemoveCompletedCheckpoint(path);
+	}
+
+	bool SampleGenerator::TimedOut() const
+	{
+		return std::chrono::steady_clock::now() >= sampling_deadline;
+	}
+
+	DynaPlex::NN::SampleData SampleGenerator::CollectSamples(DynaPlex::Policy policy, const std::string& output_path)
 	{
 		if (!silent)
 			system << "Generating " << N << " samples based on policy type: " << policy->TypeIdentifier() << std::endl;
+		sampling_deadline = std::chrono::steady_clock::now() + std::chrono::seconds(sampling_time_out);
 
-		uniform_action_selector = DynaPlex::DCL::UniformActionSelector(rng_seed, H, M, mdp, policy);
-		sequentialhalving_action_selector = DynaPlex::DCL::SequentialHalving(rng_seed, H, M, mdp, policy);
+		DynaPlex::Parallel::ThreadPool* rollout_pool = parallel_rollouts ? &system.WorkerPool() : nullptr;
+		uniform_action_selector = DynaPlex::DCL::UniformActionSelector(rng_seed, H, M, mdp, policy, rollout_pool);
+		sequentialhalving_action_selector = DynaPlex::DCL::SequentialHalving(rng_seed, H, M, mdp, policy, rollout_pool, target_z_stat);
+
+		bool on_demand = load_balancing == "dynamic";
+		if (on_demand && !system.SupportsSharedCounter())
+		{
+			if (!silent)
+				system << "SampleGenerator: dynamic load_balancing requires message-passing (MPI); using static load_balancing." << std::endl;
+			on_demand = false;
+		}
+		auto checkpoint_path = checkpoint ? output_path : std::string{};
+		auto sample_vec = on_demand ? CollectBlocksOnDemand(policy, checkpoint_path) : CollectStaticSplit(policy, checkpoint_path);
+		seed_offset += N;
+
+		//gather all the collected samples over the threads into sample_data.
+		DynaPlex::NN::SampleData sample_data{ mdp };
+		for (auto& sample : sample_vec)
+		{
+			if (sample.state)
+				sample_data.Samples.push_back(std::move(sample));
+		}
+
+		//check that each sample number is bigger than the previous. 
+		int64_t old_number = -1;
+		for (auto& sample : sample_data.Samples)
+		{
+			if (sample.sample_number <= old_number)
+				throw DynaPlex::Error("Logical error in SampleGenerator: Sample numbers are not strictly increasing.");
+			old_number = sample.sample_number;
+		}
+
+		if (system.WorldSize() > 1)
+		{
+			if (system.SupportsGather() && !gather_via_files)
+			{//send the samples of all nodes to node 0 directly. 
+				std::vector<uint8_t> buffer;
+				if (system.WorldRank() > 0)
+					buffer = sample_data.Serialize(mdp);
+				auto buffers = system.GatherOnRoot(buffer);
+				if (system.WorldRank() == 0)
+				{
+					sample_data.Samples.reserve(N);
+					for (size_t rank = 1; rank < buffers.size(); rank++)
+						sample_data.AddFromSerialized(mdp, buffers[rank]);
+				}
+			}
+			else
+			{
+				//nodes other than 0 save their samples
+				if (system.WorldRank() > 0)
+					sample_data.SaveToFile(mdp, GetPathOfTempSampleFile(system.WorldRank()));
+				//wait until saving on all nodes completes. 
+				system.AddBarrier();
+				//load the collected samples by other nodes.
+				if (system.WorldRank() == 0)
+				{//let node 0 do the gathering.
+					sample_data.Samples.reserve(N);
+					for (size_t rank = 1; rank < system.WorldSize(); rank++)
+					{
+						sample_data.AddFromFile(mdp, GetPathOfTempSampleFile(rank));
+						system.remove_file(GetPathOfTempSampleFile(rank));
+					}
+				}
+			}
+		}
+		if (system.WorldRank() == 0)
+		{
+			if (on_demand)
+			{//which node collected which block depends on timing; sort to make the result independent of that. 
+				std::sort(sample_data.Samples.begin(), sample_data.Samples.end(),
+					[](const DynaPlex::NN::Sample& a, const DynaPlex::NN::Sample& b) { return a.sample_number < b.sample_number; });
+			}
+			DynaPlex::RNG rng(false, rng_seed);
+			std::shuffle(sample_data.Samples.begin(), sample_data.Samples.end(), rng.gen());
+			if (!silent && static_cast<int64_t>(sample_data.Samples.size()) < N)
+				system << "SampleGenerator: sampling_time_out of " << sampling_time_out << " seconds passed; collected " << sample_data.Samples.size() << " of " << N << " samples." << std::endl;
+		}
+		return sample_data;
+	}
+
+	std::vector<DynaPlex::NN::Sample> SampleGenerator::CollectStaticSplit(DynaPlex::Policy policy, const std::string& checkpoint_path)
+	{
 		//Get the samples that must be collected for this specific node 
 		auto splits = DynaPlex::Parallel::get_splits(N, system.WorldSize());
 		auto& [start_for_node, end_for_node] = splits[system.WorldRank()];
 
+		if (!checkpoint_path.empty())
+		{//blocks are the unit of checkpointing; the blocks of the slice of this node are claimed in order. 
+			int64_t next_block = start_for_node;
+			auto claim = [&next_block](int64_t size) { int64_t start = next_block; next_block += size; return start; };
+			return CollectBlocks(policy, claim, start_for_node, end_for_node, checkpoint_path);
+		}
+
 		node_sampling_offset = start_for_node;
 		int64_t to_collect_on_node = end_for_node - start_for_node;
 		//Create space for the samples collected on this node, and collect the samples:
@@ -220,7 +491,7 @@ namespace DynaPlex::DCL {
 					int64_t chars_printed = 0;
 					int64_t max_chars_to_print = 50;
 					int64_t num_ms = 1;
-					while (!error_occurred && (*total_samples_collected.get()) < to_collect_on_node) {
+					while (!error_occurred && !TimedOut() && (*total_samples_collected.get()) < to_collect_on_node) {
 						std::this_thread::sleep_for(std::chrono::milliseconds(num_ms));
 						if (num_ms < 1000)
 							num_ms *= 4;
@@ -243,44 +514,282 @@ namespace DynaPlex::DCL {
 			}
 		}
 
-		DynaPlex::Parallel::parallel_compute<DynaPlex::NN::Sample>(sample_vec, work, system.HardwareThreads(), reporter);
-		seed_offset += N;
+		DynaPlex::Parallel::parallel_compute<DynaPlex::NN::Sample>(sample_vec, work, system.WorkerPool(), reporter);
+		collection_complete = std::all_of(sample_vec.begin(), sample_vec.end(), [](const DynaPlex::NN::Sample& sample) { return sample.state != nullptr; });
+		return sample_vec;
+	}
 
-		//gather all the collected samples over the threads into sample_data.
-		DynaPlex::NN::SampleData sample_data{ mdp };
-		for (auto& sample : sample_vec)
+	std::vector<DynaPlex::NN::Sample> SampleGenerator::CollectBlocksOnDemand(DynaPlex::Policy policy, const std::string& checkpoint_path)
+	{
+		auto counter = system.CreateSharedCounter();
+		auto claim = [&counter](int64_t size) { return counter->FetchAdd(size); };
+		return CollectBlocks(policy, claim, 0, N, checkpoint_path);
+	}
+
+	namespace {
+		/**
+		 * Checkpoint files consist of records [int64 block_start][int64 block_end][int64 num_bytes][num_bytes bytes]. The first record has
+		 * block_start=block_end=-1, and holds the settings under which the blocks were collected as msgpack. The other records hold a complete
+		 * block of samples as SampleData::Serialize. A record that is cut off, e.g. since the process was killed while writing it, is ignored.
+		 */
+		struct CheckpointRecord {
+			int64_t block_start, block_end;
+			std::vector<uint8_t> bytes;
+		};
+
+		void AppendCheckpointRecord(const std::string& path, const CheckpointRecord& record)
 		{
-			if (sample.state)
-				sample_data.Samples.push_back(std::move(sample));
+			std::ofstream out(path, std::ios::binary | std::ios::app);
+			int64_t header[3] = { record.block_start, record.block_end, static_cast<int64_t>(record.bytes.size()) };
+			out.write(reinterpret_cast<const char*>(header), sizeof(header));
+			out.write(reinterpret_cast<const char*>(record.bytes.data()), static_cast<std::streamsize>(record.bytes.size()));
+			out.flush();
+			if (!out)
+				throw DynaPlex::Error("SampleGenerator - cannot write to checkpoint file " + path);
 		}
 
-		//check that each sample number is bigger than the previous. 
-		int64_t old_number = -1;
-		for (auto& sample : sample_data.Samples)
+		/// Reads the complete records of the file at path; the bytes of blocks only if read_blocks. Returns the size of the complete records. 
+		int64_t ReadCheckpointRecords(const std::string& path, bool read_blocks, std::vector<CheckpointRecord>& records)
 		{
-			if (sample.sample_number <= old_number)
-				throw DynaPlex::Error("Logical error in SampleGenerator: Sample numbers are not strictly increasing.");
-			old_number = sample.sample_number;
+			std::error_code error;
+			int64_t file_size = static_cast<int64_t>(std::filesystem::file_size(path, error));
+			if (error)
+				return 0;
+			std::ifstream in(path, std::ios::binary);
+			int64_t position = 0;
+			int64_t header[3];
+			while (position + static_cast<int64_t>(sizeof(header)) <= file_size && in.read(reinterpret_cast<char*>(header), sizeof(header)))
+			{
+				int64_t num_bytes = header[2];
+				if (num_bytes < 0 || num_bytes > file_size - position - static_cast<int64_t>(sizeof(header)))
+					break;
+				CheckpointRecord record{ header[0], header[1], {} };
+				if (read_blocks || records.empty())
+				{
+					record.bytes.resize(num_bytes);
+					if (!in.read(reinterpret_cast<char*>(record.bytes.data()), num_bytes))
+						break;
+				}
+				else
+					in.seekg(num_bytes, std::ios::cur);
+				position += sizeof(header) + num_bytes;
+				records.push_back(std::move(record));
+			}
+			return position;
 		}
+	}
 
-		//nodes other than 0 save their samples
-		if (system.WorldRank() > 0)
-			sample_data.SaveToFile(mdp, GetPathOfTempSampleFile(system.WorldRank()));
-		//wait until saving on all nodes completes. 
-		system.AddBarrier();
-		//load the collected samples by this and other nodes, and save the combined samples.
-		if (system.WorldRank() == 0)
-		{//let node 0 do the gathering and saving.
-			sample_data.Samples.reserve(N);
-			for (size_t rank = 1; rank < system.WorldSize(); rank++)
+	DynaPlex::VarGroup SampleGenerator::CheckpointSettings(DynaPlex::Policy policy) const
+	{
+		//trained policies of all generations share a type identifier; their configuration includes a hash of the weights. 
+		return DynaPlex::VarGroup{ {"mdp",mdp->Identifier()},{"policy",policy->TypeIdentifier()},{"policy_hash",policy->GetConfig().Int64Hash()},
+			{"seed_offset",seed_offset},{"N",N},{"H",H},{"M",M},{"L",L},
+			{"reinitiate_counter",reinitiate_counter},{"rng_seed",rng_seed},{"block_size",block_size},{"trajectories_per_thread",trajectories_per_thread},
+			{"sampling_probability",sampling_probability},{"enable_sequential_halving",enable_sequential_halving},{"target_z_stat",target_z_stat},{"memoize_states",memoize_states},
+			{"load_balancing",load_balancing},{"world_size",static_cast<int64_t>(system.WorldSize())} };
+	}
+
+	std::set<std::pair<int64_t, int64_t>> SampleGenerator::ResumeFromCheckpoints(DynaPlex::Policy policy, const std::string& checkpoint_path, std::vector<DynaPlex::NN::Sample>& samples)
+	{
+		auto settings = CheckpointSettings(policy);
+		auto is_valid = [&settings](const std::vector<CheckpointRecord>& records) {
+			return !records.empty() && records.front().block_start == -1 && DynaPlex::VarGroup::FromMsgPack(records.front().bytes) == settings;
+			};
+
+		std::set<std::pair<int64_t, int64_t>> flushed;
+		for (uint32_t rank = 0; rank < system.WorldSize(); rank++)
+		{
+			auto path = GetPathOfCheckpoint(checkpoint_path, rank);
+			bool own = rank == system.WorldRank();
+			std::vector<CheckpointRecord> records;
+			int64_t valid_size = ReadCheckpointRecords(path, own, records);
+			if (!is_valid(records))
 			{
-				sample_data.AddFromFile(mdp, GetPathOfTempSampleFile(rank));
-				system.remove_file(GetPathOfTempSampleFile(rank));
+				if (own)
+				{//start afresh; blocks collected with other settings (e.g. another policy or seed_offset) would mix in stale samples. 
+					if (!silent && !records.empty())
+						system << "SampleGenerator: discarding checkpoint " << path << ", which was created with other settings." << std::endl;
+					std::filesystem::remove(path);
+					AppendCheckpointRecord(path, { -1, -1, settings.ToMsgPack() });
+				}
+				continue;
 			}
-			DynaPlex::RNG rng(false, rng_seed);
-			std::shuffle(sample_data.Samples.begin(), sample_data.Samples.end(), rng.gen());
-			sample_data.SaveToFile(mdp, path, json_save_format, silent);
+			if (own)
+			{//drop a record that was cut off, such that records can be appended. 
+				std::filesystem::resize_file(path, valid_size);
+				DynaPlex::NN::SampleData resumed{ mdp };
+				for (size_t i = 1; i < records.size(); i++)
+					resumed.AddFromSerialized(mdp, records[i].bytes);
+				for (auto& sample : resumed.Samples)
+					samples.push_back(std::move(sample));
+			}
+			for (size_t i = 1; i < records.size(); i++)
+				flushed.emplace(records[i].block_start, records[i].block_end);
 		}
+		if (!silent && !flushed.empty())
+			system << "SampleGenerator: resuming from checkpoint; " << flushed.size() << " blocks were collected earlier." << std::endl;
+		//all nodes know the flushed blocks before any node flushes new ones. 
 		system.AddBarrier();
+		return flushed;
+	}
+
+	namespace {
+		//bounded queue of claimed blocks, filled by the claiming thread and drained by the workers. 
+		class BlockQueue {
+		public:
+			explicit BlockQueue(size_t capacity) : capacity{ capacity } {}
+
+			/// Blocks while the queue is full; returns false if the queue was closed. 
+			bool Push(int64_t block_start)
+			{
+				std::unique_lock lock(mutex);
+				not_full.wait(lock, [this]() { return closed || blocks.size() < capacity; });
+				if (closed)
+					return false;
+				blocks.push_back(block_start);
+				not_empty.notify_one();
+				return true;
+			}
+
+			/// Blocks while the queue is empty and open; returns false once the queue is closed and empty. 
+			bool Pop(int64_t& block_start)
+			{
+				std::unique_lock lock(mutex);
+				not_empty.wait(lock, [this]() { return closed || !blocks.empty(); });
+				if (blocks.empty())
+					return false;
+				block_start = blocks.front();
+				blocks.pop_front();
+				not_full.notify_one();
+				return true;
+			}
+
+			/// No more blocks are pushed; with discard, blocks that were pushed are dropped as well. 
+			void Close(bool discard = false)
+			{
+				{
+					std::lock_guard lock(mutex);
+					closed = true;
+					if (discard)
+						blocks.clear();
+				}
+				not_full.notify_all();
+				not_empty.notify_all();
+			}
+
+		private:
+			size_t capacity;
+			std::mutex mutex;
+			std::condition_variable not_full, not_empty;
+			std::deque<int64_t> blocks;
+			bool closed = false;
+		};
+	}
+
+	std::vector<DynaPlex::NN::Sample> SampleGenerator::CollectBlocks(DynaPlex::Policy policy, const std::function<int64_t(int64_t)>& claim, int64_t begin, int64_t end,
+		const std::string& checkpoint_path)
+	{
+		total_samples_collected = std::make_shared<std::atomic<int64_t>>(0);
+		//the seeds of a block depend only on its position in [0,N), not on the node or thread that collects it. 
+		node_sampling_offset = 0;
+		auto& pool = system.WorkerPool();
+		int64_t num_workers = pool.NumThreads();
+
+		std::vector<DynaPlex::NN::Sample> sample_vec;
+		std::set<std::pair<int64_t, int64_t>> flushed;
+		if (!checkpoint_path.empty())
+			flushed = ResumeFromCheckpoints(policy, checkpoint_path, sample_vec);
+		auto own_checkpoint = GetPathOfCheckpoint(checkpoint_path, system.WorldRank());
+
+		if (!silent)
+			system << (system.WorldSize() == 1 ? "Progress:" : "Progress (claimed by all nodes):") << std::endl;
+
+		//a single block waits for the first worker that becomes idle; other blocks remain available to other nodes. 
+		BlockQueue queue(1);
+		std::mutex results_mutex;
+		bool all_blocks_complete = true;
+		bool claimed_all = false;
+		std::exception_ptr claim_error;
+
+		//claims one block at a time, such that a worker that finishes a slow block does not hold up the others. 
+		std::jthread claimer([&]() {
+			try
+			{
+				int64_t chars_printed = 0;
+				int64_t max_chars_to_print = 50;
+				while (!TimedOut())
+				{
+					int64_t block_start = claim(block_size);
+					if (block_start >= end)
+					{
+						claimed_all = true;
+						break;
+					}
+					int64_t block_end = std::min(block_start + block_size, end);
+					if (!flushed.contains({ block_start, block_end }) && !queue.Push(block_start))
+						break;
+
+					int64_t to_print = (max_chars_to_print * (block_end - begin)) / std::max<int64_t>(end - begin, 1);
+					while (chars_printed < to_print)
+					{
+						if (!silent)
+							system << '>' << std::flush;
+						chars_printed++;
+						if (!silent)
+							if (chars_printed % 5 == 0)
+								system << 2 * chars_printed << std::flush;
+					}
+				}
+			}
+			catch (...)
+			{
+				claim_error = std::current_exception();
+			}
+			queue.Close();
+			});
+
+		auto work = [&](int64_t, int64_t) {
+			try
+			{
+				int64_t block_start;
+				while (queue.Pop(block_start))
+				{
+					std::vector<DynaPlex::NN::Sample> block(std::min(block_start + block_size, end) - block_start);
+					this->GenerateSamplesOnThread(block, policy, block_start);
+					bool complete = std::all_of(block.begin(), block.end(), [](const DynaPlex::NN::Sample& sample) { return sample.state != nullptr; });
+					std::vector<uint8_t> bytes;
+					if (complete && !checkpoint_path.empty())
+					{
+						DynaPlex::NN::SampleData data{ mdp };
+						data.Samples = std::move(block);
+						bytes = data.Serialize(mdp);
+						block = std::move(data.Samples);
+					}
+					std::lock_guard lock(results_mutex);
+					if (!bytes.empty())
+						AppendCheckpointRecord(own_checkpoint, { block_start, block_start + static_cast<int64_t>(block.size()), bytes });
+					all_blocks_complete = all_blocks_complete && complete;
+					for (auto& sample : block)
+						if (sample.state)
+							sample_vec.push_back(std::move(sample));
+				}
+			}
+			catch (...)
+			{//stop claiming, and let the other workers finish. 
+				queue.Close(true);
+				throw;
+			}
+			};
+		pool.ForEach(num_workers, num_workers, work);
+		claimer.join();
+		if (claim_error)
+			std::rethrow_exception(claim_error);
+		if (!silent)
+			system << std::endl;
+		collection_complete = claimed_all && all_blocks_complete;
+		//blocks are completed out of order, and blocks loaded from the checkpoint precede them; restore the order of sample numbers. 
+		std::sort(sample_vec.begin(), sample_vec.end(),
+			[](const DynaPlex::NN::Sample& a, const DynaPlex::NN::Sample& b) { return a.sample_number < b.sample_number; });
+		return sample_vec;
 	}
-}
\ No newline at end of file
+}
@@ -2,7 +2,10 @@
 #include "dynaplex/trajectory.h"
 #include "dynaplex/parallel_execute.h"
 #include "dynaplex/policycomparison.h"
+#include "rollouts.h"
+#include <algorithm>
 #include <cmath>
+#include <numeric>
 namespace DynaPlex::DCL {
 
 
@@ -12,15 +15,42 @@ namespace DynaPlex::DCL {
 		int64_t experiment_number;
 	};
 
-	SequentialHalving::SequentialHalving(int64_t rng_seed, int64_t H, int64_t M, DynaPlex::MDP& mdp, DynaPlex::Policy& policy)
-		: rng_seed{ rng_seed }, H{ H }, M{ M }, mdp{ mdp }, policy{ policy }
+	SequentialHalving::SequentialHalving(int64_t rng_seed, int64_t H, int64_t M, DynaPlex::MDP& mdp, DynaPlex::Policy& policy, DynaPlex::Parallel::ThreadPool* rollout_pool,
+		double target_z_stat)
+		: rng_seed{ rng_seed }, H{ H }, M{ M }, mdp{ mdp }, policy{ policy }, rollout_pool{ rollout_pool }, target_z_stat{ target_z_stat }
 	{
-
+		if (target_z_stat < 0.0)
+			throw DynaPlex::Error("SequentialHalving: target_z_stat should be non-negative.");
 	}
 
 	bool adopt_crn_sh = true;
 	int64_t max_chunk_size_sh = 256;
 	int64_t max_steps_until_completion_expected_sh = 1000000;
+	//replications per action between two eliminations in adaptive mode, at the least. 
+	int64_t min_stage_budget_sh = 16;
+
+	namespace {
+		//probability that a standard normal variable exceeds z.
+		double UpperTail(double z)
+		{
+			return 0.5 * std::erfc(z / std::sqrt(2.0));
+		}
+
+		//z such that UpperTail(z) equals probability (in (0,0.5]), by bisection. 
+		double UpperTailQuantile(double probability)
+		{
+			double low = 0.0, high = 40.0;
+			for (int64_t iter = 0; iter < 100; iter++)
+			{
+				double mid = 0.5 * (low + high);
+				if (UpperTail(mid) > probability)
+					low = mid;
+				else
+					high = mid;
+			}
+			return high;
+		}
+	}
 	void SequentialHalving::SetAction(DynaPlex::Trajectory& traj, DynaPlex::NN::Sample& sample, int64_t seed) const
 	{
 		if (!traj.Category.IsAwaitAction())
@@ -44,7 +74,11 @@ namespace DynaPlex::DCL {
 			throw DynaPlex::Error("SequentialHalving::SetAction - called for state with only single<=1 allowed actions.");
 
 		std::vector<experiment_info> experiment_information{};
-		std::vector<DynaPlex::Trajectory> trajectories{};
+		std::vector<RolloutExperiment> experiments{};
+		std::vector<double> returns{};
+		RolloutSettings settings{ rng_seed, seed, H, max_chunk_size_sh, max_steps_until_completion_expected_sh, "SequentialHalving::SetAction", rollout_pool, adopt_crn_sh };
+		//recycled over the rounds of this sample only. 
+		std::vector<DynaPlex::TrajectoryPool> trajectory_pools{};
 
 		double objective = mdp->Objective(root_state);
 		std::vector<double> accumulated_rewards(root_actions.size(), 0.0);
@@ -52,131 +86,98 @@ namespace DynaPlex::DCL {
 		int64_t total_budget_used_per_action{ 0 };
 		int64_t seed_keeper{ 0 }; // used when disabling CRN
 		int64_t total_budget = M * root_actions.size();
+		int64_t remaining_budget = total_budget;
 		int64_t total_rounds = ceil(log(root_actions.size()) / log(2));
 		auto competing_actions = root_actions;
+		//number of eliminations in adaptive mode so far. 
+		int64_t stages = 0;
+		double best_reward = -std::numeric_limits<double>::infinity();
 
-		for (int64_t iter = 0; iter < total_rounds; iter++)
+		for (int64_t iter = 0; iter < total_rounds && competing_actions.size() > 1; iter++)
 		{
 			//Number of scenarios assigned for each competing_action at this round.
 			int64_t action_budget = std::floor(total_budget / (competing_actions.size() * std::ceil(std::log(root_actions.size()) / std::log(static_cast<double>(2)))));
+			if (adaptive())
+			{//budget that was saved in earlier rounds is spread over the rounds that remain. 
+				int64_t rounds_left = std::ceil(std::log(competing_actions.size()) / std::log(static_cast<double>(2)));
+				action_budget = remaining_budget / (competing_actions.size() * rounds_left);
+			}
 			//Number of competing_actions to be kept at the end of this round.
 			int64_t top_m = std::ceil(competing_actions.size() / static_cast<double>(2));
+			//In adaptive mode, the round is simulated in stages, after each of which conclusively worse actions are eliminated. 
+			int64_t stage_budget = adaptive() ? std::max(min_stage_budget_sh, action_budget / 8) : action_budget;
 
-			//Clearing and reserving resourses.
-			trajectories.clear();
-			experiment_information.clear();
-			trajectories.reserve(competing_actions.size() * action_budget);
-			experiment_information.reserve(competing_actions.size() * action_budget);
-
-			//Create action_budget replications for each competing_action, with appropriate random seed.
-			for (int64_t replication = 0; replication < action_budget; replication++)
+			for (int64_t round_budget_used = 0; round_budget_used < action_budget && static_cast<int64_t>(competing_actions.size()) > top_m;)
 			{
-				for (int64_t action_id = 0; action_id < competing_actions.size(); action_id++)
-				{
-					auto competing_action = competing_actions[action_id];
-					trajectories.push_back(DynaPlex::Trajectory(experiment_information.size()));
-					int64_t traj_seed = adopt_crn_sh ? (total_budget_used_per_action + replication) : seed_keeper + experiment_information.size() + 1;
-					trajectories.back().RNGProvider.SeedEventStreams(false,rng_seed,seed, traj_seed);
-					trajectories.back().NextAction = competing_action;
-					experiment_information.push_back(DynaPlex::DCL::experiment_info(action_id, replication));
-				}
-			}
-			seed_keeper += experiment_information.size(); 
+				int64_t budget = std::min(stage_budget, action_budget - round_budget_used);
+				//Clearing and reserving resourses.
+				experiments.clear();
+				experiment_information.clear();
+				experiments.reserve(competing_actions.size() * budget);
+				experiment_information.reserve(competing_actions.size() * budget);
 
-			//iterate over chunks of the trajectories list, and process those for H steps or until final state. 
-			auto chunks = DynaPlex::Parallel::get_chunks(trajectories.size(), max_chunk_size_sh);
-			for (auto& [start, end] : chunks)
-			{
-				std::span<DynaPlex::Trajectory> span(&trajectories[start], end - start);
-				mdp->InitiateState(span, root_state);
-				mdp->IncorporateAction(span);
-				int64_t count = 0;
-				while (true)
+				//Create budget replications for each competing_action, with appropriate random seed.
+				for (int64_t replication = 0; replication < budget; replication++)
 				{
-					if (!mdp->IncorporateUntilAction(span, H))
+					for (int64_t action_id = 0; action_id < static_cast<int64_t>(competing_actions.size()); action_id++)
 					{
-						//This "sorts" the trajectories, such that the trajectories that are IsAwaitAction are at the front.
-						// Note that mdp->IncorporateAction only accepts set of adjacent trajectories that are all AwaitAction. 
-						std::span<DynaPlex::Trajectory>::iterator new_partition_point = std::partition(span.begin(), span.end(),
-							[](const DynaPlex::Trajectory& traj) {return traj.Category.IsAwaitAction(); }
-						);
-						//new_partition_point is the first element which does not require an action. 
-						//Make the span refer to a set of trajectories each awaiting an action:
-						span = std::span<DynaPlex::Trajectory>(span.begin(), new_partition_point);
-						if (++count > max_steps_until_completion_expected_sh)
-							throw DynaPlex::Error("SequentialHalving::SetAction"
-								"- expected completion of simulation run after max_steps_until_completion_expected: "
-								+ std::to_string(max_steps_until_completion_expected_sh) +
-								" but completion was not reached.");
+						auto competing_action = competing_actions[action_id];
+						int64_t traj_seed = adopt_crn_sh ? (total_budget_used_per_action + replication) : seed_keeper + experiment_information.size() + 1;
+						experiments.push_back(RolloutExperiment{ competing_action, traj_seed });
+						experiment_information.push_back(DynaPlex::DCL::experiment_info(action_id, replication));
 					}
-					//This means all trajectories are at period warmup_periods or final. 
-					if (span.size() == 0)
-						break;
-					//other actions use roll-out policy.
-					mdp->IncorporateAction(span, policy);
 				}
-				//reset span to original
-				span = { &trajectories[start], static_cast<size_t>(end - start) };
-				//some checks:
-				if (mdp->IsInfiniteHorizon())
+				seed_keeper += experiment_information.size();
+
+				//simulate each experiment for H steps or until final state. 
+				returns.assign(experiments.size(), 0.0);
+				Rollout(mdp, policy, root_state, experiments, settings, returns, trajectory_pools);
+
+				std::vector<std::vector<double>> return_results(competing_actions.size(), std::vector<double>(budget, 0.0));
+				//A vector of tokens keeping track of the indices of competing_actions in the original root_actions
+				std::vector<int64_t> action_id_keeper(competing_actions.size(), -1);
+				//Collect results and draw conclusion:
+				for (size_t experiment = 0; experiment < experiments.size(); experiment++)
 				{
-					for (auto& traj : span)
-					{
-						if (traj.Category.IsFinal())
-							throw DynaPlex::Error("SequentialHalving::SetAction - state has Final Category but MDP is infinite horizon()");
-						if (traj.PeriodCount != H)
-							throw DynaPlex::Error("SequentialHalving::SetAction - unexpected value of PeriodCount after rollout");
+					auto& info = experiment_information[experiment];
+					double cumulative_return = returns[experiment];
+					//We have results for each competing action. 
+					return_results.at(info.action_id).at(info.experiment_number) = cumulative_return * objective;
+					auto it = std::lower_bound(root_actions.begin(), root_actions.end(), competing_actions.at(info.action_id));
+					if (it != root_actions.end() && *it == competing_actions.at(info.action_id)) {
+						int64_t action_original_id = it - root_actions.begin();
+						accumulated_rewards.at(action_original_id) += cumulative_return * objective;
+						if (action_id_keeper.at(info.action_id) == -1) {
+							action_id_keeper.at(info.action_id) = action_original_id;
+						}
 					}
-				}
-				else
-				{
-					for (auto& traj : span)
-						if (!(traj.Category.IsFinal() || traj.PeriodCount == H))
-							throw DynaPlex::Error("SequentialHalving::SetAction - unexpected trajectory status after rollout");
-				}
-				//freeing resources
-				for (auto& traj : span)
-					traj.DeleteState();
-			}
-
-			std::vector<std::vector<double>> return_results(competing_actions.size(), std::vector<double>(action_budget, 0.0));
-			//A vector of tokens keeping track of the indices of competing_actions in the original root_actions
-			std::vector<int64_t> action_id_keeper(competing_actions.size(), -1);
-			//Collect results and draw conclusion:
-			for (auto& traj : trajectories)
-			{
-				//Note that trajectories were possibly reshuffled; recover experiment information safely:
-				auto& info = experiment_information[traj.ExternalIndex];
-				//We have results for each competing action. 
-				return_results.at(info.action_id).at(info.experiment_number) = traj.CumulativeReturn * objective;
-				auto it = std::lower_bound(root_actions.begin(), root_actions.end(), competing_actions.at(info.action_id));
-				if (it != root_actions.end() && *it == competing_actions.at(info.action_id)) {
-					int64_t action_original_id = it - root_actions.begin();
-					accumulated_rewards.at(action_original_id) += traj.CumulativeReturn * objective;
-					if (action_id_keeper.at(info.action_id) == -1) {
-						action_id_keeper.at(info.action_id) = action_original_id;
+					else {
+						throw DynaPlex::Error("SequentialHalving::SetAction - cannot find action_originial_id.");
 					}
 				}
-				else {
-					throw DynaPlex::Error("SequentialHalving::SetAction - cannot find action_originial_id.");
+
+				//Append the results
+				for (int64_t action_id = 0; action_id < static_cast<int64_t>(competing_actions.size()); action_id++) {
+					int64_t action_original_id = action_id_keeper[action_id];
+					trajectory_costs[action_original_id].insert(
+						trajectory_costs[action_original_id].end(),
+						return_results[action_id].begin(),
+						return_results[action_id].end()
+					);
 				}
-			}
 
-			//Append the results
-			for (int64_t action_id = 0; action_id < competing_actions.size(); action_id++) {
-				int64_t action_original_id = action_id_keeper[action_id];
-				trajectory_costs[action_original_id].insert(
-					trajectory_costs[action_original_id].end(),
-					return_results[action_id].begin(),
-					return_results[action_id].end()
-				);
+				total_budget_used_per_action += budget;
+				remaining_budget -= budget * competing_actions.size();
+				round_budget_used += budget;
+				if (adaptive())
+					EliminateConclusivelyWorse(competing_actions, root_actions, trajectory_costs, ++stages);
 			}
 
-			total_budget_used_per_action += action_budget;
 			// Pairing the competing actions and mean rewards
 			std::vector<std::pair<int64_t, double>> paired;
-			for (int64_t i = 0; i < competing_actions.size(); ++i) {
-				double mean_reward = accumulated_rewards[action_id_keeper[i]] / total_budget_used_per_action;
+			for (int64_t i = 0; i < static_cast<int64_t>(competing_actions.size()); ++i) {
+				auto it = std::lower_bound(root_actions.begin(), root_actions.end(), competing_actions[i]);
+				double mean_reward = accumulated_rewards[it - root_actions.begin()] / total_budget_used_per_action;
 				paired.push_back({ competing_actions[i], mean_reward });
 			}
 			// Sorting the competing actions based on mean rewards by arg_max
@@ -184,6 +185,7 @@ namespace DynaPlex::DCL {
 			std::sort(paired.begin(), paired.end(), [](const auto& a, const auto& b) {
 				return a.second > b.second;
 				});
+			top_m = std::min<int64_t>(top_m, paired.size());
 			// Extracting the top_m performing actions
 			for (int i = 0; i < top_m; ++i) {
 				competing_actions[i] = paired[i].first;
@@ -193,59 +195,99 @@ namespace DynaPlex::DCL {
 			}
 			competing_actions.resize(top_m); // keep only top_m performing actions
 
-			double best_reward = paired[0].second;
+			best_reward = paired[0].second;
 			if (best_reward == -std::numeric_limits<double>::infinity())
 				throw DynaPlex::Error("SequentialHalving:SetAction - error in logic");
+		}
 
-			if (iter == total_rounds - 1)
-			{
-				// Sequential halving algorithm ends, collect statistics 
-				traj.NextAction = competing_actions.front();
-				sample.state = traj.GetState()->Clone();
-				sample.sample_number = seed;
-				sample.action_label = traj.NextAction;
-				sample.cost_improvement.reserve(root_actions.size());
-				sample.q_hat_vec.reserve(root_actions.size());
-				sample.probabilities.reserve(root_actions.size());
-				sample.q_hat = best_reward * objective;
-
-				int64_t best_action_id = 0;
-				auto it = std::lower_bound(root_actions.begin(), root_actions.end(), traj.NextAction);
-				if (it != root_actions.end() && *it == traj.NextAction) {
-					best_action_id = it - root_actions.begin();
-				}
-				else {
-					throw DynaPlex::Error("SequentialHalving::SetAction - cannot find best_action_id.");
-				}
+		// Sequential halving algorithm ends, collect statistics 
+		traj.NextAction = competing_actions.front();
+		sample.state = traj.GetState()->Clone();
+		sample.sample_number = seed;
+		sample.action_label = traj.NextAction;
+		sample.cost_improvement.reserve(root_actions.size());
+		sample.q_hat_vec.reserve(root_actions.size());
+		sample.probabilities.reserve(root_actions.size());
+		sample.q_hat = best_reward * objective;
 
-				DynaPlex::PolicyComparison comp(std::move(trajectory_costs));
-				bool ValueBasedProbability = true;
-				int64_t least_action_budget = floor(total_budget / (root_actions.size() * ceil(log(root_actions.size()) / log(static_cast<double>(2)))));
-				if (least_action_budget > 1) {
-					comp.ComputeZstatistics(best_action_id);
-					comp.ComputeProbabilities(ValueBasedProbability);
-				}
-				else {
-					comp.ComputeProbabilities(false);
-					sample.z_stat = 0.0;
-				}
+		int64_t best_action_id = 0;
+		auto best_it = std::lower_bound(root_actions.begin(), root_actions.end(), traj.NextAction);
+		if (best_it != root_actions.end() && *best_it == traj.NextAction) {
+			best_action_id = best_it - root_actions.begin();
+		}
+		else {
+			throw DynaPlex::Error("SequentialHalving::SetAction - cannot find best_action_id.");
+		}
 
-				double zValueForBestAlternative = 100.0;
-				for (int64_t action_id = 0; action_id < root_actions.size(); action_id++) {
-					sample.cost_improvement.push_back(comp.mean(action_id, prescribed_action_initial_policy, true) * objective);
-					sample.q_hat_vec.push_back(comp.mean(action_id) * objective);
-					sample.probabilities.push_back(comp.GetProbability(action_id));
-					if (action_id != best_action_id && least_action_budget > 1)
-					{
-						double zValue = comp.GetZstatistic(action_id);
-						zValueForBestAlternative = std::min(zValue, zValueForBestAlternative);
-					}
-				}
-				if (least_action_budget > 1) {
-					sample.z_stat = zValueForBestAlternative;
-				}
+		DynaPlex::PolicyComparison comp(std::move(trajectory_costs));
+		bool ValueBasedProbability = true;
+		int64_t least_action_budget = floor(total_budget / (root_actions.size() * ceil(log(root_actions.size()) / log(static_cast<double>(2)))));
+		if (least_action_budget > 1) {
+			comp.ComputeZstatistics(best_action_id);
+			comp.ComputeProbabilities(ValueBasedProbability);
+		}
+		else {
+			comp.ComputeProbabilities(false);
+			sample.z_stat = 0.0;
+		}
+
+		double zValueForBestAlternative = 100.0;
+		for (int64_t action_id = 0; action_id < static_cast<int64_t>(root_actions.size()); action_id++) {
+			sample.cost_improvement.push_back(comp.mean(action_id, prescribed_action_initial_policy, true) * objective);
+			sample.q_hat_vec.push_back(comp.mean(action_id) * objective);
+			sample.probabilities.push_back(comp.GetProbability(action_id));
+			if (action_id != best_action_id && least_action_budget > 1)
+			{
+				double zValue = comp.GetZstatistic(action_id);
+				zValueForBestAlternative = std::min(zValue, zValueForBestAlternative);
 			}
 		}
+		if (least_action_budget > 1) {
+			sample.z_stat = zValueForBestAlternative;
+		}
+	}
+
+	void SequentialHalving::EliminateConclusivelyWorse(std::vector<int64_t>& competing_actions, const std::vector<int64_t>& root_actions,
+		const std::vector<std::vector<double>>& trajectory_costs, int64_t stage) const
+	{
+		if (competing_actions.size() < 2)
+			return;
+		//alpha spending: the error probability of target_z_stat is spread over the stages, with share 6/(pi^2 stage^2) for this stage. 
+		//The best action is eliminated only if its own comparison with the leader rejects, so no correction for the number of comparisons is needed. 
+		constexpr double pi = 3.14159265358979323846;
+		double alpha = UpperTail(target_z_stat) * 6.0 / (pi * pi * static_cast<double>(stage) * static_cast<double>(stage));
+		double z_threshold = UpperTailQuantile(alpha);
+		auto costs_of = [&](int64_t action) -> const std::vector<double>& {
+			return trajectory_costs[std::lower_bound(root_actions.begin(), root_actions.end(), action) - root_actions.begin()];
+			};
+		//all competing actions have the same number of replications, which are paired by their common random numbers. 
+		auto leader = *std::max_element(competing_actions.begin(), competing_actions.end(), [&](int64_t a, int64_t b) {
+			auto& costs_a = costs_of(a);
+			auto& costs_b = costs_of(b);
+			return std::accumulate(costs_a.begin(), costs_a.end(), 0.0) < std::accumulate(costs_b.begin(), costs_b.end(), 0.0);
+			});
+		auto& leader_costs = costs_of(leader);
+		size_t n = leader_costs.size();
+		if (n < 2)
+			return;
+		std::erase_if(competing_actions, [&](int64_t action) {
+			if (action == leader)
+				return false;
+			auto& costs = costs_of(action);
+			double sum = 0.0, sum_squares = 0.0;
+			for (size_t k = 0; k < n; k++)
+			{
+				double difference = leader_costs[k] - costs[k];
+				sum += difference;
+				sum_squares += difference * difference;
+			}
+			double mean = sum / n;
+			double variance = std::max(0.0, (sum_squares - n * mean * mean) / (n - 1));
+			double standard_error = std::sqrt(variance / n);
+			if (mean <= 0.0)
+				return false;
+			return standard_error == 0.0 || mean / standard_error >= z_threshold;
+			});
 	}
 
 }  // namespace DynaPlex::DCL
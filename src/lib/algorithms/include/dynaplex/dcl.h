@@ -24,8 +24,14 @@ namespace DynaPlex::Algorithms {
 
 		int64_t num_gens,resume_gen, rng_seed;
 		bool retrain_lastgen_only, silent, delete_samples_after_training, keep_samples_lastgen_only;
+		//"json": samples with states are stored as json; "binary": samples with features are stored as DynaPlex::NN::SampleFile.
+		std::string sample_file_format;
 		DynaPlex::NN::PolicyTrainer trainer;
 		DynaPlex::VarGroup nn_architecture = DynaPlex::VarGroup{};
+		//passed to TrainedPolicyProvider::LoadPolicy for the policies of generations > 0.
+		DynaPlex::VarGroup nn_inference = DynaPlex::VarGroup{};
+		//nn_inference "precision": with "bf16" or "int8", every trained policy is quantized, and the quantized policies are used. 
+		std::string inference_precision;
 		DynaPlex::MDP mdp;
 		DynaPlex::Policy policy_0;
 		DynaPlex::System system;
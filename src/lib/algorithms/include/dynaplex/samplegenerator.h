@@ -1,10 +1,15 @@
 #pragma once
+#include <chrono>
+#include <functional>
+#include <set>
+#include <unordered_map>
 #include "dynaplex/mdp.h"
 #include "dynaplex/policy.h"
 #include "dynaplex/system.h"
 #include "dynaplex/vargroup.h"
 #include "dynaplex/uniformactionselector.h"
 #include "dynaplex/sequentialhalving.h"
+#include "dynaplex/sampledata.h"
 
 namespace DynaPlex::DCL {
 	class SampleGenerator
@@ -12,7 +17,15 @@ namespace DynaPlex::DCL {
 	public:
 		SampleGenerator(const DynaPlex::System&, DynaPlex::MDP, const DynaPlex::VarGroup& config = VarGroup{});
 
-		/// This generates samples and stores the features alognside the collected information.  
+		/**
+		 * This generates samples and stores the features alognside the collected information.
+		 * With config sample_file_format "binary", the samples are stored as DynaPlex::NN::SampleFile; with "json" (default), as json.
+		 * Collection stops after sampling_time_out seconds; the file then holds the samples collected until then. 
+		 * With config checkpoint, completed blocks of samples are appended to checkpoint files next to file_path while collecting. A call 
+		 * with the same file_path and settings resumes from these files, e.g. after the process was killed or timed out, and removes them
+		 * once collection completes. With checkpoint, static load_balancing also collects in blocks of block_size, which are seeded
+		 * differently than the share of a thread; the samples then differ from those collected without checkpoint. 
+		 */
 		void GenerateSamples(DynaPlex::Policy,const std::string& file_path);
 		/// This generates samples and stores the state alongside the collected information 
 		void GenerateStateSamples(DynaPlex::Policy,const std::string& file_path);
@@ -20,9 +33,49 @@ namespace DynaPlex::DCL {
 	private:
 
 		std::string GetPathOfTempSampleFile(int rank);
+		/// Checkpoint file of node rank, for samples that are collected for output_path. 
+		std::string GetPathOfCheckpoint(const std::string& output_path, int rank);
+
+		/**
+		 * Collects the samples on all nodes. Returns all samples, shuffled, on node 0, and the samples collected on this node otherwise.
+		 * Uses and extends the checkpoint files of output_path if checkpoint is enabled.
+		 */
+		DynaPlex::NN::SampleData CollectSamples(DynaPlex::Policy, const std::string& output_path);
+		/// Removes the checkpoint file of this node if it collected all its samples; to be called after the samples are saved. 
+		void RemoveCompletedCheckpoint(const std::string& output_path);
+
+		/// Collects the samples for the slice of [0,N) that get_splits assigns to this node. 
+		std::vector<DynaPlex::NN::Sample> CollectStaticSplit(DynaPlex::Policy, const std::string& checkpoint_path);
+		/// Collects blocks of block_size samples, claimed on demand from a counter that is shared between nodes, until N samples are claimed. 
+		std::vector<DynaPlex::NN::Sample> CollectBlocksOnDemand(DynaPlex::Policy, const std::string& checkpoint_path);
+		/**
+		 * Collects blocks [claim(block_size),claim(block_size)+block_size) until a claim reaches end. A dedicated thread calls claim, one block
+		 * at a time, and hands the blocks to the worker threads as these become idle. Blocks listed in the checkpoint files are loaded instead
+		 * of collected; other completed blocks are appended to the checkpoint of this node (if checkpoint_path is not empty). 
+		 */
+		std::vector<DynaPlex::NN::Sample> CollectBlocks(DynaPlex::Policy, const std::function<int64_t(int64_t)>& claim, int64_t begin, int64_t end,
+			const std::string& checkpoint_path);
+		/// Loads the samples in the checkpoint of this node into samples, and returns the blocks [start,end) flushed by any node. 
+		std::set<std::pair<int64_t, int64_t>> ResumeFromCheckpoints(DynaPlex::Policy, const std::string& checkpoint_path, std::vector<DynaPlex::NN::Sample>& samples);
+		/// Settings that determine the samples in a block, including seed_offset and a hash of the policy configuration; checkpoints created with other settings are discarded.
+		DynaPlex::VarGroup CheckpointSettings(DynaPlex::Policy) const;
+
+		/// Whether sampling_time_out has passed since collection of the current generation started. 
+		bool TimedOut() const;
 
 		void GenerateSamplesOnThread(std::span<DynaPlex::NN::Sample>, DynaPlex::Policy, int64_t);
 
+		//samples collected earlier by a single lane (trajectory) of GenerateSamplesOnThread, by hash of their state.
+		using StateMemo = std::unordered_multimap<int64_t, DynaPlex::NN::Sample>;
+		/// Fills sample with state and the statistics of an earlier sample of an equal state in state_memo, if any. 
+		bool RecallState(const StateMemo& state_memo, const DynaPlex::dp_State& state, DynaPlex::NN::Sample& sample) const;
+		/// Stores the statistics of sample in state_memo for reuse by samples of equal states. 
+		void MemorizeState(StateMemo& state_memo, const DynaPlex::NN::Sample& sample) const;
+
+		std::chrono::steady_clock::time_point sampling_deadline;
+		//whether this node collected all samples assigned to it in the last call to CollectSamples, i.e. without timing out. 
+		bool collection_complete = false;
+
 		//for a progress count when generating samples accross threads. 
 		std::shared_ptr<std::atomic<int64_t>> total_samples_collected;
 
@@ -30,10 +83,30 @@ namespace DynaPlex::DCL {
 		int64_t node_sampling_offset;
 		int64_t sampling_time_out, H, M, N, L, reinitiate_counter, json_save_format;
 		int64_t seed_offset;
+		//number of consecutive samples that are collected with a single trajectory in "dynamic" load balancing.
+		int64_t block_size;
+		//number of trajectories that each thread advances in lockstep; calls to the base policy are batched over these trajectories. 
+		//Each trajectory is seeded as the start of a separate span of samples, so the samples depend on this number. 
+		int64_t trajectories_per_thread;
+		//"static" (fixed share of N per node) or "dynamic" (blocks are handed out on demand).
+		std::string load_balancing;
+		//"json" or "binary"; format of the file written by GenerateSamples.
+		std::string sample_file_format;
 
 		bool enable_sequential_halving,silent;
+		//whether completed blocks of samples are flushed to checkpoint files, from which an interrupted collection resumes. 
+		bool checkpoint;
+		//whether samples are sent to node 0 via temporary files in the IO directory, also if message-passing is available. 
+		bool gather_via_files;
+		//whether the rollouts for a single sample are distributed over the worker pool, in addition to distributing samples. 
+		bool parallel_rollouts;
+		//whether samples of states that are equal to a state sampled earlier by the same trajectory (lane) reuse its statistics instead of rollouts. 
+		//Memos are not shared between lanes, so samples do not depend on thread timing. 
+		bool memoize_states;
 		//probability that a sample is taken on a specific action-awaiting state. 
 		double sampling_probability;
+		//z-statistic that sets the error rate at which sequential halving eliminates actions early (see SequentialHalving); 0.0 for a fixed budget. 
+		double target_z_stat;
 
 		DynaPlex::MDP mdp;
 		DynaPlex::System system;
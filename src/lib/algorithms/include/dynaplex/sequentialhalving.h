@@ -4,6 +4,7 @@
 #include "dynaplex/system.h"
 #include "dynaplex/vargroup.h"
 #include "dynaplex/sample.h"
+#include "dynaplex/threadpool.h"
 
 namespace DynaPlex::DCL {
 	/**
@@ -18,7 +19,18 @@ namespace DynaPlex::DCL {
 
 	public:
 		SequentialHalving() = default;
-		SequentialHalving(int64_t rng_seed, int64_t H, int64_t M, DynaPlex::MDP&, DynaPlex::Policy&);
+		/**
+		 * If rollout_pool is provided, the rollouts for a single sample are distributed over the threads of that pool. 
+		 * The results are identical to those of sequential execution.
+		 * If target_z_stat is positive, the budget is adaptive: each round is simulated in stages, and after each stage, actions of which
+		 * the paired difference with the leading action has a z-statistic of at least target_z_stat are eliminated. A round ends as soon as
+		 * the halving is reached, and budget that remains is spent in later rounds, on the actions that are harder to tell apart. 
+		 * target_z_stat fixes the probability alpha = P(Z >= target_z_stat), Z standard normal, of eliminating the best action, over all
+		 * stages of a sample together: stage s tests at level 6 alpha / (pi^2 s^2) (alpha spending; the levels sum to alpha). Hence the
+		 * z-statistic needed to eliminate is larger than target_z_stat, and grows with s. Paired differences are assumed approximately normal. 
+		 */
+		SequentialHalving(int64_t rng_seed, int64_t H, int64_t M, DynaPlex::MDP&, DynaPlex::Policy&, DynaPlex::Parallel::ThreadPool* rollout_pool = nullptr,
+			double target_z_stat = 0.0);
 
 		void SetAction(DynaPlex::Trajectory& traj, DynaPlex::NN::Sample& sample, int64_t seed) const;
 
@@ -26,10 +38,17 @@ namespace DynaPlex::DCL {
 
 
 	private:
+		bool adaptive() const { return target_z_stat > 0.0; }
+		/// Removes the competing actions that are conclusively worse than the competing action with the highest mean, at the level of stage (1-based). 
+		void EliminateConclusivelyWorse(std::vector<int64_t>& competing_actions, const std::vector<int64_t>& root_actions,
+			const std::vector<std::vector<double>>& trajectory_costs, int64_t stage) const;
+
 		int64_t rng_seed;
 		int64_t H, M;
 		DynaPlex::Policy policy;
 		DynaPlex::MDP mdp;
+		DynaPlex::Parallel::ThreadPool* rollout_pool = nullptr;
+		double target_z_stat = 0.0;
 
 	};
 }//namespace DynaPlex::Utilities
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "dynaplex/system.h"
 #include "dynaplex/vargroup.h"
 #include "dynaplex/sample.h"
+#include "dynaplex/threadpool.h"
 
 namespace DynaPlex::DCL {
 	class UniformActionSelector {
@@ -11,7 +12,11 @@ namespace DynaPlex::DCL {
 	
 	public:
 		UniformActionSelector() = default;
-		UniformActionSelector(int64_t rng_seed, int64_t H, int64_t M, DynaPlex::MDP&, DynaPlex::Policy&);
+		/**
+		 * If rollout_pool is provided, the rollouts for a single sample are distributed over the threads of that pool. 
+		 * The results are identical to those of sequential execution.
+		 */
+		UniformActionSelector(int64_t rng_seed, int64_t H, int64_t M, DynaPlex::MDP&, DynaPlex::Policy&, DynaPlex::Parallel::ThreadPool* rollout_pool = nullptr);
 
 		void SetAction(DynaPlex::Trajectory& traj, DynaPlex::NN::Sample& sample, int64_t seed) const;
 
@@ -23,6 +28,7 @@ namespace DynaPlex::DCL {
 		int64_t H, M;
 		DynaPlex::Policy policy;
 		DynaPlex::MDP mdp;
+		DynaPlex::Parallel::ThreadPool* rollout_pool = nullptr;
 
 	};
 }//namespace DynaPlex::Utilities
\ No newline at end of file
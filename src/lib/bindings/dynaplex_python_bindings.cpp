@@ -10,6 +10,7 @@ void define_dcl_bindings(pybind11::module_& m);
 void define_gym_emulator_bindings(pybind11::module_& m);
 void define_sample_generator_bindings(pybind11::module_& m);
 void define_demonstrator_bindings(pybind11::module_& m);
+void define_sample_file_bindings(pybind11::module_& m);
 	
 PYBIND11_MODULE(DP_Bindings, m) {
 	m.doc() = "DynaPlex extension for Python";	
@@ -20,6 +21,7 @@ PYBIND11_MODULE(DP_Bindings, m) {
 	define_dcl_bindings(m);
 	define_gym_emulator_bindings(m);
 	define_sample_generator_bindings(m);
+	define_sample_file_bindings(m);
 	define_demonstrator_bindings(m);
 	define_provider_bindings(m);
 
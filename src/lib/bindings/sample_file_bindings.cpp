@@ -0,0 +1,70 @@
+#include "dynaplex/samplefile.h"
+#include <pybind11/stl.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include "vargroupcaster.h"
+
+namespace {
+	//read-only numpy view on a column of the memory-mapped file. The array keeps the sample_file (and hence the mapping) alive.
+	template<typename T>
+	py::array_t<T> ColumnView(py::object owner, std::span<const T> column, int64_t rows, int64_t cols)
+	{
+		std::vector<py::ssize_t> shape, strides;
+		if (cols > 0)
+		{
+			shape = { rows, cols };
+			strides = { static_cast<py::ssize_t>(cols * sizeof(T)), static_cast<py::ssize_t>(sizeof(T)) };
+		}
+		else
+		{
+			shape = { rows };
+			strides = { static_cast<py::ssize_t>(sizeof(T)) };
+		}
+		py::array_t<T> array(shape, strides, column.data(), owner);
+		array.attr("setflags")(py::arg("write") = false);
+		return array;
+	}
+}
+
+void define_sample_file_bindings(pybind11::module_& m) {
+	using DynaPlex::NN::SampleFile;
+	py::class_<SampleFile>(m, "sample_file", "Binary sample file written by sample_generator.generate_samples with sample_file_format \"binary\". Columns are exposed as read-only numpy arrays that share memory with the file.")
+		.def(py::init<const std::string&>(), py::arg("file_path"))
+		.def_static("is_sample_file", &SampleFile::IsSampleFile, py::arg("file_path"))
+		.def_property_readonly("num_samples", &SampleFile::NumSamples)
+		.def_property_readonly("num_features", &SampleFile::NumFeatures)
+		.def_property_readonly("num_valid_actions", &SampleFile::NumValidActions)
+		.def_property_readonly("identifier", &SampleFile::Identifier)
+		.def_property_readonly("features", [](py::object self) {
+			auto& file = self.cast<const SampleFile&>();
+			return ColumnView(self, file.Features(), file.NumSamples(), file.NumFeatures());
+			})
+		.def_property_readonly("mask", [](py::object self) {
+			auto& file = self.cast<const SampleFile&>();
+			return ColumnView(self, file.Mask(), file.NumSamples(), file.NumValidActions());
+			})
+		.def_property_readonly("probabilities", [](py::object self) {
+			auto& file = self.cast<const SampleFile&>();
+			return ColumnView(self, file.Probabilities(), file.NumSamples(), file.NumValidActions());
+			})
+		.def_property_readonly("cost_improvement", [](py::object self) {
+			auto& file = self.cast<const SampleFile&>();
+			return ColumnView(self, file.CostImprovement(), file.NumSamples(), file.NumValidActions());
+			})
+		.def_property_readonly("action_label", [](py::object self) {
+			auto& file = self.cast<const SampleFile&>();
+			return ColumnView(self, file.ActionLabels(), file.NumSamples(), 0);
+			})
+		.def_property_readonly("sample_number", [](py::object self) {
+			auto& file = self.cast<const SampleFile&>();
+			return ColumnView(self, file.SampleNumbers(), file.NumSamples(), 0);
+			})
+		.def_property_readonly("q_hat", [](py::object self) {
+			auto& file = self.cast<const SampleFile&>();
+			return ColumnView(self, file.QHat(), file.NumSamples(), 0);
+			})
+		.def_property_readonly("z_stat", [](py::object self) {
+			auto& file = self.cast<const SampleFile&>();
+			return ColumnView(self, file.ZStat(), file.NumSamples(), 0);
+			});
+}
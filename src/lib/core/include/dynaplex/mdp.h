@@ -6,6 +6,7 @@
 #include "vargroup.h"
 #include "policy.h"
 #include "trajectory.h"
+#include "trajectorybatchinterface.h"
 namespace DynaPlex
 {
 	/**
@@ -122,6 +123,12 @@ namespace DynaPlex
 		 */
 		virtual bool StatesAreEqual(const DynaPlex::dp_State&,const DynaPlex::dp_State&) const = 0;
 
+		/**
+		 * Hash of the state, equal for states that are equal in the sense of StatesAreEqual. Uses State::Hash() const if the MDP
+		 * defines it, and a hash of State::ToVarGroup() otherwise. 
+		 */
+		virtual int64_t StateHash(const DynaPlex::dp_State&) const = 0;
+
 		/// Returns a non-empty vector containing actions allowed in the provided state, or throws if the state does not have a single allowed action.
 		virtual std::vector<int64_t> AllowedActions(const DynaPlex::dp_State&)const = 0;
 
@@ -193,6 +200,20 @@ namespace DynaPlex
 		 */
 		virtual bool IncorporateUntilAction(std::span<DynaPlex::Trajectory> trajectories, int64_t MaxPeriodCount = std::numeric_limits<int64_t>::max()) const = 0;
 
+		/**
+		 * Simulates the trajectories under the policy: alternates IncorporateUntilNonTrivialAction(trajectories, MaxPeriodCount) and
+		 * IncorporateAction(.., policy) until each trajectory is either IsFinal() or has PeriodCount>=MaxPeriodCount and IsAwaitEvent().
+		 * The order of the trajectories in the span may be changed.
+		 * If the policy was obtained from this MDP via GetPolicy, a fused loop is used in which policy and MDP calls are not virtual.
+		 */
+		virtual void Evolve(std::span<DynaPlex::Trajectory> trajectories, const DynaPlex::Policy& policy, int64_t MaxPeriodCount) const = 0;
+
+		/**
+		 * Returns a batch of size trajectories that are simulated with policy, with the typed states stored contiguously by value, 
+		 * if policy was obtained from this MDP via GetPolicy. Returns nullptr otherwise; see TrajectorySpanBatch for other policies. 
+		 */
+		virtual std::unique_ptr<DynaPlex::TrajectoryBatchInterface> CreateTrajectoryBatch(const DynaPlex::Policy& policy, size_t size) const = 0;
+
 
 		/**
 		 * Returns -1.0 or 1.0, depending on whether the mdp objective is minimization of maximization. 
@@ -213,6 +234,8 @@ namespace DynaPlex
 		/**
 		 * Sets the states in the trajectories to a specific state value. 
 		 * Updates the Category in the trajectory, and re-initiates PeriodCount, CumulativeReturn, and EffectiveDiscountFactor.
+		 * Note: if a trajectory already holds a state of this MDP, that state is overwritten in-place instead of being replaced 
+		 * by a fresh clone; see TrajectoryPool. 
 		 */
 		virtual void InitiateState(std::span<DynaPlex::Trajectory> trajectories,const DynaPlex::dp_State& state) const = 0;
 
@@ -251,6 +274,14 @@ namespace DynaPlex
 		virtual DynaPlex::VarGroup ListPolicies() const = 0;
 
 
+		/**
+		 * Returns an empty scenario for RNGProvider::AttachScenario, or nullptr if events of the MDP depend on the state, in 
+		 * which case events cannot be replayed. Attaching a scenario to trajectories with identical seeds lets them draw each event once. 
+		 */
+		virtual std::shared_ptr<DynaPlex::EventScenario> CreateEventScenario() const = 0;
+		/// Whether CreateEventScenario returns a scenario, i.e. whether events of the MDP can be replayed. 
+		virtual bool SupportsEventScenarios() const = 0;
+
 		virtual ~MDPInterface() = default;
 	};
 	using MDP = std::shared_ptr<MDPInterface>;
@@ -1,9 +1,11 @@
 #pragma once
-#include <future>
+#include <algorithm>
+#include <functional>
 #include <span>
-#include <thread>
+#include <tuple>
 #include <vector>
 #include "dynaplex/error.h"
+#include "dynaplex/threadpool.h"
 namespace DynaPlex {
     namespace Parallel {
 
@@ -14,51 +16,40 @@ namespace DynaPlex {
         std::vector<std::tuple<int64_t, int64_t>> get_chunks(size_t total, size_t max_chunk_size);
 
 
+        /**
+         * Calls work(span, start) on disjoint sub-spans that together cover output_data, where start is the index of the first
+         * element of span in output_data. The sub-spans are executed on the threads of pool with dynamic (work-stealing) 
+         * scheduling; output_data is cut into (at most) pool.NumThreads()*chunks_per_thread sub-spans. 
+         * If provided, reporter is called on the calling thread while the work executes, and receives a flag that is set when an error occurs. 
+         * Sub-spans that have not started when token is cancelled are skipped. 
+         * Rethrows the first exception thrown by work. 
+         */
         template <typename T>
         void parallel_compute(std::vector<T>& output_data,
             const std::function<void(std::span<T>, int64_t)>& work, 
-            int64_t num_threads_to_use,
-            const ProgressReporter& reporter = nullptr) {
-
-            if (num_threads_to_use > output_data.size())
-                num_threads_to_use = output_data.size();
-            
-            auto sub_spans_indices = get_splits(output_data.size(), num_threads_to_use);
-
-            std::atomic<bool> error_occurred = false;
-
-            std::vector<std::future<void>> futures;
-            std::vector<std::promise<void>> promises(num_threads_to_use);
-            std::vector<std::jthread> threads;
-
-            for (int64_t ThreadId = 0; ThreadId < num_threads_to_use; ThreadId++) {
-                auto [start, end] = sub_spans_indices[ThreadId];
-                futures.push_back(promises[ThreadId].get_future());
-
-                threads.emplace_back(
-                    [&output_data, &promises, &work, &error_occurred, ThreadId, start, end]() {
-                        try {
-                            auto span = std::span<T>( &output_data[start], end - start );
-                            work(span, start);
-                            promises[ThreadId].set_value();
-                        }
-                        catch (...) {              
-                            promises[ThreadId].set_exception(std::current_exception());
-                            error_occurred = true;
-                        }
-                    }
-                );
-            }
+            ThreadPool& pool,
+            const ProgressReporter& reporter = nullptr,
+            const CancellationToken& token = CancellationToken{},
+            int64_t chunks_per_thread = 4) {
+
+            if (output_data.empty())
+                return;
+            if (chunks_per_thread < 1)
+                throw DynaPlex::Error("parallel_compute: chunks_per_thread must be positive.");
+            int64_t total = static_cast<int64_t>(output_data.size());
+            int64_t num_chunks = std::min(total, pool.NumThreads() * chunks_per_thread);
+
+            auto job = pool.Submit(total, num_chunks,
+                [&output_data, &work](int64_t start, int64_t end) {
+                    auto span = std::span<T>(&output_data[start], end - start);
+                    work(span, start);
+                }, token);
             if (reporter)
             {
-                reporter(error_occurred);
-            }
-            // Wait for all futures to complete. If any thread threw an exception, it'll be rethrown here.
-            for (auto& future : futures) {
-                future.get();
+                reporter(ThreadPool::ErrorFlag(job));
             }
-            // Destroying the threads joins them.
-            threads.clear();
+            // Waits for completion. If any chunk threw an exception, it'll be rethrown here.
+            pool.Wait(job);
         }
 
 
@@ -1,4 +1,8 @@
 #pragma once
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <span>
 #include "dynaplex/error.h"
 #include "xoshiro/xoshiro256plusplus.hpp"
 
@@ -6,7 +10,99 @@ namespace DynaPlex {
 
 	class RNG {
 	public:
-		using type = XoshiroCpp::Xoshiro256PlusPlus;
+		/// Bit generator underlying the RNG.
+		enum class Generator {
+			/// xoshiro256++, seeded via splitmix64. The default, and the generator used for all reference results.
+			Xoshiro,
+			/// Philox4x32-10 counter-based generator, keyed by the seed. Seeding amounts to a few stores, and Discard is O(1).
+			Philox
+		};
+
+		/**
+		 * UniformRandomBitGenerator producing 64-bit values, using either of the generators listed in RNG::Generator.
+		 * Can be used with std:: distributions and algorithms, e.g. std::shuffle.
+		 */
+		class Engine {
+		public:
+			using result_type = uint64_t;
+
+			static constexpr result_type min() { return 0; }
+			static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+			result_type operator()()
+			{
+				if (generator == Generator::Xoshiro)
+					return NextXoshiro();
+				else
+					return NextPhilox();
+			}
+
+			/// Advances the engine as if operator() was called n times. O(1) for Philox, O(n) for Xoshiro.
+			void Discard(uint64_t n);
+
+		private:
+			friend class RNG;
+
+			/// For Xoshiro: the xoshiro256++ state. For Philox: key, index of next block, buffered output, buffer flag.
+			std::array<uint64_t, 4> s{};
+			Generator generator = Generator::Xoshiro;
+
+			static constexpr uint64_t RotL(uint64_t x, int k)
+			{
+				return (x << k) | (x >> (64 - k));
+			}
+
+			result_type NextXoshiro()
+			{
+				//identical to XoshiroCpp::Xoshiro256PlusPlus::operator()
+				const uint64_t result = RotL(s[0] + s[3], 23) + s[0];
+				const uint64_t t = s[1] << 17;
+				s[2] ^= s[0];
+				s[3] ^= s[1];
+				s[1] ^= s[2];
+				s[0] ^= s[3];
+				s[2] ^= t;
+				s[3] = RotL(s[3], 45);
+				return result;
+			}
+
+			//Philox4x32-10 block function, applied to counter (block,0) with key. Writes 128 bits to out0, out1.
+			static void PhiloxBlock(uint64_t key, uint64_t block, uint64_t& out0, uint64_t& out1)
+			{
+				uint32_t c0 = static_cast<uint32_t>(block), c1 = static_cast<uint32_t>(block >> 32), c2 = 0, c3 = 0;
+				uint32_t k0 = static_cast<uint32_t>(key), k1 = static_cast<uint32_t>(key >> 32);
+				for (int round = 0; round < 10; round++)
+				{
+					const uint64_t p0 = static_cast<uint64_t>(0xD2511F53u) * c0;
+					const uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57u) * c2;
+					const uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ k0;
+					const uint32_t n1 = static_cast<uint32_t>(p1);
+					const uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ k1;
+					const uint32_t n3 = static_cast<uint32_t>(p0);
+					c0 = n0; c1 = n1; c2 = n2; c3 = n3;
+					k0 += 0x9E3779B9u;
+					k1 += 0xBB67AE85u;
+				}
+				out0 = (static_cast<uint64_t>(c1) << 32) | c0;
+				out1 = (static_cast<uint64_t>(c3) << 32) | c2;
+			}
+
+			result_type NextPhilox()
+			{
+				if (s[3])
+				{
+					s[3] = 0;
+					return s[2];
+				}
+				uint64_t out0;
+				PhiloxBlock(s[0], s[1]++, out0, s[2]);
+				s[3] = 1;
+				return out0;
+			}
+		};
+
+		using type = Engine;
+
 		/**
 		 * Initiates the random number generator, based on provided parameters: Eval, global_seed, sample, trajectory, stream.
 		 *
@@ -16,12 +112,14 @@ namespace DynaPlex {
 		 *
 		 * Parameters:
 		 * - eval (bool): Indicates whether the rng will be used for training or evaluation purposes. Seeds used for training purposes are non-overlapping with
-		 * those used for evaluation purposes. 
+		 * those used for evaluation purposes.
 		 * - global_seed (int64_t): A global seed value used to introduce additional variability. Must be a non-negative value
-		 *   (most significant bit must be 0).	
+		 *   (most significant bit must be 0).
 		 * - sample (int64_t): A value representing the sample. Must be non-negative and less than 2^30.
 		 * - trajectory (int64_t): A value representing the trajectory. Must be non-negative and less than 2^23.
 		 * - stream (int64_t): A value representing the stream. Must be non-negative and less than 2^10.
+		 * - generator (Generator): The bit generator to use. For Xoshiro, the seed initializes the generator via splitmix64;
+		 *   for Philox, the seed is used as key and the counter starts at zero.
 			 *
 		 * Throws if any of these requirements are not met.
 		 *
@@ -32,9 +130,15 @@ namespace DynaPlex {
 		 * Return:
 		 * - DynaPlex::RNG based on the generated training seed.
 		 */
-	    RNG(bool eval, int64_t global_seed = 15112017, int64_t sample = (1LL << 30) - 1, int64_t trajectory = (1LL << 23) - 1, int64_t stream = (1LL << 10) - 1);
+	    RNG(bool eval, int64_t global_seed = 15112017, int64_t sample = (1LL << 30) - 1, int64_t trajectory = (1LL << 23) - 1, int64_t stream = (1LL << 10) - 1,
+			Generator generator = Generator::Xoshiro);
+
+		/// Unseeded placeholder; assign a seeded RNG before use.
+		RNG() = default;
+
+		/// Throws if the parameters are not valid for RNG(eval, global_seed, sample, trajectory, stream).
+		static void CheckSeedParameters(int64_t global_seed, int64_t sample, int64_t trajectory, int64_t stream = 0);
 
-		
 		type& gen() {
 			return generator_;
 		}
@@ -47,9 +151,42 @@ namespace DynaPlex {
 			return XoshiroCpp::DoubleFromBits(generator_());
 		}
 
+		/// Fills values with uniform doubles in [0,1); identical to calling genUniform() values.size() times.
+		void FillUniform(std::span<double> values);
+
 	private:
 		type generator_;
 		RNG(uint64_t seed);
 	};
 
+	/**
+	 * Generator with Lanes independent xoshiro256++ states in structure-of-arrays layout, such that the next output of all lanes
+	 * is computed simultaneously using SIMD instructions. On x86-64 with GCC or Clang, AVX-512 or AVX2 code is selected at runtime; 
+	 * otherwise a portable loop is used. All code paths produce identical values.
+	 * 
+	 * Intended for drawing many i.i.d. values in bulk, e.g. the demands of many periods. The values differ from those of the RNG
+	 * that the lanes are seeded from. 
+	 */
+	class MultiLaneRNG {
+	public:
+		static constexpr size_t Lanes = 8;
+
+		/// Seeds the lanes from a single draw of rng.
+		explicit MultiLaneRNG(RNG& rng);
+		/// Seeds the lanes from consecutive outputs of splitmix64(seed).
+		explicit MultiLaneRNG(uint64_t seed);
+
+		/**
+		 * Fills values with uniform doubles in [0,1), with resolution 2^-52. Value i is taken from lane i%Lanes; values that are
+		 * left over from a block are used first by the next call, so the sequence does not depend on how it is divided over calls.
+		 */
+		void FillUniform(std::span<double> values);
+
+	private:
+		alignas(64) std::array<std::array<uint64_t, Lanes>, 4> s;
+		alignas(64) std::array<double, Lanes> buffer;
+		//number of unused values at the end of buffer.
+		size_t buffered = 0;
+	};
+
 }  // namespace DynaPlex
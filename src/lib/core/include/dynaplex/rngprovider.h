@@ -1,62 +1,134 @@
 	#pragma once
+	#include <array>
+	#include <memory>
 	#include <vector>
 	#include "rng.h"
 	#include "error.h"
 
 	namespace DynaPlex {
+		/**
+		 * Events recorded for a single seed of the event streams, that can be replayed by all trajectories seeded alike. 
+		 * Created by MDP->CreateEventScenario; the content is specific to the MDP.
+		 */
+		class EventScenario {
+		public:
+			virtual ~EventScenario() = default;
+		};
+
 		class RNGProvider {
 		public:
 			///returns the RNG stream for use in policies. 
 			RNG& GetPolicyRNG()
 			{
-				if (rng_vec.empty())
-					throw DynaPlex::Error("RNGProvider: Attempt to get RNG from empty provider. Did you forget to Seed?");
-				return rng_vec.at(0);
+				return GetRNG(0);
 			}
 			///returns the RNG stream to be used for getting initial states. 
 			RNG& GetInitiationRNG()
 			{
-				if (rng_vec.empty())
-					throw DynaPlex::Error("RNGProvider: Attempt to get RNG from empty provider. Did you forget to Seed?");
-				return rng_vec.at(1);
+				return GetRNG(1);
 			}
 
 			///Returns the rng associated with the a specific event/rng stream 0,1,etc.
 			RNG& GetEventRNG(int64_t number)
 			{			
-				if (rng_vec.empty())
-					throw DynaPlex::Error("RNGProvider: Attempt to get RNG from empty provider. Did you forget to Seed?");
-			
 				if (number < 0 || number>1000)
 					//Requirement of below 1000 should not be an issue for most designs, and having so many event streams
 					//would be a strange design anyhow. The limit is not a hard limit, but going over the limit would require a redesign
 					//of the seeding strategy. 
 					throw DynaPlex::Error("RNGProvider: eventstream must be non-negative and below 1000");
+				return GetRNG(number + 2);
+			}
+
+			/**
+			 * As GetEventRNG, but without the range check on number, which must be non-negative (as is StateCategory::Index()).
+			 * Streams that are too large for the seeding strategy are still rejected when first created.
+			 */
+			RNG& GetEventRNGUnchecked(int64_t number)
+			{
+#ifdef DP_FULL_CHECKS
+				return GetEventRNG(number);
+#else
+				return GetRNG(number + 2);
+#endif
+			}
+
+			/**
+			 * Attaches a scenario, which must be created by the MDP of the trajectory, and should be attached only to providers that are seeded
+			 * identically. For MDPs with state-independent events, events are then replayed from the scenario, and events beyond
+			 * the recorded ones are appended to it. Replaying from the scenario gives the same events as drawing from the streams. 
+			 * SeedEventStreams detaches the scenario. 
+			 */
+			void AttachScenario(std::shared_ptr<EventScenario> event_scenario)
+			{
+				scenario = std::move(event_scenario);
+				scenario_positions.clear();
+			}
 
-				Expand(number + 3);
-				return rng_vec.at(number+2);
+			/// Scenario that is attached, or nullptr.
+			EventScenario* Scenario() const
+			{
+				return scenario.get();
 			}
 
-			RNGProvider() :rng_vec{}, global_seed{ 0 }, sample{ 0 }, trajectory{ 0 }, eval{ false }
+			/// Index in the scenario of the next event of stream number.
+			int64_t& ScenarioPosition(int64_t number)
+			{
+				if (static_cast<int64_t>(scenario_positions.size()) <= number)
+					scenario_positions.resize(number + 1, 0);
+				return scenario_positions[number];
+			}
+
+			RNGProvider() :inline_rngs{}, rng_vec{}, global_seed{ 0 }, sample{ 0 }, trajectory{ 0 }, eval{ false }, seeded{ false }, initialized{ 0 }, generator{ RNG::Generator::Xoshiro }
 			{}
 			
-			
-			void SeedEventStreams(bool evaluation, int64_t rng_seed=13021985, int64_t sample = (1ll << 30)-1, int64_t trajectory = (1ll << 22 ) -1 );
+			/**
+			 * (Re)seeds all streams. Streams are created lazily on first use, and the first few are stored inline,
+			 * so seeding does not allocate. With generator RNG::Generator::Philox, creating a stream also amounts to a 
+			 * few stores. RNG::Generator::Xoshiro is the default, and reproduces the streams of earlier versions. 
+			 */
+			void SeedEventStreams(bool evaluation, int64_t rng_seed=13021985, int64_t sample = (1ll << 30)-1, int64_t trajectory = (1ll << 22 ) -1,
+				RNG::Generator generator = RNG::Generator::Xoshiro);
 			
 
 		private:
+			//policy stream, initiation stream, and the first num_inline-2 event streams are stored inline. 
+			static constexpr int64_t num_inline = 5;
+
+			inline RNG& GetRNG(int64_t index)
+			{
+				if (!seeded)
+					throw DynaPlex::Error("RNGProvider: Attempt to get RNG from empty provider. Did you forget to Seed?");
+				if (index < num_inline)
+				{
+					if (!(initialized & (1u << index)))
+					{
+						inline_rngs[index] = DynaPlex::RNG(eval, global_seed, sample, trajectory, index, generator);
+						initialized |= (1u << index);
+					}
+					return inline_rngs[index];
+				}
+				Expand(index + 1 - num_inline);
+				return rng_vec[index - num_inline];
+			}
+
 			inline void Expand(int64_t size)
 			{
 				while (rng_vec.size() < size)
 				{
 					rng_vec.reserve(size);
-					rng_vec.push_back(DynaPlex::RNG(eval, global_seed, sample, trajectory, rng_vec.size()));
+					rng_vec.push_back(DynaPlex::RNG(eval, global_seed, sample, trajectory, num_inline + rng_vec.size(), generator));
 				}
 			}
+			std::array<DynaPlex::RNG, num_inline> inline_rngs;
+			//streams beyond the inline ones. 
 			std::vector<DynaPlex::RNG> rng_vec;
 
-			bool eval;
 			int64_t global_seed, sample, trajectory;
+			bool eval, seeded;
+			uint32_t initialized;
+			RNG::Generator generator;
+			std::shared_ptr<EventScenario> scenario;
+			std::vector<int64_t> scenario_positions;
 
 		};
 	}
@@ -4,16 +4,53 @@
 #include <iostream>  // For std::cout
 #include <string>
 #include <functional>
+#include <span>
+#include <vector>
 
 
 namespace DynaPlex {
+    namespace Parallel {
+        class ThreadPool;
+    }
+
+    /**
+     * Counter with initial value 0 that is shared by all processes, e.g. for handing out work on demand. See System::CreateSharedCounter.
+     */
+    class SharedCounter {
+    public:
+        using FetchAddFunction = std::function<std::int64_t(std::int64_t)>;
+
+        /// fetch_add implements FetchAdd; release (if provided) is called upon destruction. 
+        SharedCounter(FetchAddFunction fetch_add, std::function<void()> release = nullptr);
+        /// Collective if the counter is shared between multiple processes: must then be destroyed on all processes. 
+        ~SharedCounter();
+
+        SharedCounter(const SharedCounter&) = delete;
+        SharedCounter& operator=(const SharedCounter&) = delete;
+
+        /// Atomically adds increment to the counter, and returns the value of the counter before the addition. May be called from any
+        /// thread, but not concurrently within a process. 
+        std::int64_t FetchAdd(std::int64_t increment);
+    private:
+        FetchAddFunction fetch_add;
+        std::function<void()> release;
+    };
 
     class System {
         friend class DynaPlexProvider;
 
     public: 
+        /// Receives the buffer of the calling process, and returns the buffers of all processes (indexed by rank) on rank 0, and nothing on other ranks.
+        using GatherCallback = std::function<std::vector<std::vector<std::uint8_t>>(std::span<const std::uint8_t>)>;
+
+        /// Collective; creates a counter that is shared between all processes. 
+        using SharedCounterCallback = std::function<std::unique_ptr<SharedCounter>()>;
+
+        /// Collective; replaces every element of the buffer by its sum over all processes. 
+        using AllReduceCallback = std::function<void(std::span<float>)>;
+
         System();
-        System(bool TorchAvailable, std::uint32_t worldRank, std::uint32_t worldSize, std::function<void()> barrier_cb);
+        System(bool TorchAvailable, std::uint32_t worldRank, std::uint32_t worldSize, std::function<void()> barrier_cb, GatherCallback gather_cb = nullptr, SharedCounterCallback counter_cb = nullptr, AllReduceCallback allreduce_cb = nullptr);
         ~System();
 
         System(const System&);  // Copy constructor
@@ -23,6 +60,11 @@ namespace DynaPlex {
         bool HasIODirectory() const;
         /// hardwarethreads available for the process or algorithm that receives this system.
         std::uint32_t HardwareThreads() const;
+        /**
+         * Process-wide pool of HardwareThreads() worker threads, shared by all copies of this System. Created on first use.
+         * See DynaPlex::Parallel::parallel_compute. 
+         */
+        Parallel::ThreadPool& WorkerPool() const;
         std::uint32_t WorldRank() const;
         std::uint32_t WorldSize() const;
 
@@ -96,6 +138,34 @@ namespace DynaPlex {
         ///adds a MPI barrier, if applicable 
         void AddBarrier() const;
 
+        /// Returns whether GatherOnRoot is available: if WorldSize()==1, or if a message-passing implementation (MPI) is available.
+        bool SupportsGather() const;
+
+        /**
+         * Collective operation; must be called by all processes. On the process with WorldRank() 0, returns the buffers passed by all
+         * processes, indexed by rank. On other processes, returns an empty vector. Throws if !SupportsGather().
+         */
+        std::vector<std::vector<std::uint8_t>> GatherOnRoot(std::span<const std::uint8_t> buffer) const;
+
+        /// Returns whether CreateSharedCounter is available: if WorldSize()==1, or if a message-passing implementation (MPI) is available.
+        bool SupportsSharedCounter() const;
+
+        /**
+         * Collective operation; must be called by all processes. Returns a counter with initial value 0 that is shared between all processes.
+         * With multiple processes, MPI provides MPI_THREAD_SERIALIZED: FetchAdd may be called from any thread, but only one thread of a
+         * process may call FetchAdd (or any other MPI-backed member) at a time. Throws if !SupportsSharedCounter().
+         */
+        std::unique_ptr<SharedCounter> CreateSharedCounter() const;
+
+        /// Returns whether AllReduceSum is available: if WorldSize()==1, or if a message-passing implementation (MPI) is available.
+        bool SupportsAllReduce() const;
+
+        /**
+         * Collective operation; must be called by all processes with buffers of equal size. Replaces every element of buffer by the sum
+         * of that element over all processes, e.g. to combine gradients. Throws if !SupportsAllReduce().
+         */
+        void AllReduceSum(std::span<float> buffer) const;
+
         /// if this process has world_rank 0, displays message on console. Otherwise, does nothing. 
         friend const System& operator<<(const System& sys, const std::string& msg);
 
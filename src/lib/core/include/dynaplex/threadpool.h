@@ -0,0 +1,99 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
+namespace DynaPlex {
+    namespace Parallel {
+
+        /**
+         * Cooperative cancellation flag shared between the party that requests cancellation and the work that honors it.
+         * Copies refer to the same flag.
+         */
+        class CancellationToken {
+        public:
+            CancellationToken() : flag{ std::make_shared<std::atomic<bool>>(false) } {}
+
+            /// Requests cancellation. Chunks of work that have not yet started are skipped.
+            void Cancel() const { flag->store(true, std::memory_order_relaxed); }
+
+            bool IsCancelled() const { return flag->load(std::memory_order_relaxed); }
+
+        private:
+            std::shared_ptr<std::atomic<bool>> flag;
+        };
+
+        /**
+         * Persistent pool of worker threads with work-stealing scheduling.
+         *
+         * A job of n items is cut into chunks, which are initially distributed in contiguous ranges over the participants.
+         * A participant that runs out of chunks steals half of the remaining range of another participant, so that
+         * chunks that take very different amounts of time still keep all threads busy.
+         *
+         * Jobs may be submitted from within a job (nesting); a pool thread that waits on a nested job executes chunks of that
+         * job itself, so nested submission does not deadlock.
+         *
+         * Typically obtained through DynaPlex::System::WorkerPool(); see also parallel_compute.
+         */
+        class ThreadPool {
+        public:
+            /// Work on items [begin,end) of a job.
+            using Task = std::function<void(int64_t begin, int64_t end)>;
+
+            class Job;
+            using JobHandle = std::shared_ptr<Job>;
+
+            /// Creates a pool with num_threads worker threads (at least 1).
+            explicit ThreadPool(int64_t num_threads);
+            ~ThreadPool();
+
+            ThreadPool(const ThreadPool&) = delete;
+            ThreadPool& operator=(const ThreadPool&) = delete;
+
+            /// Number of worker threads in the pool.
+            int64_t NumThreads() const;
+
+            /**
+             * Schedules task over the items [0,total), cut into num_chunks chunks of (almost) equal size, and returns immediately.
+             * At most max_participants threads work on the job simultaneously (default: all).
+             * Chunks that have not yet started when token is cancelled, or when a chunk has thrown, are skipped.
+             */
+            JobHandle Submit(int64_t total, int64_t num_chunks, Task task,
+                const CancellationToken& token = CancellationToken{}, int64_t max_participants = std::numeric_limits<int64_t>::max());
+
+            /**
+             * Blocks until all chunks of the job are completed or skipped. If called from a pool worker thread (i.e. when nesting), 
+             * the calling thread executes chunks of the job while waiting. Rethrows the first exception thrown by a chunk of the job.
+             */
+            void Wait(const JobHandle& job);
+
+            /// Submit followed by Wait.
+            void ForEach(int64_t total, int64_t num_chunks, Task task,
+                const CancellationToken& token = CancellationToken{}, int64_t max_participants = std::numeric_limits<int64_t>::max());
+
+            /// Flag that is set as soon as a chunk of the job throws.
+            static const std::atomic<bool>& ErrorFlag(const JobHandle& job);
+
+            /// Returns whether the calling thread is a worker thread of some ThreadPool.
+            static bool IsWorkerThread();
+
+        private:
+            void WorkerLoop(std::stop_token stop);
+            JobHandle NextJob();
+            void Participate(const JobHandle& job);
+
+            std::mutex mutex;
+            std::condition_variable_any job_available;
+            //jobs that may have unclaimed chunks, in order of submission.
+            std::vector<JobHandle> jobs;
+            std::vector<std::jthread> threads;
+        };
+
+    } // namespace Parallel
+} // namespace DynaPlex
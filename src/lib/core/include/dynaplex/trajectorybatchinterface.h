@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+#include <span>
+#include "state.h"
+#include "statecategory.h"
+#include "rngprovider.h"
+
+namespace DynaPlex
+{
+	/**
+	 * A fixed number of trajectories that are simulated together with a single policy, obtained through MDP->CreateTrajectoryBatch.
+	 * Trajectory i is identified by its index throughout; the operations below have the semantics of the MDP functions of the same
+	 * name applied to a span of DynaPlex::Trajectory.
+	 *
+	 * For policies obtained from the MDP itself, the states are stored by value in a single contiguous buffer (see
+	 * DynaPlex::Erasure::TrajectoryBatch), and policy and MDP are called without virtual dispatch. Other policies act on
+	 * DynaPlex::Trajectory (see TrajectorySpanBatch).
+	 *
+	 * A batch refers to the MDP that created it, and should not outlive it.
+	 */
+	class TrajectoryBatchInterface
+	{
+	public:
+		virtual size_t Size() const = 0;
+
+		/// RNGProvider of trajectory i; seed it (and attach scenarios) before calling InitiateState.
+		virtual DynaPlex::RNGProvider& RNGProvider(size_t i) = 0;
+
+		/// Initiates every trajectory with an initial state of the MDP, drawn with its own RNGProvider.
+		virtual void InitiateState() = 0;
+		/// Initiates every trajectory with a copy of state.
+		virtual void InitiateState(const DynaPlex::dp_State& state) = 0;
+
+		/// Incorporates actions[i] into trajectory i; every trajectory must await an action.
+		virtual void IncorporateAction(std::span<const int64_t> actions) = 0;
+
+		/**
+		 * Alternates events and actions of the policy until every trajectory is final or has reached MaxPeriodCount. With
+		 * skip_trivial_actions, an action that is the only allowed action is taken without consulting the policy, as in MDP->Evolve.
+		 * Otherwise, the policy chooses every action, as when alternating MDP->IncorporateUntilAction and MDP->IncorporateAction.
+		 * Throws if a trajectory takes more than max_actions actions.
+		 */
+		virtual void Evolve(int64_t MaxPeriodCount, bool skip_trivial_actions = true, int64_t max_actions = std::numeric_limits<int64_t>::max()) = 0;
+
+		virtual double CumulativeReturn(size_t i) const = 0;
+		virtual int64_t PeriodCount(size_t i) const = 0;
+		virtual DynaPlex::StateCategory Category(size_t i) const = 0;
+
+		virtual ~TrajectoryBatchInterface() = default;
+	};
+}
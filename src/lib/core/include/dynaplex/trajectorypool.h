@@ -0,0 +1,37 @@
+#pragma once
+#include <vector>
+#include <span>
+#include "trajectory.h"
+
+namespace DynaPlex {
+	/**
+	 * Recycles Trajectory objects - including their (type-erased) states and the storage of their RNGProviders - across 
+	 * rollouts. 
+	 * 
+	 * MDP->InitiateState(trajectories, state) copy-assigns into the states already held by the trajectories if these 
+	 * stem from the same mdp, instead of cloning. Hence, once a pool is warm, repeatedly rolling out from a root state 
+	 * allocates neither StateAdapters nor, typically, the containers inside the states. 
+	 * 
+	 * Not thread-safe; a pool is owned by whoever drives the rollouts, and should not be shared between threads. 
+	 */
+	class TrajectoryPool {
+	public:
+		TrajectoryPool() = default;
+
+		/**
+		 * Returns a span of count trajectories. All members except the state and the RNGProvider are reset; ExternalIndex 
+		 * is set to 0,1,...,count-1. RNGProviders must be re-seeded, and states must be re-initiated through MDP->InitiateState. 
+		 * The span is invalidated by the next call to Get or Clear. 
+		 */
+		std::span<DynaPlex::Trajectory> Get(size_t count);
+
+		/// number of trajectories currently held.
+		size_t Capacity() const;
+
+		/// Releases all trajectories and states held by the pool.
+		void Clear();
+
+	private:
+		std::vector<DynaPlex::Trajectory> trajectories;
+	};
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <span>
+#include "mdp.h"
+#include "policy.h"
+#include "trajectory.h"
+#include "trajectorybatchinterface.h"
+
+namespace DynaPlex
+{
+	/**
+	 * TrajectoryBatchInterface on a span of DynaPlex::Trajectory, for policies that act on trajectories with type-erased
+	 * states. The trajectories are owned by the caller, e.g. by a TrajectoryPool, and are reordered by Evolve; ExternalIndex
+	 * identifies trajectory i throughout.
+	 */
+	class TrajectorySpanBatch final : public TrajectoryBatchInterface
+	{
+	public:
+		/// Sets ExternalIndex of trajectories[i] to i. 
+		TrajectorySpanBatch(const MDPInterface& mdp, DynaPlex::Policy policy, std::span<DynaPlex::Trajectory> trajectories);
+
+		size_t Size() const override { return trajectories.size(); }
+		DynaPlex::RNGProvider& RNGProvider(size_t i) override;
+		void InitiateState() override;
+		void InitiateState(const DynaPlex::dp_State& state) override;
+		void IncorporateAction(std::span<const int64_t> actions) override;
+		void Evolve(int64_t MaxPeriodCount, bool skip_trivial_actions, int64_t max_actions) override;
+		double CumulativeReturn(size_t i) const override;
+		int64_t PeriodCount(size_t i) const override;
+		DynaPlex::StateCategory Category(size_t i) const override;
+
+	private:
+		//restores the order by ExternalIndex after trajectories were reordered. 
+		void RestoreOrder();
+
+		const MDPInterface& mdp;
+		DynaPlex::Policy policy;
+		std::span<DynaPlex::Trajectory> trajectories;
+	};
+}
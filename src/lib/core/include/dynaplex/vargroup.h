@@ -3,6 +3,8 @@
 #include <string>
 #include <variant>
 #include <vector>
+#include <span>
+#include <cstdint>
 #include <unordered_map>
 #include <concepts>
 #if DP_PYBIND_SUPPORT 
@@ -316,6 +318,11 @@ namespace DynaPlex {
 
 		std::string Dump(const int indent = -1) const;
 
+		/// Compact binary (MessagePack) representation, e.g. for sending a VarGroup between processes. 
+		std::vector<uint8_t> ToMsgPack() const;
+		/// Inverse of ToMsgPack.
+		static VarGroup FromMsgPack(std::span<const uint8_t> bytes);
+
 
 		std::string UniqueIdentifier() const;
 
@@ -1,7 +1,11 @@
 #include "include/dynaplex/rng.h"
+#include <bit>
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#include <immintrin.h>
+#endif
 namespace DynaPlex {
 
-    inline uint64_t CombineSeeds(bool eval, int64_t global_seed, int64_t sample, int64_t trajectory, int64_t stream)
+    void RNG::CheckSeedParameters(int64_t global_seed, int64_t sample, int64_t trajectory, int64_t stream)
     {
         // Check ranges
         if (sample < 0 || sample >= (1LL << 30)) {
@@ -18,6 +22,11 @@ namespace DynaPlex {
         if (global_seed < 0) {
             throw DynaPlex::Error("get_training_seed::Global seed's first bit must be zero (i.e. global seed must be non-negative)");
         }
+    }
+
+    inline uint64_t CombineSeeds(bool eval, int64_t global_seed, int64_t sample, int64_t trajectory, int64_t stream)
+    {
+        RNG::CheckSeedParameters(global_seed, sample, trajectory, stream);
 
         // Combining the values
         uint64_t seed = (static_cast<uint64_t>(sample) << (23 + 10)) |
@@ -38,14 +47,192 @@ namespace DynaPlex {
         return seed;
     }
 
-    RNG::RNG(uint64_t seed): generator_(seed)
+    void RNG::Engine::Discard(uint64_t n)
+    {
+        if (generator == Generator::Xoshiro)
+        {
+            for (uint64_t i = 0; i < n; i++)
+                NextXoshiro();
+            return;
+        }
+        if (n > 0 && s[3])
+        {
+            s[3] = 0;
+            n--;
+        }
+        //each block provides two outputs
+        s[1] += n / 2;
+        if (n % 2)
+            NextPhilox();
+    }
+
+    RNG::RNG(uint64_t seed)
+    {
+        generator_.s = XoshiroCpp::Xoshiro256PlusPlus(seed).serialize();
+    }
+
+    RNG::RNG(bool eval, int64_t global_seed, int64_t sample, int64_t trajectory, int64_t stream, Generator generator)
+    {
+        uint64_t seed = CombineSeeds(eval, global_seed, sample, trajectory, stream);
+        generator_.generator = generator;
+        if (generator == Generator::Xoshiro)
+            generator_.s = XoshiroCpp::Xoshiro256PlusPlus(seed).serialize();
+        else
+            generator_.s = { seed, 0, 0, 0 };
+    }
+
+    void RNG::FillUniform(std::span<double> values)
     {
+        for (double& value : values)
+            value = genUniform();
+    }
+
+    namespace {
+        using LaneState = std::array<std::array<uint64_t, MultiLaneRNG::Lanes>, 4>;
+
+        //xoshiro256++ on all lanes; the loop over lanes is written such that the compiler vectorizes it. 
+        inline void FillLaneBlocksPortable(LaneState& s, double* out, size_t blocks)
+        {
+            constexpr size_t L = MultiLaneRNG::Lanes;
+            for (size_t b = 0; b < blocks; b++)
+            {
+                for (size_t j = 0; j < L; j++)
+                {
+                    const uint64_t sum = s[0][j] + s[3][j];
+                    const uint64_t result = ((sum << 23) | (sum >> 41)) + s[0][j];
+                    const uint64_t t = s[1][j] << 17;
+                    s[2][j] ^= s[0][j];
+                    s[3][j] ^= s[1][j];
+                    s[1][j] ^= s[2][j];
+                    s[0][j] ^= s[3][j];
+                    s[2][j] ^= t;
+                    s[3][j] = (s[3][j] << 45) | (s[3][j] >> 19);
+                    //top 52 bits as mantissa of a double in [1,2); avoids 64-bit int to double conversion, which AVX2 lacks.
+                    out[b * L + j] = std::bit_cast<double>((result >> 12) | 0x3FF0000000000000ull) - 1.0;
+                }
+            }
+        }
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#if defined(__GNUC__) && !defined(__clang__)
+        //GCC 12 reports the _mm512_undefined_* source of the unmasked AVX-512 intrinsics as (maybe) uninitialized; false positive.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+        //one 512-bit register holds a state word of all 8 lanes.
+        __attribute__((target("avx512f")))
+        void FillLaneBlocksAVX512(LaneState& s, double* out, size_t blocks)
+        {
+            static_assert(MultiLaneRNG::Lanes == 8);
+            __m512i s0 = _mm512_loadu_si512(s[0].data());
+            __m512i s1 = _mm512_loadu_si512(s[1].data());
+            __m512i s2 = _mm512_loadu_si512(s[2].data());
+            __m512i s3 = _mm512_loadu_si512(s[3].data());
+            const __m512i exponent = _mm512_set1_epi64(0x3FF0000000000000ll);
+            const __m512d one = _mm512_set1_pd(1.0);
+            for (size_t b = 0; b < blocks; b++)
+            {
+                const __m512i result = _mm512_add_epi64(_mm512_rol_epi64(_mm512_add_epi64(s0, s3), 23), s0);
+                const __m512i t = _mm512_slli_epi64(s1, 17);
+                s2 = _mm512_xor_si512(s2, s0);
+                s3 = _mm512_xor_si512(s3, s1);
+                s1 = _mm512_xor_si512(s1, s2);
+                s0 = _mm512_xor_si512(s0, s3);
+                s2 = _mm512_xor_si512(s2, t);
+                s3 = _mm512_rol_epi64(s3, 45);
+                const __m512i bits = _mm512_or_si512(_mm512_srli_epi64(result, 12), exponent);
+                _mm512_storeu_pd(out + b * 8, _mm512_sub_pd(_mm512_castsi512_pd(bits), one));
+            }
+            _mm512_storeu_si512(s[0].data(), s0);
+            _mm512_storeu_si512(s[1].data(), s1);
+            _mm512_storeu_si512(s[2].data(), s2);
+            _mm512_storeu_si512(s[3].data(), s3);
+        }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+        //AVX2 has no 64-bit rotate; the 8 lanes are held in two 256-bit registers per state word.
+        __attribute__((target("avx2")))
+        void FillLaneBlocksAVX2(LaneState& s, double* out, size_t blocks)
+        {
+            static_assert(MultiLaneRNG::Lanes == 8);
+            const __m256i exponent = _mm256_set1_epi64x(0x3FF0000000000000ll);
+            const __m256d one = _mm256_set1_pd(1.0);
+            for (size_t h = 0; h < 2; h++)
+            {
+                __m256i s0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s[0].data() + 4 * h));
+                __m256i s1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s[1].data() + 4 * h));
+                __m256i s2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s[2].data() + 4 * h));
+                __m256i s3 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s[3].data() + 4 * h));
+                for (size_t b = 0; b < blocks; b++)
+                {
+                    const __m256i sum = _mm256_add_epi64(s0, s3);
+                    const __m256i rotated = _mm256_or_si256(_mm256_slli_epi64(sum, 23), _mm256_srli_epi64(sum, 41));
+                    const __m256i result = _mm256_add_epi64(rotated, s0);
+                    const __m256i t = _mm256_slli_epi64(s1, 17);
+                    s2 = _mm256_xor_si256(s2, s0);
+                    s3 = _mm256_xor_si256(s3, s1);
+                    s1 = _mm256_xor_si256(s1, s2);
+                    s0 = _mm256_xor_si256(s0, s3);
+                    s2 = _mm256_xor_si256(s2, t);
+                    s3 = _mm256_or_si256(_mm256_slli_epi64(s3, 45), _mm256_srli_epi64(s3, 19));
+                    const __m256i bits = _mm256_or_si256(_mm256_srli_epi64(result, 12), exponent);
+                    _mm256_storeu_pd(out + b * 8 + 4 * h, _mm256_sub_pd(_mm256_castsi256_pd(bits), one));
+                }
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(s[0].data() + 4 * h), s0);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(s[1].data() + 4 * h), s1);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(s[2].data() + 4 * h), s2);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(s[3].data() + 4 * h), s3);
+            }
+        }
 
+        void FillLaneBlocks(LaneState& s, double* out, size_t blocks)
+        {
+            static const int level = __builtin_cpu_supports("avx512f") ? 2 : (__builtin_cpu_supports("avx2") ? 1 : 0);
+            if (level == 2)
+                FillLaneBlocksAVX512(s, out, blocks);
+            else if (level == 1)
+                FillLaneBlocksAVX2(s, out, blocks);
+            else
+                FillLaneBlocksPortable(s, out, blocks);
+        }
+#else
+        void FillLaneBlocks(LaneState& s, double* out, size_t blocks)
+        {
+            FillLaneBlocksPortable(s, out, blocks);
+        }
+#endif
+    }
+
+    MultiLaneRNG::MultiLaneRNG(uint64_t seed)
+    {
+        XoshiroCpp::SplitMix64 splitmix{ seed };
+        for (size_t j = 0; j < Lanes; j++)
+            for (size_t k = 0; k < 4; k++)
+                s[k][j] = splitmix();
     }
 
-    RNG::RNG(bool eval, int64_t global_seed, int64_t sample, int64_t trajectory, int64_t stream ):
-        generator_(CombineSeeds(eval, global_seed, sample, trajectory, stream))
+    MultiLaneRNG::MultiLaneRNG(RNG& rng) : MultiLaneRNG(static_cast<uint64_t>(rng.genInt()))
     {
     }
 
-}
\ No newline at end of file
+    void MultiLaneRNG::FillUniform(std::span<double> values)
+    {
+        size_t i = 0;
+        const size_t n = values.size();
+        while (buffered > 0 && i < n)
+            values[i++] = buffer[Lanes - buffered--];
+        const size_t blocks = (n - i) / Lanes;
+        FillLaneBlocks(s, values.data() + i, blocks);
+        i += blocks * Lanes;
+        if (i < n)
+        {
+            FillLaneBlocks(s, buffer.data(), 1);
+            buffered = Lanes;
+            while (i < n)
+                values[i++] = buffer[Lanes - buffered--];
+        }
+    }
+}
@@ -1,15 +1,19 @@
 #include "dynaplex/rngprovider.h"
 namespace DynaPlex {
-	void RNGProvider::SeedEventStreams(bool evaluation, int64_t global_seed, int64_t sample, int64_t trajectory)
+	void RNGProvider::SeedEventStreams(bool evaluation, int64_t global_seed, int64_t sample, int64_t trajectory, RNG::Generator generator)
 	{
+		RNG::CheckSeedParameters(global_seed, sample, trajectory);
 		this->global_seed = global_seed;
 		this->sample = sample;
 		this->trajectory = trajectory;
 		this->eval = evaluation;
+		this->generator = generator;
+		this->seeded = true;
 
+		//streams are created on first use.
+		initialized = 0;
 		rng_vec.clear();
-		//start with 3 event streams.
-		Expand(3);
-
+		scenario.reset();
+		scenario_positions.clear();
 	}
 }
@@ -3,19 +3,33 @@
 #include <functional>
 #include <thread>  // for std::thread::hardware_concurrency
 #include <iomanip> // for std::setw, std::setfill
+#include <mutex>
+#include <algorithm>
+#include <atomic>
 #include "dynaplex/system.h"
 #include "dynaplex/error.h"
+#include "dynaplex/threadpool.h"
 namespace fs = std::filesystem;
 
 namespace DynaPlex {
 
     class System::Impl {
     public:
-        Impl(bool torchavailable, int32_t world_rank, int32_t world_size, std::function<void()> barrier_cb) : start_time_(std::chrono::steady_clock::now()),
+        //shared between copies, such that all copies of a system use the same pool.
+        struct PoolHolder {
+            std::mutex mutex;
+            std::unique_ptr<Parallel::ThreadPool> pool;
+        };
+
+        Impl(bool torchavailable, int32_t world_rank, int32_t world_size, std::function<void()> barrier_cb, GatherCallback gather_cb, SharedCounterCallback counter_cb, AllReduceCallback allreduce_cb) : start_time_(std::chrono::steady_clock::now()),
             hardware_threads_(std::thread::hardware_concurrency()),
             world_rank_(world_rank),
             world_size_(world_size),
-            barrier_callback_(barrier_cb) {
+            barrier_callback_(barrier_cb),
+            gather_callback_(gather_cb),
+            counter_callback_(counter_cb),
+            allreduce_callback_(allreduce_cb),
+            pool_holder_(std::make_shared<PoolHolder>()) {
 
         }
         // Default copy constructor
@@ -63,6 +77,10 @@ namespace DynaPlex {
         bool torchavailable;
         fs::path io_location_;
         std::function<void()> barrier_callback_;
+        GatherCallback gather_callback_;
+        SharedCounterCallback counter_callback_;
+        AllReduceCallback allreduce_callback_;
+        std::shared_ptr<PoolHolder> pool_holder_;
     };
 
 
@@ -79,9 +97,60 @@ namespace DynaPlex {
             pimpl->barrier_callback_();
         }
     }
+    bool System::SupportsGather() const {
+        return WorldSize() == 1 || pimpl->gather_callback_;
+    }
+
+    std::vector<std::vector<std::uint8_t>> System::GatherOnRoot(std::span<const std::uint8_t> buffer) const {
+        if (pimpl->gather_callback_)
+            return pimpl->gather_callback_(buffer);
+        if (WorldSize() == 1)
+            return { std::vector<std::uint8_t>(buffer.begin(), buffer.end()) };
+        throw DynaPlex::Error("System::GatherOnRoot - no message-passing implementation available for WorldSize() > 1.");
+    }
+
+    bool System::SupportsSharedCounter() const {
+        return WorldSize() == 1 || pimpl->counter_callback_;
+    }
+
+    std::unique_ptr<SharedCounter> System::CreateSharedCounter() const {
+        if (pimpl->counter_callback_)
+            return pimpl->counter_callback_();
+        if (WorldSize() == 1)
+        {
+            auto value = std::make_shared<std::atomic<std::int64_t>>(0);
+            return std::make_unique<SharedCounter>([value](std::int64_t increment) { return value->fetch_add(increment); });
+        }
+        throw DynaPlex::Error("System::CreateSharedCounter - no message-passing implementation available for WorldSize() > 1.");
+    }
+
+    bool System::SupportsAllReduce() const {
+        return WorldSize() == 1 || pimpl->allreduce_callback_;
+    }
+
+    void System::AllReduceSum(std::span<float> buffer) const {
+        if (pimpl->allreduce_callback_)
+            pimpl->allreduce_callback_(buffer);
+        else if (WorldSize() != 1)
+            throw DynaPlex::Error("System::AllReduceSum - no message-passing implementation available for WorldSize() > 1.");
+    }
+
+    SharedCounter::SharedCounter(FetchAddFunction fetch_add, std::function<void()> release)
+        : fetch_add{ std::move(fetch_add) }, release{ std::move(release) } {
+    }
+
+    SharedCounter::~SharedCounter() {
+        if (release)
+            release();
+    }
+
+    std::int64_t SharedCounter::FetchAdd(std::int64_t increment) {
+        return fetch_add(increment);
+    }
+
     System::System() = default;
-    System::System(bool torchavailable, std::uint32_t worldRank, std::uint32_t worldSize, std::function<void()> barrier_cb)
-        : pimpl(std::make_unique<Impl>(torchavailable, worldRank, worldSize,barrier_cb)) {
+    System::System(bool torchavailable, std::uint32_t worldRank, std::uint32_t worldSize, std::function<void()> barrier_cb, GatherCallback gather_cb, SharedCounterCallback counter_cb, AllReduceCallback allreduce_cb)
+        : pimpl(std::make_unique<Impl>(torchavailable, worldRank, worldSize, barrier_cb, gather_cb, counter_cb, allreduce_cb)) {
     }
     System::~System() = default;
 
@@ -100,6 +169,14 @@ namespace DynaPlex {
         return pimpl->hardware_threads_;
     }
 
+    Parallel::ThreadPool& System::WorkerPool() const {
+        auto& holder = *pimpl->pool_holder_;
+        std::lock_guard lock(holder.mutex);
+        if (!holder.pool)
+            holder.pool = std::make_unique<Parallel::ThreadPool>(std::max<std::uint32_t>(pimpl->hardware_threads_, 1));
+        return *holder.pool;
+    }
+
     std::uint32_t System::WorldRank() const {
         return pimpl->world_rank_;
     }
@@ -0,0 +1,233 @@
+#include "dynaplex/threadpool.h"
+#include "dynaplex/error.h"
+#include <algorithm>
+#include <exception>
+#include <tuple>
+
+namespace DynaPlex {
+    namespace Parallel {
+
+        namespace {
+            thread_local bool is_worker_thread = false;
+        }
+
+        class ThreadPool::Job {
+        public:
+            //contiguous range of chunk indices owned by one participant; other participants may steal from the back.
+            struct Range {
+                std::mutex mutex;
+                int64_t begin{ 0 };
+                int64_t end{ 0 };
+            };
+
+            Job(int64_t total, int64_t num_chunks, Task task, const CancellationToken& token, int64_t num_slots)
+                : task{ std::move(task) }, token{ token }, num_slots{ num_slots }, ranges{ std::make_unique<Range[]>(num_slots) },
+                unclaimed{ num_chunks }, num_chunks{ num_chunks }
+            {
+                chunk_begin.reserve(num_chunks + 1);
+                chunk_begin.push_back(0);
+                for (int64_t c = 1; c <= num_chunks; c++)
+                    chunk_begin.push_back((total * c) / num_chunks);
+                for (int64_t slot = 0; slot < num_slots; slot++)
+                {
+                    ranges[slot].begin = (num_chunks * slot) / num_slots;
+                    ranges[slot].end = (num_chunks * (slot + 1)) / num_slots;
+                }
+            }
+
+            //claims the next chunk for the participant owning slot; steals if the own range is exhausted.
+            bool TryTake(int64_t slot, int64_t& chunk)
+            {
+                {
+                    std::lock_guard lock(ranges[slot].mutex);
+                    auto& own = ranges[slot];
+                    if (own.begin < own.end)
+                    {
+                        chunk = own.begin++;
+                        unclaimed--;
+                        return true;
+                    }
+                }
+                for (int64_t k = 1; k < num_slots; k++)
+                {
+                    auto& victim = ranges[(slot + k) % num_slots];
+                    int64_t stolen_begin, stolen_end;
+                    {
+                        std::lock_guard lock(victim.mutex);
+                        if (victim.begin >= victim.end)
+                            continue;
+                        stolen_begin = victim.begin + (victim.end - victim.begin) / 2;
+                        stolen_end = victim.end;
+                        victim.end = stolen_begin;
+                    }
+                    chunk = stolen_begin;
+                    unclaimed--;
+                    {//only the owner stores into its own (exhausted) range, so nothing is overwritten here. 
+                        std::lock_guard lock(ranges[slot].mutex);
+                        ranges[slot].begin = stolen_begin + 1;
+                        ranges[slot].end = stolen_end;
+                    }
+                    return true;
+                }
+                return false;
+            }
+
+            void Execute(int64_t chunk)
+            {
+                if (!token.IsCancelled() && !error_occurred.load(std::memory_order_relaxed))
+                {
+                    try {
+                        task(chunk_begin[chunk], chunk_begin[chunk + 1]);
+                    }
+                    catch (...) {
+                        std::lock_guard lock(done_mutex);
+                        if (!exception)
+                            exception = std::current_exception();
+                        error_occurred = true;
+                    }
+                }
+                if (completed.fetch_add(1) + 1 == num_chunks)
+                {
+                    std::lock_guard lock(done_mutex);
+                    done.notify_all();
+                }
+            }
+
+            bool IsCompleted() const
+            {
+                return completed.load() == num_chunks;
+            }
+
+            Task task;
+            CancellationToken token;
+            const int64_t num_slots;
+            std::unique_ptr<Range[]> ranges;
+            std::vector<int64_t> chunk_begin;
+            std::atomic<int64_t> next_slot{ 0 };
+            std::atomic<int64_t> unclaimed;
+            std::atomic<int64_t> completed{ 0 };
+            const int64_t num_chunks;
+            std::atomic<bool> error_occurred{ false };
+            std::mutex done_mutex;
+            std::condition_variable done;
+            std::exception_ptr exception;
+        };
+
+        ThreadPool::ThreadPool(int64_t num_threads)
+        {
+            num_threads = std::max<int64_t>(num_threads, 1);
+            threads.reserve(num_threads);
+            for (int64_t i = 0; i < num_threads; i++)
+                threads.emplace_back([this](std::stop_token stop) { WorkerLoop(stop); });
+        }
+
+        ThreadPool::~ThreadPool()
+        {
+            for (auto& thread : threads)
+                thread.request_stop();
+            job_available.notify_all();
+            //joins the threads
+            threads.clear();
+        }
+
+        int64_t ThreadPool::NumThreads() const
+        {
+            return static_cast<int64_t>(threads.size());
+        }
+
+        bool ThreadPool::IsWorkerThread()
+        {
+            return is_worker_thread;
+        }
+
+        const std::atomic<bool>& ThreadPool::ErrorFlag(const JobHandle& job)
+        {
+            return job->error_occurred;
+        }
+
+        ThreadPool::JobHandle ThreadPool::NextJob()
+        {//assumes mutex is held. Prefers the most recently submitted job, such that nested jobs complete first. 
+            for (auto it = jobs.rbegin(); it != jobs.rend(); )
+            {
+                auto& job = *it;
+                if (job->unclaimed.load() <= 0)
+                {
+                    it = decltype(it)(jobs.erase(std::next(it).base()));
+                    continue;
+                }
+                if (job->next_slot.load() < job->num_slots)
+                    return job;
+                ++it;
+            }
+            return nullptr;
+        }
+
+        void ThreadPool::WorkerLoop(std::stop_token stop)
+        {
+            is_worker_thread = true;
+            while (!stop.stop_requested())
+            {
+                JobHandle job;
+                {
+                    std::unique_lock lock(mutex);
+                    job_available.wait(lock, stop, [this, &job]() { job = NextJob(); return job != nullptr; });
+                }
+                if (job)
+                    Participate(job);
+            }
+        }
+
+        void ThreadPool::Participate(const JobHandle& job)
+        {
+            int64_t slot = job->next_slot.fetch_add(1);
+            if (slot >= job->num_slots)
+                return;
+            int64_t chunk;
+            while (job->TryTake(slot, chunk))
+                job->Execute(chunk);
+        }
+
+        ThreadPool::JobHandle ThreadPool::Submit(int64_t total, int64_t num_chunks, Task task, const CancellationToken& token, int64_t max_participants)
+        {
+            if (total < 0)
+                throw DynaPlex::Error("ThreadPool::Submit - total must be non-negative.");
+            if (max_participants < 1)
+                throw DynaPlex::Error("ThreadPool::Submit - max_participants must be positive.");
+            num_chunks = std::clamp<int64_t>(num_chunks, std::min<int64_t>(total, 1), total);
+            //one additional slot for a pool thread that waits on this job. 
+            int64_t num_slots = std::max<int64_t>(1, std::min({ max_participants, NumThreads() + 1, num_chunks }));
+            auto job = std::make_shared<Job>(total, num_chunks, std::move(task), token, num_slots);
+            if (num_chunks > 0)
+            {
+                {
+                    std::lock_guard lock(mutex);
+                    jobs.push_back(job);
+                }
+                job_available.notify_all();
+            }
+            return job;
+        }
+
+        void ThreadPool::Wait(const JobHandle& job)
+        {
+            if (IsWorkerThread())
+                Participate(job);
+            {
+                std::unique_lock lock(job->done_mutex);
+                job->done.wait(lock, [&job]() { return job->IsCompleted(); });
+            }
+            {
+                std::lock_guard lock(mutex);
+                std::erase(jobs, job);
+            }
+            if (job->exception)
+                std::rethrow_exception(job->exception);
+        }
+
+        void ThreadPool::ForEach(int64_t total, int64_t num_chunks, Task task, const CancellationToken& token, int64_t max_participants)
+        {
+            Wait(Submit(total, num_chunks, std::move(task), token, max_participants));
+        }
+
+    } // namespace Parallel
+} // namespace DynaPlex
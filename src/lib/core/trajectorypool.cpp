@@ -0,0 +1,33 @@
+#include "dynaplex/trajectorypool.h"
+namespace DynaPlex {
+
+	std::span<DynaPlex::Trajectory> TrajectoryPool::Get(size_t count)
+	{
+		if (trajectories.size() < count)
+		{
+			trajectories.reserve(count);
+			while (trajectories.size() < count)
+				trajectories.emplace_back();
+		}
+		for (size_t i = 0; i < count; i++)
+		{
+			auto& traj = trajectories[i];
+			traj.NextAction = 0;
+			traj.Category = DynaPlex::StateCategory{};
+			traj.ExternalIndex = static_cast<int64_t>(i);
+			traj.Reset();
+		}
+		return { trajectories.data(), count };
+	}
+
+	size_t TrajectoryPool::Capacity() const
+	{
+		return trajectories.size();
+	}
+
+	void TrajectoryPool::Clear()
+	{
+		trajectories.clear();
+		trajectories.shrink_to_fit();
+	}
+}
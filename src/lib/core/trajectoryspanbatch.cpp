@@ -0,0 +1,85 @@
+#include "dynaplex/trajectoryspanbatch.h"
+#include "dynaplex/error.h"
+#include <algorithm>
+#include <string>
+
+namespace DynaPlex {
+
+	TrajectorySpanBatch::TrajectorySpanBatch(const MDPInterface& mdp, DynaPlex::Policy policy, std::span<DynaPlex::Trajectory> trajectories)
+		: mdp{ mdp }, policy{ policy }, trajectories{ trajectories }
+	{
+		if (!this->policy)
+			throw DynaPlex::Error("TrajectorySpanBatch: policy should not be null.");
+		for (size_t i = 0; i < trajectories.size(); i++)
+			trajectories[i].ExternalIndex = static_cast<int64_t>(i);
+	}
+
+	DynaPlex::RNGProvider& TrajectorySpanBatch::RNGProvider(size_t i)
+	{
+		return trajectories[i].RNGProvider;
+	}
+
+	void TrajectorySpanBatch::InitiateState()
+	{
+		mdp.InitiateState(trajectories);
+	}
+
+	void TrajectorySpanBatch::InitiateState(const DynaPlex::dp_State& state)
+	{
+		mdp.InitiateState(trajectories, state);
+	}
+
+	void TrajectorySpanBatch::IncorporateAction(std::span<const int64_t> actions)
+	{
+		if (actions.size() != trajectories.size())
+			throw DynaPlex::Error("TrajectorySpanBatch::IncorporateAction - number of actions does not match number of trajectories.");
+		for (size_t i = 0; i < trajectories.size(); i++)
+			trajectories[i].NextAction = actions[i];
+		mdp.IncorporateAction(trajectories);
+	}
+
+	void TrajectorySpanBatch::Evolve(int64_t MaxPeriodCount, bool skip_trivial_actions, int64_t max_actions)
+	{
+		std::span<DynaPlex::Trajectory> active = trajectories;
+		int64_t actions = 0;
+		while (true)
+		{
+			bool all_await_action = skip_trivial_actions ? mdp.IncorporateUntilNonTrivialAction(active, MaxPeriodCount)
+				: mdp.IncorporateUntilAction(active, MaxPeriodCount);
+			if (!all_await_action)
+			{
+				//continue with the trajectories that await an action; mdp->IncorporateAction only accepts those. 
+				auto partition_point = std::partition(active.begin(), active.end(),
+					[](const DynaPlex::Trajectory& traj) { return traj.Category.IsAwaitAction(); });
+				active = std::span<DynaPlex::Trajectory>(active.begin(), partition_point);
+			}
+			if (active.empty())
+				break;
+			if (actions++ == max_actions)
+				throw DynaPlex::Error("TrajectorySpanBatch::Evolve - expected completion of simulation run after max_actions: " + std::to_string(max_actions) + " but completion was not reached.");
+			mdp.IncorporateAction(active, policy);
+		}
+		RestoreOrder();
+	}
+
+	void TrajectorySpanBatch::RestoreOrder()
+	{
+		std::sort(trajectories.begin(), trajectories.end(),
+			[](const DynaPlex::Trajectory& a, const DynaPlex::Trajectory& b) { return a.ExternalIndex < b.ExternalIndex; });
+	}
+
+	double TrajectorySpanBatch::CumulativeReturn(size_t i) const
+	{
+		return trajectories[i].CumulativeReturn;
+	}
+
+	int64_t TrajectorySpanBatch::PeriodCount(size_t i) const
+	{
+		return trajectories[i].PeriodCount;
+	}
+
+	DynaPlex::StateCategory TrajectorySpanBatch::Category(size_t i) const
+	{
+		return trajectories[i].Category;
+	}
+}
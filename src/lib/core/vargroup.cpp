@@ -515,6 +515,24 @@ namespace DynaPlex {
 		}
 	}
 
+	std::vector<uint8_t> VarGroup::ToMsgPack() const {
+		return ordered_json::to_msgpack(pImpl->data);
+	}
+
+	VarGroup VarGroup::FromMsgPack(std::span<const uint8_t> bytes) {
+		ordered_json j;
+		try {
+			j = ordered_json::from_msgpack(bytes.begin(), bytes.end());
+			DynaPlex::VarGroupHelpers::check_validity(j);
+		}
+		catch (const nlohmann::json::exception& e) {
+			throw DynaPlex::Error(std::string("Failed to parse MessagePack data: ") + e.what());
+		}
+		VarGroup vars;
+		vars.pImpl->data = std::move(j);
+		return vars;
+	}
+
 	std::string VarGroup::Hash() const
 	{
 		return DynaPlex::VarGroupHelpers::hash_json_string(pImpl->data);
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <algorithm>
 #ifdef DP_MPI_AVAILABLE
 #include <mpi.h>
 #endif
@@ -23,8 +24,8 @@ namespace DynaPlex {
     }
 
 
-    DynaPlex::Policy DynaPlexProvider::LoadPolicy(DynaPlex::MDP mdp, std::string file_path_without_extension) {
-        return TrainedPolicyProvider::LoadPolicy(mdp, file_path_without_extension);
+    DynaPlex::Policy DynaPlexProvider::LoadPolicy(DynaPlex::MDP mdp, std::string file_path_without_extension, const VarGroup& inference_config) {
+        return TrainedPolicyProvider::LoadPolicy(mdp, file_path_without_extension, inference_config);
     }
 
     DynaPlex::Algorithms::DCL DynaPlexProvider::GetDCL(DynaPlex::MDP mdp, DynaPlex::Policy policy, const VarGroup& config)
@@ -44,14 +45,101 @@ namespace DynaPlex {
 #endif
     }
 
+#ifdef DP_MPI_AVAILABLE
+    namespace {
+        //buffers are sent in pieces, since MPI counts are int. 
+        constexpr int64_t max_message_size = 1 << 30;
+
+        std::vector<std::vector<uint8_t>> MPIGatherOnRoot(std::span<const uint8_t> buffer)
+        {
+            int world_rank, world_size;
+            MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+            MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+
+            int64_t size = static_cast<int64_t>(buffer.size());
+            std::vector<int64_t> sizes(world_rank == 0 ? world_size : 0);
+            MPI_Gather(&size, 1, MPI_INT64_T, sizes.data(), 1, MPI_INT64_T, 0, MPI_COMM_WORLD);
+
+            std::vector<std::vector<uint8_t>> result;
+            if (world_rank == 0)
+            {
+                result.resize(world_size);
+                result[0].assign(buffer.begin(), buffer.end());
+                for (int rank = 1; rank < world_size; rank++)
+                {
+                    result[rank].resize(sizes[rank]);
+                    for (int64_t offset = 0; offset < sizes[rank]; offset += max_message_size)
+                    {
+                        int count = static_cast<int>(std::min(max_message_size, sizes[rank] - offset));
+                        MPI_Recv(result[rank].data() + offset, count, MPI_BYTE, rank, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+                    }
+                }
+            }
+            else
+            {
+                for (int64_t offset = 0; offset < size; offset += max_message_size)
+                {
+                    int count = static_cast<int>(std::min(max_message_size, size - offset));
+                    MPI_Send(buffer.data() + offset, count, MPI_BYTE, 0, 0, MPI_COMM_WORLD);
+                }
+            }
+            return result;
+        }
+
+        //the counter lives in a window on rank 0, and is incremented by other ranks without involvement of rank 0. 
+        std::unique_ptr<DynaPlex::SharedCounter> MPICreateSharedCounter()
+        {
+            int world_rank;
+            MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+            int64_t* base = nullptr;
+            MPI_Win window;
+            MPI_Aint size = world_rank == 0 ? sizeof(int64_t) : 0;
+            MPI_Win_allocate(size, sizeof(int64_t), MPI_INFO_NULL, MPI_COMM_WORLD, &base, &window);
+            if (world_rank == 0)
+            {
+                MPI_Win_lock(MPI_LOCK_EXCLUSIVE, 0, 0, window);
+                *base = 0;
+                MPI_Win_unlock(0, window);
+            }
+            //ensure the counter is initialized before it is used. 
+            MPI_Barrier(MPI_COMM_WORLD);
+
+            auto shared_window = std::make_shared<MPI_Win>(window);
+            return std::make_unique<DynaPlex::SharedCounter>(
+                [shared_window](int64_t increment) {
+                    int64_t previous;
+                    MPI_Win_lock(MPI_LOCK_SHARED, 0, 0, *shared_window);
+                    MPI_Fetch_and_op(&increment, &previous, MPI_INT64_T, 0, 0, MPI_SUM, *shared_window);
+                    MPI_Win_unlock(0, *shared_window);
+                    return previous;
+                },
+                [shared_window]() { MPI_Win_free(shared_window.get()); });
+        }
+
+        void MPIAllReduceSum(std::span<float> buffer)
+        {
+            int64_t size = static_cast<int64_t>(buffer.size());
+            for (int64_t offset = 0; offset < size; offset += max_message_size)
+            {
+                int count = static_cast<int>(std::min(max_message_size, size - offset));
+                MPI_Allreduce(MPI_IN_PLACE, buffer.data() + offset, count, MPI_FLOAT, MPI_SUM, MPI_COMM_WORLD);
+            }
+        }
+    }
+#endif
+
     DynaPlexProvider::DynaPlexProvider() {
         // If MPI is available, initialize it and fetch world details
 #ifdef DP_MPI_AVAILABLE
         int mpi_initialized;
         MPI_Initialized(&mpi_initialized);
         if (!mpi_initialized) {
-            MPI_Init(nullptr, nullptr);
+            //the shared counter is used from a thread that claims work while the main thread waits. 
+            int provided;
+            MPI_Init_thread(nullptr, nullptr, MPI_THREAD_SERIALIZED, &provided);
         }
+        int thread_support;
+        MPI_Query_thread(&thread_support);
 
         int world_rank;
         int world_size;
@@ -63,8 +151,18 @@ namespace DynaPlex {
 #endif
         bool torchavailable = DynaPlex::TorchAvailability::TorchAvailable();
       
+        DynaPlex::System::GatherCallback gather_callback = nullptr;
+        DynaPlex::System::SharedCounterCallback counter_callback = nullptr;
+        DynaPlex::System::AllReduceCallback allreduce_callback = nullptr;
+#ifdef DP_MPI_AVAILABLE
+        gather_callback = MPIGatherOnRoot;
+        if (thread_support >= MPI_THREAD_SERIALIZED)
+            counter_callback = MPICreateSharedCounter;
+        allreduce_callback = MPIAllReduceSum;
+#endif
         m_systemInfo = DynaPlex::System(torchavailable,world_rank, world_size,
-           /*callback function: */ []() {DynaPlexProvider::Get().AddBarrier(); }
+           /*callback function: */ []() {DynaPlexProvider::Get().AddBarrier(); },
+            gather_callback, counter_callback, allreduce_callback
             );
         std::string defined_root_dir = "";
 #ifdef DYNAPLEX_IO_ROOT_DIR
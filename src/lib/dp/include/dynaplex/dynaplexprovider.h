@@ -33,7 +33,8 @@ namespace DynaPlex {
 
         void SavePolicy(DynaPlex::Policy policy, std::string file_path_without_extension);
 
-        DynaPlex::Policy LoadPolicy(DynaPlex::MDP mdp, std::string file_path_without_extension);
+        /// see TrainedPolicyProvider::LoadPolicy for inference_config. 
+        DynaPlex::Policy LoadPolicy(DynaPlex::MDP mdp, std::string file_path_without_extension, const VarGroup& inference_config = VarGroup{});
         
         DynaPlex::Algorithms::DCL GetDCL(DynaPlex::MDP mdp, DynaPlex::Policy policy = nullptr, const VarGroup& config = VarGroup{});
 
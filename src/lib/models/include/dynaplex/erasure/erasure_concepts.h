@@ -42,6 +42,11 @@ namespace DynaPlex::Erasure
 		{ mdp.GetEvent(rng) } -> std::same_as<t_Event>;
 	};
 
+	template <typename t_State>
+	concept HasHash = requires(const t_State & state) {
+		{ state.Hash() } -> std::convertible_to<int64_t>;
+	};
+
 	template <typename t_MDP, typename t_State, typename t_RNG>
 	concept HasResetHiddenStateVariables = requires(const t_MDP & mdp, t_State & state, t_RNG & rng) {
 		mdp.ResetHiddenStateVariables(state, rng);
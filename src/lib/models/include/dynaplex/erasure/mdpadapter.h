@@ -1,5 +1,7 @@
 #pragma once
 #include <vector>
+#include <algorithm>
+#include <type_traits>
 #include "dynaplex/vargroup.h"
 #include "dynaplex/error.h"
 #include "dynaplex/rng.h"
@@ -11,6 +13,8 @@
 #include "randompolicy.h"
 #include "policyregistry.h"
 #include "stateadapter.h"
+#include "trajectorybatch.h"
+#include "trajectorybatchadapter.h"
 #include <cassert>
 
 namespace DynaPlex::Erasure
@@ -38,9 +42,31 @@ namespace DynaPlex::Erasure
 		int64_t num_flat_features;
 
 
+		//events drawn for a single seed, per event stream. 
+		class RecordedEvents final : public DynaPlex::EventScenario {
+		public:
+			struct Stream {
+				//copy of the unused stream of the first trajectory that reaches beyond the recorded events. 
+				DynaPlex::RNG rng;
+				bool started = false;
+				std::vector<t_Event> events;
+			};
+			std::vector<Stream> streams;
+		};
+
 		int64_t NumValidActions() const override {
 			return provider.NumValidActions();
 		}
+
+		std::shared_ptr<DynaPlex::EventScenario> CreateEventScenario() const override {
+			if constexpr (HasGetEvent<t_MDP, t_Event, DynaPlex::RNG>)
+				return std::make_shared<RecordedEvents>();
+			else
+				return nullptr;
+		}
+		bool SupportsEventScenarios() const override {
+			return HasGetEvent<t_MDP, t_Event, DynaPlex::RNG>;
+		}
 		bool ProvidesFlatFeatures() const override {
 			return HasGetFlatFeatures<t_MDP, t_State>;
 		}
@@ -280,11 +306,12 @@ namespace DynaPlex::Erasure
 			if ( trajectories.size() * num_valid_actions != values_per_valid_action.size())
 				throw DynaPlex::Error("MDP->SetArgMaxAction - nonconformant dimensions of values_per_valid_action and trajectories.  ");
 
+			CheckTrajectories(trajectories, false, "MDP->SetArgMaxAction");
 			size_t offset = 0;
 			for (auto& traj : trajectories)
 			{
 				auto values_for_traj = values_per_valid_action.subspan(offset, num_valid_actions);
-				auto& t_state = ToState(traj.GetState());
+				auto& t_state = UncheckedToState(traj.GetState());
 				float best_val = -std::numeric_limits<float>::infinity();
 				for (const auto& action : provider(t_state))
 				{
@@ -303,12 +330,11 @@ namespace DynaPlex::Erasure
 			auto num_valid_actions = provider.NumValidActions();
 			if (num_valid_actions * trajectories.size() != mask.size())
 				throw DynaPlex::Error("MDP->GetMask: size of mask argument does not equal NumAllowedActions* trajectories.size()");
+			CheckTrajectories(trajectories, true, "MDP->GetMask");
 			size_t offset = 0;
 			for (const auto& trajectory : trajectories)
 			{
-				if (!trajectory.Category.IsAwaitAction())
-					throw DynaPlex::Error("MDP->GetMask: trajectory in trajectories does not satisfy Category.IsAwaitAction().");
-				auto& t_state = ToState(trajectory.GetState());
+				auto& t_state = UncheckedToState(trajectory.GetState());
 				for (auto action : provider(t_state))
 				{
 					mask[offset + action] = true;
@@ -324,18 +350,12 @@ namespace DynaPlex::Erasure
 				if (num_flat_features * trajectories.size() != feats.size())
 					throw DynaPlex::Error("MDP->GetFlatFeatures(trajectories,feats): size of feats argument does not equal NumFlatFeatures*trajectories.size()");
 
+				CheckTrajectories(trajectories, true, "MDP->GetFlatFeatures(trajectories,feats)");
 				size_t offset = 0;
 				for (const auto& trajectory : trajectories)
 				{
-					if (!trajectory.Category.IsAwaitAction())
-						throw DynaPlex::Error("MDP->GetFlatFeatures(trajectories,feats): trajectory in trajectories does not satisfy Category.IsAwaitAction().");
-
-					auto sub_feats = feats.subspan(offset, num_flat_features);
-					DynaPlex::Features traj_feats(sub_feats);
-					auto& t_state = ToState(trajectory.GetState());
-					mdp->GetFeatures(t_state, traj_feats);
-					if (!traj_feats.IsFilled())
-						throw DynaPlex::Error("MDP->GetFlatFeatures(trajectories,feats): mdp->GetFeatures(const State&, DynaPlex::Features&) const for mdp type " + mdp_type_id + " returns number of features that is inconsistent with num_flat_features. Possible causes: \n1) GetFeatures returns different numbers of features for different states; ensure consistency. \n2) num_flat_features as returned by GetStaticInfo is inconsistent with the number of features actually returned by GetFeatures(const State&, DynaPlex::Features&) const.");
+					auto& t_state = UncheckedToState(trajectory.GetState());
+					GetFeaturesOfState(t_state, feats.subspan(offset, num_flat_features), "MDP->GetFlatFeatures(trajectories,feats)");
 
 					offset += num_flat_features;
 				}
@@ -368,6 +388,14 @@ namespace DynaPlex::Erasure
 
 		}
 
+		int64_t StateHash(const DynaPlex::dp_State& state) const override
+		{
+			if constexpr (HasHash<t_State>)
+				return static_cast<int64_t>(ToState(state).Hash());
+			else
+				return ToState(state).ToVarGroup().Int64Hash();
+		}
+
 		bool CheckConformant(const DynaPlex::dp_State& state) const override
 		{
 			return state->mdp_int_hash == mdp_int_hash;
@@ -436,19 +464,11 @@ namespace DynaPlex::Erasure
 		{
 			if constexpr (HasModifyStateWithAction<t_MDP>)
 			{
+				CheckTrajectories(trajectories, true, "MDP->IncorporateActions");
 				for (DynaPlex::Trajectory& traj : trajectories)
 				{
-					auto& state = ToState(traj.GetState());
-
-					if (traj.Category.IsAwaitAction())
-					{
-						traj.CumulativeReturn += mdp->ModifyStateWithAction(state, traj.NextAction) * traj.EffectiveDiscountFactor;
-						traj.Category = mdp->GetStateCategory(state);
-					}
-					else
-					{
-						throw DynaPlex::Error("MDP->IncorporateActions: Cannot incorporate action if Trajectory.Category is not AwaitAction");
-					}
+					auto& state = UncheckedToState(traj.GetState());
+					IncorporateActionIntoState(state, traj.Category, traj.NextAction, traj.EffectiveDiscountFactor, traj.CumulativeReturn);
 				}
 			}
 			else
@@ -460,81 +480,280 @@ namespace DynaPlex::Erasure
 			policy->SetAction(trajectories);
 			IncorporateAction(trajectories);
 		}
-		template <bool SkipTrivial>
-		bool IncorporateUntilSomeAction(std::span<DynaPlex::Trajectory> trajectories, int64_t MaxPeriodCount) const
+
+		void Evolve(std::span<DynaPlex::Trajectory> trajectories, const DynaPlex::Policy& policy, int64_t MaxPeriodCount) const override
 		{
-			bool AllAwaitAction = true;
+			if (!policy)
+				throw DynaPlex::Error("MDP->Evolve: policy should not be null.");
+			//policies from our own registry know their static type; let them call back into the fused loop. 
+			if (auto typed_policy = dynamic_cast<const MDPPolicyAdapter<t_MDP>*>(policy.get()); typed_policy && typed_policy->MDPIntHash() == mdp_int_hash)
+			{
+				typed_policy->Evolve(*this, trajectories, MaxPeriodCount);
+				return;
+			}
+			while (true)
+			{
+				if (!IncorporateUntilNonTrivialAction(trajectories, MaxPeriodCount))
+				{
+					//move trajectories that await an action to the front, and continue with those only. 
+					auto partition_point = std::partition(trajectories.begin(), trajectories.end(),
+						[](const DynaPlex::Trajectory& traj) {return traj.Category.IsAwaitAction(); });
+					trajectories = std::span<DynaPlex::Trajectory>(trajectories.begin(), partition_point);
+				}
+				if (trajectories.size() == 0)
+					break;
+				IncorporateAction(trajectories, policy);
+			}
+		}
 
-			for (DynaPlex::Trajectory& traj : trajectories)
+		std::unique_ptr<DynaPlex::TrajectoryBatchInterface> CreateTrajectoryBatch(const DynaPlex::Policy& policy, size_t size) const override
+		{
+			if (auto typed_policy = dynamic_cast<const MDPPolicyAdapter<t_MDP>*>(policy.get()); typed_policy && typed_policy->MDPIntHash() == mdp_int_hash)
+				return std::make_unique<TrajectoryBatchAdapter<t_MDP>>(*this, policy, *typed_policy, size);
+			return nullptr;
+		}
+
+	private:
+		//The kernels below act on a single typed state plus its bookkeeping, and are shared by the Trajectory-based 
+		//and the TrajectoryBatch-based entry points. 
+
+		void IncorporateActionIntoState(t_State& t_state, DynaPlex::StateCategory& category, int64_t action, double effective_discount_factor, double& cumulative_return) const
+		{
+			if constexpr (HasModifyStateWithAction<t_MDP>)
 			{
-				auto& t_state = ToState(traj.GetState());
+				cumulative_return += mdp->ModifyStateWithAction(t_state, action) * effective_discount_factor;
+				category = mdp->GetStateCategory(t_state);
+			}
+			else
+				throw DynaPlex::Error("MDP->IncorporateActions: " + mdp_type_id + "\nMDP does not publicly define ModifyStateWithAction(MDP::State,int64_t) const returning double");
+		}
 
-				while (traj.PeriodCount < MaxPeriodCount && traj.Category.IsAwaitEvent())
+		//assumes category.IsAwaitEvent()
+		void IncorporateEventIntoState(t_State& t_state, DynaPlex::StateCategory& category, int64_t& period_count, double& effective_discount_factor, double& cumulative_return, DynaPlex::RNGProvider& rng_provider) const
+		{
+			auto event_stream = category.Index();
+			if (event_stream == 0)
+			{
+				period_count++;
+				effective_discount_factor *= discount_factor;
+			}
+			if constexpr (HasModifyStateWithEvent<t_MDP, t_State, t_Event>)
+			{
+				if constexpr (HasGetEvent<t_MDP, t_Event, DynaPlex::RNG>)
 				{
-					auto event_stream = traj.Category.Index();
-					if (event_stream == 0)
+					if (auto* scenario = rng_provider.Scenario())
 					{
-						traj.PeriodCount++;
-						traj.EffectiveDiscountFactor *= discount_factor;
+						const t_Event& Event = ReplayEvent(*scenario, event_stream, rng_provider);
+						cumulative_return += mdp->ModifyStateWithEvent(t_state, Event) * effective_discount_factor;
 					}
-					if constexpr (HasModifyStateWithEvent<t_MDP, t_State, t_Event>)
+					else
 					{
-						if constexpr (HasGetEvent<t_MDP, t_Event, DynaPlex::RNG>)
-						{
-							t_Event Event = mdp->GetEvent(traj.RNGProvider.GetEventRNG(event_stream));
-							traj.CumulativeReturn += mdp->ModifyStateWithEvent(t_state, Event) * traj.EffectiveDiscountFactor;
-						}
-						else if constexpr (HasGetStateDependentEvent<t_MDP, t_State, t_Event, DynaPlex::RNG>)
-						{
-							t_Event Event = mdp->GetEvent(t_state, traj.RNGProvider.GetEventRNG(event_stream));
-							traj.CumulativeReturn += mdp->ModifyStateWithEvent(t_state, Event) * traj.EffectiveDiscountFactor;
-						}
-						else
-							throw DynaPlex::Error("MDP->IncorporateEvent: " + mdp_type_id + "\nMDP does not publicly define function GetEvent(DynaPlex::RNG&) returning MDP::Event. ");
+						t_Event Event = mdp->GetEvent(rng_provider.GetEventRNGUnchecked(event_stream));
+						cumulative_return += mdp->ModifyStateWithEvent(t_state, Event) * effective_discount_factor;
 					}
-					else
-						if constexpr (HasModifyStateWithRNG<t_MDP, t_State, DynaPlex::RNG>)
-						{
-							traj.CumulativeReturn += mdp->ModifyStateWithEvent(t_state, traj.RNGProvider.GetEventRNG(event_stream)) * traj.EffectiveDiscountFactor;
-						}
-						else							
-							throw DynaPlex::Error("MDP->IncorporateEvent: " + mdp_type_id + "\nMDP does not publicly define ModifyStateWithEvent(MDP::State&, const MDP::Event&) returning double.");
-					traj.Category = mdp->GetStateCategory(t_state);
+				}
+				else if constexpr (HasGetStateDependentEvent<t_MDP, t_State, t_Event, DynaPlex::RNG>)
+				{
+					t_Event Event = mdp->GetEvent(t_state, rng_provider.GetEventRNGUnchecked(event_stream));
+					cumulative_return += mdp->ModifyStateWithEvent(t_state, Event) * effective_discount_factor;
+				}
+				else
+					throw DynaPlex::Error("MDP->IncorporateEvent: " + mdp_type_id + "\nMDP does not publicly define function GetEvent(DynaPlex::RNG&) returning MDP::Event. ");
+			}
+			else //if constexpr 
+				if constexpr (HasModifyStateWithRNG<t_MDP, t_State, DynaPlex::RNG>)
+				{
+					cumulative_return += mdp->ModifyStateWithEvent(t_state, rng_provider.GetEventRNGUnchecked(event_stream)) * effective_discount_factor;
+				}
+				else
+					throw DynaPlex::Error("MDP->IncorporateEvent: " + mdp_type_id + "\nMDP does not publicly define ModifyStateWithEvent(MDP::State&, const MDP::Event&) returning double.");
+			category = mdp->GetStateCategory(t_state);
+		}
+
+		//returns the next event of the stream from the scenario, drawing and recording it if it is not yet recorded. 
+		const t_Event& ReplayEvent(DynaPlex::EventScenario& scenario, int64_t event_stream, DynaPlex::RNGProvider& rng_provider) const
+		{
+#ifdef DP_FULL_CHECKS
+			if (!dynamic_cast<RecordedEvents*>(&scenario))
+				throw DynaPlex::Error("MDP->IncorporateEvent: " + mdp_type_id + "\nEventScenario attached to trajectory was not created by this MDP.");
+#endif
+			auto& recorded = static_cast<RecordedEvents&>(scenario);
+			if (static_cast<int64_t>(recorded.streams.size()) <= event_stream)
+				recorded.streams.resize(event_stream + 1);
+			auto& stream = recorded.streams[event_stream];
+			int64_t& position = rng_provider.ScenarioPosition(event_stream);
+			if (position == static_cast<int64_t>(stream.events.size()))
+			{
+				if (!stream.started)
+				{//the stream of this provider is unused, since all its events come from the scenario. 
+					stream.rng = rng_provider.GetEventRNGUnchecked(event_stream);
+					stream.started = true;
+				}
+				stream.events.push_back(mdp->GetEvent(stream.rng));
+			}
+			return stream.events[position++];
+		}
 
-					int64_t action_count;
-					if constexpr (SkipTrivial)
+		template <bool SkipTrivial>
+		void IncorporateUntilSomeActionIntoState(t_State& t_state, DynaPlex::StateCategory& category, int64_t& next_action, int64_t& period_count, double& effective_discount_factor, double& cumulative_return, DynaPlex::RNGProvider& rng_provider, int64_t MaxPeriodCount) const
+		{
+			while (period_count < MaxPeriodCount && category.IsAwaitEvent())
+			{
+				IncorporateEventIntoState(t_state, category, period_count, effective_discount_factor, cumulative_return, rng_provider);
+				if constexpr (SkipTrivial)
+				{
+					while (category.IsAwaitAction())
 					{
-						while (traj.Category.IsAwaitAction())
-						{
-							auto actions = provider(t_state);
-							if (actions.Count() == 1)
-							{//trivial action:	
-								traj.NextAction = *(actions.begin());
-								if constexpr (HasModifyStateWithAction<t_MDP>)
-								{
-									traj.CumulativeReturn += mdp->ModifyStateWithAction(t_state, traj.NextAction) * traj.EffectiveDiscountFactor;
-									traj.Category = mdp->GetStateCategory(t_state);
-								}
-								else
-									throw DynaPlex::Error("MDP->IncorporateUntilNonTrivialAction: " + mdp_type_id + "\nMDP does not publicly define ModifyStateWithAction(MDP::State,int64_t) const returning double");
-							}
-							else
-							{//nontrivial action:
-								break;//the inner while loop. 
-							}
+						auto actions = provider(t_state);
+						if (actions.Count() == 1)
+						{//trivial action:	
+							next_action = *(actions.begin());
+							IncorporateActionIntoState(t_state, category, next_action, effective_discount_factor, cumulative_return);
+						}
+						else
+						{//nontrivial action:
+							break;//the inner while loop. 
 						}
 					}
 				}
+			}
+			assert(category.IsAwaitAction() || category.IsFinal() || period_count == MaxPeriodCount);
+		}
+
+		void GetFeaturesOfState(const t_State& t_state, std::span<float> feats, const char* caller) const
+		{
+			if constexpr (HasGetFlatFeatures<t_MDP, t_State>)
+			{
+				DynaPlex::Features traj_feats(feats);
+				mdp->GetFeatures(t_state, traj_feats);
+				if (!traj_feats.IsFilled())
+					throw DynaPlex::Error(std::string(caller) + ": mdp->GetFeatures(const State&, DynaPlex::Features&) const for mdp type " + mdp_type_id + " returns number of features that is inconsistent with num_flat_features. Possible causes: \n1) GetFeatures returns different numbers of features for different states; ensure consistency. \n2) num_flat_features as returned by GetStaticInfo is inconsistent with the number of features actually returned by GetFeatures(const State&, DynaPlex::Features&) const.");
+			}
+			else
+				throw DynaPlex::Error(std::string(caller) + ": MDP must publicly define MDP::GetFeatures(const State&, DynaPlex::Features&) const returning void.");
+		}
+
+		template <bool SkipTrivial>
+		bool IncorporateUntilSomeAction(std::span<DynaPlex::Trajectory> trajectories, int64_t MaxPeriodCount) const
+		{
+			CheckTrajectories(trajectories, false, "MDP->IncorporateUntilAction");
+			bool AllAwaitAction = true;
+
+			for (DynaPlex::Trajectory& traj : trajectories)
+			{
+				auto& t_state = UncheckedToState(traj.GetState());
+				IncorporateUntilSomeActionIntoState<SkipTrivial>(t_state, traj.Category, traj.NextAction, traj.PeriodCount, traj.EffectiveDiscountFactor, traj.CumulativeReturn, traj.RNGProvider, MaxPeriodCount);
 				if (!traj.Category.IsAwaitAction())
 				{
 					AllAwaitAction = false;
 				}
-				assert(traj.Category.IsAwaitAction() || traj.Category.IsFinal() || traj.PeriodCount == MaxPeriodCount);
+			}
+			return AllAwaitAction;
+		}
 
+		template <bool SkipTrivial>
+		bool IncorporateUntilSomeAction(TrajectoryBatch<t_MDP>& batch, int64_t MaxPeriodCount) const
+		{
+			CheckHasStates(batch, "MDP->IncorporateUntilAction(batch)");
+			bool AllAwaitAction = true;
+			const size_t size = batch.Size();
+			for (size_t i = 0; i < size; i++)
+			{
+				IncorporateUntilSomeActionIntoState<SkipTrivial>(batch.States[i], batch.Category[i], batch.NextAction[i], batch.PeriodCount[i], batch.EffectiveDiscountFactor[i], batch.CumulativeReturn[i], batch.RNGProvider[i], MaxPeriodCount);
+				if (!batch.Category[i].IsAwaitAction())
+				{
+					AllAwaitAction = false;
+				}
 			}
 			return AllAwaitAction;
 		}
 
+		void CheckHasStates(const TrajectoryBatch<t_MDP>& batch, const char* caller) const
+		{
+			if (!batch.HasStates())
+				throw DynaPlex::Error(std::string(caller) + ": TrajectoryBatch does not hold a state for every trajectory. Call InitiateState first.");
+		}
+
+		//Validates once per call that all trajectories hold a state created by this MDP, and optionally that they all await an action,
+		//such that the loop that follows may use UncheckedToState.
+		void CheckTrajectories(std::span<const DynaPlex::Trajectory> trajectories, bool require_await_action, const char* caller) const
+		{
+			for (const DynaPlex::Trajectory& traj : trajectories)
+			{
+				if (traj.GetState()->mdp_int_hash != mdp_int_hash)
+					throw DynaPlex::Error(std::string(caller) + ": It seems you tried to call MDP member functions with states or trajectories not created by this MDP, this should not be tried as it can lead to segmentation faults. ");
+				if (require_await_action && !traj.Category.IsAwaitAction())
+					throw DynaPlex::Error(std::string(caller) + ": Trajectory.Category does not satisfy IsAwaitAction().");
+			}
+		}
+
+		//ToState without the check that the state belongs to this MDP; only for states validated by CheckTrajectories.
+		//Builds with DP_FULL_CHECKS (e.g. Debug builds) still check every state.
+		t_State& UncheckedToState(const DynaPlex::dp_State& state) const
+		{
+#ifdef DP_FULL_CHECKS
+			ToState(state);
+#endif
+			return static_cast<StateAdapter<t_State>*>(state.get())->state;
+		}
+
+		template<typename, typename>
+		friend class PolicyAdapter;
+
+		//Single loop per trajectory in which the policy and all mdp functions are called non-virtually. Per trajectory, the 
+		//sequence of events, actions and rng draws is identical to that of the generic path in Evolve. 
+		template<typename t_Policy>
+		void FusedEvolve(const t_Policy& policy, std::span<DynaPlex::Trajectory> trajectories, int64_t MaxPeriodCount) const
+		{
+			for (DynaPlex::Trajectory& traj : trajectories)
+			{
+				if (!traj.GetState() || traj.GetState()->mdp_int_hash != mdp_int_hash)
+					throw DynaPlex::Error("MDP->Evolve: It seems you tried to call with trajectories whose states were not created by this MDP.");
+			}
+			for (DynaPlex::Trajectory& traj : trajectories)
+			{
+				t_State& t_state = static_cast<StateAdapter<t_State>*>(traj.GetState().get())->state;
+				while (true)
+				{
+					IncorporateUntilSomeActionIntoState<true>(t_state, traj.Category, traj.NextAction, traj.PeriodCount, traj.EffectiveDiscountFactor, traj.CumulativeReturn, traj.RNGProvider, MaxPeriodCount);
+					if (!traj.Category.IsAwaitAction())
+						break;
+					if constexpr (HasGetAction<t_Policy, t_State>)
+						traj.NextAction = policy.GetAction(t_state);
+					else
+						traj.NextAction = policy.GetAction(t_state, traj.RNGProvider.GetPolicyRNG());
+					IncorporateActionIntoState(t_state, traj.Category, traj.NextAction, traj.EffectiveDiscountFactor, traj.CumulativeReturn);
+				}
+			}
+		}
+
+		//As above, on the contiguous states of a TrajectoryBatch. Without SkipTrivial, the policy also chooses actions that are 
+		//the only allowed action. Throws when a trajectory needs more than max_actions actions. 
+		template<bool SkipTrivial, typename t_Policy>
+		void FusedEvolve(const t_Policy& policy, TrajectoryBatch<t_MDP>& batch, int64_t MaxPeriodCount, int64_t max_actions) const
+		{
+			CheckHasStates(batch, "MDP->Evolve(batch)");
+			for (size_t i = 0; i < batch.Size(); i++)
+			{
+				t_State& t_state = batch.States[i];
+				for (int64_t actions = 0; ; actions++)
+				{
+					IncorporateUntilSomeActionIntoState<SkipTrivial>(t_state, batch.Category[i], batch.NextAction[i], batch.PeriodCount[i], batch.EffectiveDiscountFactor[i], batch.CumulativeReturn[i], batch.RNGProvider[i], MaxPeriodCount);
+					if (!batch.Category[i].IsAwaitAction())
+						break;
+					if (actions == max_actions)
+						throw DynaPlex::Error("MDP->Evolve(batch): trajectory did not complete within " + std::to_string(max_actions) + " actions.");
+					if constexpr (HasGetAction<t_Policy, t_State>)
+						batch.NextAction[i] = policy.GetAction(t_state);
+					else
+						batch.NextAction[i] = policy.GetAction(t_state, batch.RNGProvider[i].GetPolicyRNG());
+					IncorporateActionIntoState(t_state, batch.Category[i], batch.NextAction[i], batch.EffectiveDiscountFactor[i], batch.CumulativeReturn[i]);
+				}
+			}
+		}
+
+	public:
+
 		bool IncorporateUntilAction(std::span<DynaPlex::Trajectory> trajectories, int64_t MaxPeriodCount) const override
 		{
 			return IncorporateUntilSomeAction<false>(trajectories, MaxPeriodCount);
@@ -556,37 +775,7 @@ namespace DynaPlex::Erasure
 				if (traj.Category.IsAwaitEvent())
 				{
 					auto& t_state = ToState(traj.GetState());
-					auto event_stream = traj.Category.Index();
-					if (event_stream == 0)
-					{
-						traj.PeriodCount++;
-						traj.EffectiveDiscountFactor *= discount_factor;
-					}
-					if constexpr (HasModifyStateWithEvent<t_MDP, t_State, t_Event>)
-					{
-						if constexpr (HasGetEvent<t_MDP, t_Event, DynaPlex::RNG>)
-						{
-							t_Event Event = mdp->GetEvent(traj.RNGProvider.GetEventRNG(event_stream));
-							traj.CumulativeReturn += mdp->ModifyStateWithEvent(t_state, Event) * traj.EffectiveDiscountFactor;
-						}
-						else if constexpr (HasGetStateDependentEvent<t_MDP, t_State, t_Event, DynaPlex::RNG>)
-						{
-							t_Event Event = mdp->GetEvent(t_state, traj.RNGProvider.GetEventRNG(event_stream));
-							traj.CumulativeReturn += mdp->ModifyStateWithEvent(t_state, Event) * traj.EffectiveDiscountFactor;
-						}
-						else
-							throw DynaPlex::Error("MDP->IncorporateEvent: " + mdp_type_id + "\nMDP does not publicly define function GetEvent(DynaPlex::RNG&) returning MDP::Event. ");
-
-					}
-					else //if constexpr 
-						if constexpr (HasModifyStateWithRNG<t_MDP, t_State, DynaPlex::RNG>)
-						{
-							traj.CumulativeReturn += mdp->ModifyStateWithEvent(t_state, traj.RNGProvider.GetEventRNG(event_stream)) * traj.EffectiveDiscountFactor;
-						}
-						else
-							throw DynaPlex::Error("MDP->IncorporateEvent: " + mdp_type_id + "\nMDP does not publicly define ModifyStateWithEvent(MDP::State&, const MDP::Event&) returning double.");
-
-					traj.Category = mdp->GetStateCategory(t_state);
+					IncorporateEventIntoState(t_state, traj.Category, traj.PeriodCount, traj.EffectiveDiscountFactor, traj.CumulativeReturn, traj.RNGProvider);
 					if (traj.Category.IsAwaitEvent())
 					{
 						EventsRemaining = true;
@@ -595,6 +784,113 @@ namespace DynaPlex::Erasure
 			}
 			return EventsRemaining;
 		}
+
+		/**
+		 * TrajectoryBatch overloads: same semantics as the corresponding std::span<DynaPlex::Trajectory> overloads, but operate on 
+		 * typed states stored contiguously in the batch. Only available when the MDP type is statically known. 
+		 */
+
+		/// Initiates all states in the batch; see InitiateState(std::span<DynaPlex::Trajectory>). RNGProviders must be seeded.
+		void InitiateState(TrajectoryBatch<t_MDP>& batch) const
+		{
+			const size_t size = batch.Size();
+			batch.States.clear();
+			if constexpr (HasGetInitialRandomState<t_MDP, DynaPlex::RNG>)
+			{
+				for (size_t i = 0; i < size; i++)
+					batch.States.push_back(mdp->GetInitialState(batch.RNGProvider[i].GetInitiationRNG()));
+			}
+			else if constexpr (HasGetInitialState<t_MDP>)
+			{
+				for (size_t i = 0; i < size; i++)
+					batch.States.push_back(mdp->GetInitialState());
+			}
+			else
+				throw DynaPlex::Error("MDP->InitiateState(batch): " + mdp_type_id + "\nMDP does not publicly define GetInitialState() const or GetInitialState(DynaPlex::RNG&) const returning MDP::State");
+			for (size_t i = 0; i < size; i++)
+				batch.Category[i] = mdp->GetStateCategory(batch.States[i]);
+			batch.Reset();
+		}
+
+		/// Sets all states in the batch to copies of state; see InitiateState(std::span<DynaPlex::Trajectory>, const dp_State&).
+		void InitiateState(TrajectoryBatch<t_MDP>& batch, const DynaPlex::dp_State& state) const
+		{
+			InitiateState(batch, ToState(state));
+		}
+
+		/// Sets all states in the batch to copies of t_state. Existing states are copy-assigned, reusing their storage. 
+		void InitiateState(TrajectoryBatch<t_MDP>& batch, const t_State& t_state) const
+		{
+			const size_t size = batch.Size();
+			if (batch.States.size() > size)
+				batch.States.resize(size, t_state);
+			for (size_t i = 0; i < batch.States.size(); i++)
+				batch.States[i] = t_state;
+			while (batch.States.size() < size)
+				batch.States.push_back(t_state);
+			for (size_t i = 0; i < size; i++)
+			{
+				if constexpr (HasResetHiddenStateVariables<t_MDP, t_State, DynaPlex::RNG>)
+				{
+					mdp->ResetHiddenStateVariables(batch.States[i], batch.RNGProvider[i].GetInitiationRNG());
+				}
+				batch.Category[i] = mdp->GetStateCategory(batch.States[i]);
+			}
+			batch.Reset();
+		}
+
+		bool IncorporateUntilAction(TrajectoryBatch<t_MDP>& batch, int64_t MaxPeriodCount = std::numeric_limits<int64_t>::max()) const
+		{
+			return IncorporateUntilSomeAction<false>(batch, MaxPeriodCount);
+		}
+
+		bool IncorporateUntilNonTrivialAction(TrajectoryBatch<t_MDP>& batch, int64_t MaxPeriodCount = std::numeric_limits<int64_t>::max()) const
+		{
+			return IncorporateUntilSomeAction<true>(batch, MaxPeriodCount);
+		}
+
+		/// Incorporates batch.NextAction[i] for each trajectory i in [begin,end); all must be IsAwaitAction. 
+		void IncorporateAction(TrajectoryBatch<t_MDP>& batch, size_t begin, size_t end) const
+		{
+			CheckHasStates(batch, "MDP->IncorporateAction(batch)");
+			if (begin > end || end > batch.Size())
+				throw DynaPlex::Error("MDP->IncorporateAction(batch): invalid range.");
+			for (size_t i = begin; i < end; i++)
+			{
+				if (!batch.Category[i].IsAwaitAction())
+					throw DynaPlex::Error("MDP->IncorporateAction(batch): Cannot incorporate action if Category is not AwaitAction");
+				IncorporateActionIntoState(batch.States[i], batch.Category[i], batch.NextAction[i], batch.EffectiveDiscountFactor[i], batch.CumulativeReturn[i]);
+			}
+		}
+
+		void IncorporateAction(TrajectoryBatch<t_MDP>& batch) const
+		{
+			IncorporateAction(batch, 0, batch.Size());
+		}
+
+		/// Writes the features of trajectories [begin,end) of the batch into feats, which must have size NumFlatFeatures*(end-begin).
+		void GetFlatFeatures(const TrajectoryBatch<t_MDP>& batch, size_t begin, size_t end, std::span<float> feats) const
+		{
+			CheckHasStates(batch, "MDP->GetFlatFeatures(batch,feats)");
+			if (begin > end || end > batch.Size())
+				throw DynaPlex::Error("MDP->GetFlatFeatures(batch,feats): invalid range.");
+			if (num_flat_features * (end - begin) != feats.size())
+				throw DynaPlex::Error("MDP->GetFlatFeatures(batch,feats): size of feats argument does not equal NumFlatFeatures*(end-begin)");
+			size_t offset = 0;
+			for (size_t i = begin; i < end; i++)
+			{
+				if (!batch.Category[i].IsAwaitAction())
+					throw DynaPlex::Error("MDP->GetFlatFeatures(batch,feats): trajectory in batch does not satisfy Category.IsAwaitAction().");
+				GetFeaturesOfState(batch.States[i], feats.subspan(offset, num_flat_features), "MDP->GetFlatFeatures(batch,feats)");
+				offset += num_flat_features;
+			}
+		}
+
+		void GetFlatFeatures(const TrajectoryBatch<t_MDP>& batch, std::span<float> feats) const
+		{
+			GetFlatFeatures(batch, 0, batch.Size(), feats);
+		}
+
 		virtual void InitiateState(std::span<DynaPlex::Trajectory> trajectories) const override
 		{
 			if constexpr (HasGetInitialRandomState<t_MDP, DynaPlex::RNG>)
@@ -620,9 +916,21 @@ namespace DynaPlex::Erasure
 		}
 		virtual void InitiateState(std::span<DynaPlex::Trajectory> trajectories, const DynaPlex::dp_State& state) const override
 		{
+			const t_State& root_state = ToState(state);
 			for (DynaPlex::Trajectory& traj : trajectories)
 			{
-				traj.Reset(std::move(state->Clone()));
+				if constexpr (std::is_copy_assignable_v<t_State>)
+				{
+					if (traj.HasState() && CheckConformant(traj.GetState()))
+					{//recycle the StateAdapter held by the trajectory, together with the storage of its members. 
+						ToState(traj.GetState()) = root_state;
+						traj.Reset();
+					}
+					else
+						traj.Reset(state->Clone());
+				}
+				else
+					traj.Reset(state->Clone());
 				auto& t_state = ToState(traj.GetState());
 				if constexpr (HasResetHiddenStateVariables<t_MDP, t_State, DynaPlex::RNG>)
 				{
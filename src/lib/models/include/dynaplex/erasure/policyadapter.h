@@ -6,11 +6,31 @@
 #include "dynaplex/statecategory.h"
 #include "stateadapter.h"
 #include "erasure_concepts.h"
+#include "trajectorybatch.h"
 
 namespace DynaPlex::Erasure
 {
+	template<typename>
+	class MDPAdapter;
+
+	/**
+	 * Common base of all PolicyAdapter<t_MDP, t_Policy> for a fixed t_MDP. Allows MDPAdapter<t_MDP> to recognize policies
+	 * obtained from its own PolicyRegistry, and to hand control back to them to run a fused simulation loop.
+	 */
+	template<typename t_MDP>
+	class MDPPolicyAdapter : public PolicyInterface
+	{
+	public:
+		/// hash of the MDP instance that this policy was obtained from.
+		virtual int64_t MDPIntHash() const = 0;
+		/// Dispatches to MDPAdapter<t_MDP>::FusedEvolve with the statically typed policy.
+		virtual void Evolve(const MDPAdapter<t_MDP>& adapter, std::span<Trajectory> trajectories, int64_t MaxPeriodCount) const = 0;
+		/// Dispatches to MDPAdapter<t_MDP>::FusedEvolve for a TrajectoryBatch; see TrajectoryBatchInterface::Evolve. 
+		virtual void Evolve(const MDPAdapter<t_MDP>& adapter, TrajectoryBatch<t_MDP>& batch, int64_t MaxPeriodCount, bool skip_trivial_actions, int64_t max_actions) const = 0;
+	};
+
 	template<typename t_MDP, typename t_Policy>
-	class PolicyAdapter final : public PolicyInterface
+	class PolicyAdapter final : public MDPPolicyAdapter<t_MDP>
 	{
 		static_assert(HasState<t_MDP>, "MDP must publicly define a nested type or using declaration for State");
 		static_assert(HasGetStateCategory<t_MDP>, "MDP must publicly define a function GetStateCategory(const MDP::State) const that returns a StateCategory");
@@ -45,6 +65,24 @@ namespace DynaPlex::Erasure
 
 		}
 
+		int64_t MDPIntHash() const override
+		{
+			return mdp_int_hash;
+		}
+
+		void Evolve(const MDPAdapter<t_MDP>& adapter, std::span<Trajectory> trajectories, int64_t MaxPeriodCount) const override
+		{
+			adapter.FusedEvolve(policy, trajectories, MaxPeriodCount);
+		}
+
+		void Evolve(const MDPAdapter<t_MDP>& adapter, TrajectoryBatch<t_MDP>& batch, int64_t MaxPeriodCount, bool skip_trivial_actions, int64_t max_actions) const override
+		{
+			if (skip_trivial_actions)
+				adapter.template FusedEvolve<true>(policy, batch, MaxPeriodCount, max_actions);
+			else
+				adapter.template FusedEvolve<false>(policy, batch, MaxPeriodCount, max_actions);
+		}
+
 		void SetAction(std::span<Trajectory> trajectories) const override
 		{	
 			for (Trajectory& traj: trajectories)
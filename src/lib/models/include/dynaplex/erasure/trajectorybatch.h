@@ -0,0 +1,128 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include "dynaplex/statecategory.h"
+#include "dynaplex/rngprovider.h"
+#include "dynaplex/error.h"
+
+namespace DynaPlex::Erasure
+{
+	/**
+	 * Structure-of-arrays counterpart of std::vector<DynaPlex::Trajectory> for a single, statically known MDP type.
+	 *
+	 * Where every DynaPlex::Trajectory owns a heap-allocated, type-erased state, TrajectoryBatch stores the typed states
+	 * by value in one contiguous buffer, and keeps the bookkeeping members of Trajectory in parallel arrays. Entry i of every
+	 * array belongs to trajectory i. The batched overloads of MDPAdapter<t_MDP> (InitiateState, IncorporateUntilAction,
+	 * IncorporateAction, GetFlatFeatures, ...) operate on it without pointer chasing or per-trajectory virtual calls.
+	 *
+	 * Semantics of the members are identical to those of the same-named members of DynaPlex::Trajectory.
+	 */
+	template<typename t_MDP>
+	class TrajectoryBatch
+	{
+	public:
+		using t_State = typename t_MDP::State;
+
+		/// Typed states; empty until populated by MDPAdapter::InitiateState.
+		std::vector<t_State> States;
+		std::vector<DynaPlex::StateCategory> Category;
+		std::vector<int64_t> NextAction;
+		std::vector<int64_t> PeriodCount;
+		std::vector<double> EffectiveDiscountFactor;
+		std::vector<double> CumulativeReturn;
+		std::vector<DynaPlex::RNGProvider> RNGProvider;
+		std::vector<int64_t> ExternalIndex;
+
+		/**
+		 * Creates a batch for size trajectories, without states and with unseeded RNGProviders. ExternalIndex is initialized to
+		 * 0,1,...,size-1. Seed RNGProvider[i] and call MDPAdapter::InitiateState before use.
+		 */
+		explicit TrajectoryBatch(size_t size = 0)
+		{
+			Resize(size);
+		}
+
+		size_t Size() const
+		{
+			return Category.size();
+		}
+
+		bool HasStates() const
+		{
+			return States.size() == Category.size();
+		}
+
+		/// Resizes the bookkeeping arrays; drops all states.
+		void Resize(size_t size)
+		{
+			States.clear();
+			States.reserve(size);
+			Category.assign(size, DynaPlex::StateCategory{});
+			NextAction.assign(size, 0);
+			RNGProvider.resize(size);
+			ExternalIndex.resize(size);
+			for (size_t i = 0; i < size; i++)
+				ExternalIndex[i] = static_cast<int64_t>(i);
+			PeriodCount.resize(size);
+			EffectiveDiscountFactor.resize(size);
+			CumulativeReturn.resize(size);
+			Reset();
+		}
+
+		/// re-initiates PeriodCount, EffectiveDiscountFactor, CumulativeReturn for trajectory i.
+		void Reset(size_t i)
+		{
+			PeriodCount[i] = 0;
+			EffectiveDiscountFactor[i] = 1.0;
+			CumulativeReturn[i] = 0.0;
+		}
+
+		/// re-initiates PeriodCount, EffectiveDiscountFactor, CumulativeReturn for all trajectories.
+		void Reset()
+		{
+			std::fill(PeriodCount.begin(), PeriodCount.end(), 0);
+			std::fill(EffectiveDiscountFactor.begin(), EffectiveDiscountFactor.end(), 1.0);
+			std::fill(CumulativeReturn.begin(), CumulativeReturn.end(), 0.0);
+		}
+
+		/// Exchanges all data of trajectories i and j.
+		void Swap(size_t i, size_t j)
+		{
+			using std::swap;
+			if (HasStates())
+				swap(States[i], States[j]);
+			swap(Category[i], Category[j]);
+			swap(NextAction[i], NextAction[j]);
+			swap(PeriodCount[i], PeriodCount[j]);
+			swap(EffectiveDiscountFactor[i], EffectiveDiscountFactor[j]);
+			swap(CumulativeReturn[i], CumulativeReturn[j]);
+			swap(RNGProvider[i], RNGProvider[j]);
+			swap(ExternalIndex[i], ExternalIndex[j]);
+		}
+
+		/**
+		 * Reorders the trajectories in [begin,end) such that all trajectories for which pred(i) holds precede those for which it does not,
+		 * and returns the index of the first trajectory of the second group. Like std::partition, relative order is not preserved.
+		 */
+		template<typename Pred>
+		size_t Partition(size_t begin, size_t end, Pred pred)
+		{
+			if (end > Size() || begin > end)
+				throw DynaPlex::Error("TrajectoryBatch::Partition - invalid range.");
+			while (true)
+			{
+				while (begin < end && pred(begin))
+					begin++;
+				while (begin < end && !pred(end - 1))
+					end--;
+				if (begin == end)
+					return begin;
+				Swap(begin, end - 1);
+				begin++;
+				end--;
+			}
+		}
+	};
+}
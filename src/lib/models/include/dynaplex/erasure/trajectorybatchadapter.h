@@ -0,0 +1,84 @@
+#pragma once
+#include <memory>
+#include <span>
+#include "dynaplex/policy.h"
+#include "dynaplex/error.h"
+#include "dynaplex/trajectorybatchinterface.h"
+#include "trajectorybatch.h"
+#include "policyadapter.h"
+
+namespace DynaPlex::Erasure
+{
+	template<typename>
+	class MDPAdapter;
+
+	/**
+	 * Implements DynaPlex::TrajectoryBatchInterface on a TrajectoryBatch<t_MDP>, for a policy obtained from the PolicyRegistry of
+	 * the MDP. Created by MDPAdapter<t_MDP>::CreateTrajectoryBatch. Evolve simulates every trajectory in a single loop in which 
+	 * policy and MDP are not called virtually; trajectories are never reordered. 
+	 */
+	template<typename t_MDP>
+	class TrajectoryBatchAdapter final : public DynaPlex::TrajectoryBatchInterface
+	{
+	public:
+		TrajectoryBatchAdapter(const MDPAdapter<t_MDP>& adapter, DynaPlex::Policy policy, const MDPPolicyAdapter<t_MDP>& typed_policy, size_t size)
+			: adapter{ adapter }, policy{ std::move(policy) }, typed_policy{ typed_policy }, batch(size)
+		{
+		}
+
+		size_t Size() const override
+		{
+			return batch.Size();
+		}
+
+		DynaPlex::RNGProvider& RNGProvider(size_t i) override
+		{
+			return batch.RNGProvider[i];
+		}
+
+		void InitiateState() override
+		{
+			adapter.InitiateState(batch);
+		}
+
+		void InitiateState(const DynaPlex::dp_State& state) override
+		{
+			adapter.InitiateState(batch, state);
+		}
+
+		void IncorporateAction(std::span<const int64_t> actions) override
+		{
+			if (actions.size() != batch.Size())
+				throw DynaPlex::Error("TrajectoryBatch::IncorporateAction - number of actions does not match number of trajectories.");
+			std::copy(actions.begin(), actions.end(), batch.NextAction.begin());
+			adapter.IncorporateAction(batch);
+		}
+
+		void Evolve(int64_t MaxPeriodCount, bool skip_trivial_actions, int64_t max_actions) override
+		{
+			typed_policy.Evolve(adapter, batch, MaxPeriodCount, skip_trivial_actions, max_actions);
+		}
+
+		double CumulativeReturn(size_t i) const override
+		{
+			return batch.CumulativeReturn[i];
+		}
+
+		int64_t PeriodCount(size_t i) const override
+		{
+			return batch.PeriodCount[i];
+		}
+
+		DynaPlex::StateCategory Category(size_t i) const override
+		{
+			return batch.Category[i];
+		}
+
+	private:
+		const MDPAdapter<t_MDP>& adapter;
+		//keeps typed_policy alive.
+		DynaPlex::Policy policy;
+		const MDPPolicyAdapter<t_MDP>& typed_policy;
+		TrajectoryBatch<t_MDP> batch;
+	};
+}
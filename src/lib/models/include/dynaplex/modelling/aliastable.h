@@ -0,0 +1,41 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace DynaPlex
+{
+	/**
+	 * Alias table (Walker's alias method, constructed following Vose) for sampling an index of a probability mass function 
+	 * in O(1) time, irrespective of the number of support points. Used by DiscreteDist and JointDiscreteDist after OptimizeForSampling(true).
+	 */
+	class AliasTable
+	{
+	public:
+		AliasTable() = default;
+		/// Builds the table for the pmf, which must be non-negative with a positive sum; it is normalized if it does not sum to one.
+		explicit AliasTable(const std::vector<double>& pmf);
+
+		bool Empty() const
+		{
+			return probability.empty();
+		}
+
+		/// Maps a uniform value in [0,1) to an index of the pmf; indices with zero probability are never returned. 
+		size_t Sample(double uniform) const
+		{
+			const double scaled = uniform * static_cast<double>(probability.size());
+			size_t index = static_cast<size_t>(scaled);
+			if (index >= probability.size())
+				index = probability.size() - 1;
+			return (scaled - static_cast<double>(index)) < probability[index] ? index : alias[index];
+		}
+
+		bool operator==(const AliasTable& other) const = default;
+
+	private:
+		//probability of keeping the index of the bucket, rather than its alias.
+		std::vector<double> probability{};
+		std::vector<size_t> alias{};
+	};
+}
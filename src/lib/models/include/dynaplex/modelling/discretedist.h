@@ -1,7 +1,10 @@
 #pragma once
 #include <vector>
+#include <span>
 #include <dynaplex/vargroup.h>
 #include <dynaplex/rng.h>
+#include <dynaplex/modelling/aliastable.h>
+#include <dynaplex/modelling/guidetable.h>
 
 namespace DynaPlex
 {
@@ -44,7 +47,8 @@ namespace DynaPlex
 
 	private:
 		std::vector<double> translatedPMF{};
-		std::vector<double> cumulativePMF{};
+		GuideTable guideTable{};
+		AliasTable aliasTable{};
 		bool optimizedForSampling{ false };
 		int64_t min{ 0 };
 
@@ -56,6 +60,12 @@ namespace DynaPlex
 
 		static void Trim(std::vector<double>& toBeTrimmed, int64_t& min);
 
+		//maps a uniform value in [0,1) to a sample. 
+		int64_t SampleFromUniform(double randomValue) const;
+
+		template<typename t_RNG>
+		void FillSamples(t_RNG& rng, std::span<int64_t> samples) const;
+
 
 		// Always ensure the PMF is validated using IsProbMassFunction 
 		// before constructing a DiscreteDist object.
@@ -156,12 +166,23 @@ namespace DynaPlex
 
 		DiscreteDist(const DynaPlex::VarGroup& vars);
 		
-		/// creates an internal data structure that enables samples to be drawn much faster, especially when there are many potential values that this might take on.
-		void OptimizeForSampling();
+		/**
+		 * creates internal data structures that enable samples to be drawn much faster, especially when there are many potential values that this might take on: 
+		 * a guide table for the cdf, such that GetSample and GetConditionalSample take O(1) expected time, and draw the same samples as without it.
+		 * With useAliasTable, GetSample uses an alias table instead, which takes O(1) time also for heavy tails, but draws different samples 
+		 * (from the same distribution); models that use it no longer reproduce their earlier sample paths. 
+		 */
+		void OptimizeForSampling(bool useAliasTable = false);
 
 		/// Returns a sample of the rv, using the rng as random number generator. 
 		int64_t GetSample(DynaPlex::RNG& rng) const;
 
+		/// Fills samples with i.i.d. samples of the rv; identical to calling GetSample(rng) samples.size() times. 
+		void GetSamples(DynaPlex::RNG& rng, std::span<int64_t> samples) const;
+
+		/// Fills samples with i.i.d. samples of the rv, using uniforms that are generated in bulk by the lanes of rng.
+		void GetSamples(DynaPlex::MultiLaneRNG& rng, std::span<int64_t> samples) const;
+
 		/// Returns a sample x of the rv|x>=minimum_value. Uses the rng as random number generator. 
 		int64_t GetConditionalSample(DynaPlex::RNG& rng,int64_t minimum_value) const;
 
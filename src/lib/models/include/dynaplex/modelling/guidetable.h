@@ -0,0 +1,52 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace DynaPlex
+{
+	/**
+	 * Cumulative probability mass function together with a guide table, for inverting the cdf in O(1) expected time. Returns 
+	 * exactly the index that a search over the cumulative pmf returns, so samples drawn through it are identical to those drawn by 
+	 * a linear or binary search. Used by DiscreteDist and JointDiscreteDist after OptimizeForSampling.
+	 */
+	class GuideTable
+	{
+	public:
+		GuideTable() = default;
+		/// Builds the table for the pmf; cumulative probabilities are summed in order, as a linear search would. 
+		explicit GuideTable(const std::vector<double>& pmf);
+
+		bool Empty() const
+		{
+			return cumulative.empty();
+		}
+
+		size_t Size() const
+		{
+			return cumulative.size();
+		}
+
+		/// Sum of the probabilities of indices 0,...,index.
+		double Cumulative(size_t index) const
+		{
+			return cumulative[index];
+		}
+
+		/// First index at or after startIndex with cumulative probability not below uniform (as std::lower_bound); Size() if none.
+		size_t LowerBound(double uniform, size_t startIndex = 0) const;
+
+		/// First index with cumulative probability above uniform (as std::upper_bound); Size() if none.
+		size_t UpperBound(double uniform) const;
+
+		bool operator==(const GuideTable& other) const = default;
+
+	private:
+		//first index of the search for a uniform in [k/n,(k+1)/n).
+		size_t Start(double uniform) const;
+
+		std::vector<double> cumulative{};
+		//guide[k] is the first index with cumulative probability >= k/n. 
+		std::vector<size_t> guide{};
+	};
+}
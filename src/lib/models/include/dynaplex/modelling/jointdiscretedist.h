@@ -3,6 +3,8 @@
 #include <dynaplex/vargroup.h>
 #include <dynaplex/rng.h>
 #include "dynaplex/modelling/discretedist.h"
+#include "dynaplex/modelling/aliastable.h"
+#include "dynaplex/modelling/guidetable.h"
 
 namespace DynaPlex
 {
@@ -46,6 +48,11 @@ namespace DynaPlex
 	private:
 		std::vector<double> translatedPMF{};
 		std::vector<std::vector<int64_t>> JointQtys;
+		GuideTable guideTable{};
+		AliasTable aliasTable{};
+
+		//maps a uniform value in [0,1) to a position in JointQtys.
+		int64_t SampleFromUniform(double randomValue) const;
 
 
 		inline static double epsilon{ 1e-16 };
@@ -89,6 +96,12 @@ namespace DynaPlex
 			return static_cast<int64_t>(translatedPMF.size()) - 1ll;
 		}
 
+		/**
+		 * Builds a guide table for the cdf, such that GetSample and GetSampleQtys take O(1) expected time and draw the same samples as without it.
+		 * With useAliasTable, an alias table is used instead, which changes which samples are drawn (not their distribution). 
+		 */
+		void OptimizeForSampling(bool useAliasTable = false);
+
 		/// Returns a sample of the rv, using the rng as random number generator. 
 		int64_t GetSample(DynaPlex::RNG& rng) const;
 
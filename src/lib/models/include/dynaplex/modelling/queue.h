@@ -204,6 +204,25 @@ namespace DynaPlex {
 			return items[GetVectorIndex(first_item + loc)];
 		}
 
+		/// Element at position loc; unlike at(), only checks the position in builds with DP_FULL_CHECKS (e.g. Debug builds).
+		T& operator[](size_t loc)
+		{
+#ifdef DP_FULL_CHECKS
+			return at(loc);
+#else
+			return items[GetVectorIndex(first_item + loc)];
+#endif
+		}
+
+		const T& operator[](size_t loc) const
+		{
+#ifdef DP_FULL_CHECKS
+			return at(loc);
+#else
+			return items[GetVectorIndex(first_item + loc)];
+#endif
+		}
+
 		T sum()
 		{
 			static_assert(std::is_same_v<T, double> || std::is_same_v<T, int64_t>, "dynaplex::queue::sum can only be called when T is double or int64_t");
@@ -0,0 +1,66 @@
+#include "dynaplex/modelling/aliastable.h"
+#include "dynaplex/error.h"
+
+namespace DynaPlex
+{
+	AliasTable::AliasTable(const std::vector<double>& pmf)
+	{
+		const size_t n = pmf.size();
+		double sum = 0.0;
+		for (double p : pmf)
+		{
+			if (p < 0.0)
+				throw DynaPlex::Error("AliasTable: probabilities must be non-negative.");
+			sum += p;
+		}
+		if (n == 0 || !(sum > 0.0))
+			throw DynaPlex::Error("AliasTable: probability mass function must have positive total mass.");
+
+		probability.resize(n);
+		alias.resize(n);
+		std::vector<double> scaled(n);
+		std::vector<size_t> small, large;
+		small.reserve(n);
+		large.reserve(n);
+		for (size_t i = 0; i < n; i++)
+		{
+			scaled[i] = pmf[i] * static_cast<double>(n) / sum;
+			alias[i] = i;
+			if (scaled[i] < 1.0)
+				small.push_back(i);
+			else
+				large.push_back(i);
+		}
+		while (!small.empty() && !large.empty())
+		{
+			size_t s = small.back();
+			small.pop_back();
+			size_t l = large.back();
+			probability[s] = scaled[s];
+			alias[s] = l;
+			scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+			if (scaled[l] < 1.0)
+			{
+				large.pop_back();
+				small.push_back(l);
+			}
+		}
+		//remaining buckets are full, up to rounding errors. 
+		for (size_t l : large)
+			probability[l] = 1.0;
+		for (size_t s : small)
+		{
+			//only reachable through rounding; never send mass to an index with zero probability.
+			probability[s] = pmf[s] > 0.0 ? 1.0 : 0.0;
+			if (pmf[s] <= 0.0)
+			{
+				for (size_t i = 0; i < n; i++)
+					if (pmf[i] > 0.0)
+					{
+						alias[s] = i;
+						break;
+					}
+			}
+		}
+	}
+}
@@ -729,12 +729,11 @@ namespace DynaPlex
 
 		if (optimizedForSampling)
 		{
-			double cumulativeProbabilityAtStart = startIndex > 0 ? cumulativePMF[startIndex - 1] : 0.0;
+			double cumulativeProbabilityAtStart = startIndex > 0 ? guideTable.Cumulative(startIndex - 1) : 0.0;
 			double randomValue = rng.genUniform() * (1.0 - cumulativeProbabilityAtStart) + cumulativeProbabilityAtStart;
 
-			// Use binary search over the range starting from startIndex
-			auto it = std::lower_bound(cumulativePMF.begin() + startIndex, cumulativePMF.end(), randomValue);
-			size_t index = std::distance(cumulativePMF.begin(), it);
+			// Invert the cdf over the range starting from startIndex, using the guide table
+			size_t index = guideTable.LowerBound(randomValue, startIndex);
 
 			return min + static_cast<int64_t>(index);
 		}
@@ -763,27 +762,46 @@ namespace DynaPlex
 		}
 	}
 
-	void DiscreteDist::OptimizeForSampling() {
-		//if (translatedPMF.size() > 9)
-		{
-			cumulativePMF.reserve(translatedPMF.size());
-			double sum = 0.0;
-			for (const auto& p : translatedPMF) {
-				sum += p;
-				cumulativePMF.push_back(sum);
-			}
-			optimizedForSampling = true;
-		}
+	void DiscreteDist::OptimizeForSampling(bool useAliasTable) {
+		guideTable = GuideTable(translatedPMF);
+		aliasTable = useAliasTable ? AliasTable(translatedPMF) : AliasTable{};
+		optimizedForSampling = true;
 	}
 
 	int64_t DiscreteDist::GetSample(DynaPlex::RNG& rng) const {
 		// Generate a uniform random number between 0 and 1
-		double randomValue = rng.genUniform();
+		return SampleFromUniform(rng.genUniform());
+	}
+
+	template<typename t_RNG>
+	void DiscreteDist::FillSamples(t_RNG& rng, std::span<int64_t> samples) const {
+		//uniforms are generated in blocks, and then mapped to samples. 
+		constexpr size_t block_size = 64;
+		double uniforms[block_size];
+		for (size_t start = 0; start < samples.size(); start += block_size)
+		{
+			size_t count = std::min(block_size, samples.size() - start);
+			rng.FillUniform(std::span<double>(uniforms, count));
+			for (size_t i = 0; i < count; i++)
+				samples[start + i] = SampleFromUniform(uniforms[i]);
+		}
+	}
+
+	void DiscreteDist::GetSamples(DynaPlex::RNG& rng, std::span<int64_t> samples) const {
+		FillSamples(rng, samples);
+	}
+
+	void DiscreteDist::GetSamples(DynaPlex::MultiLaneRNG& rng, std::span<int64_t> samples) const {
+		FillSamples(rng, samples);
+	}
 
+	int64_t DiscreteDist::SampleFromUniform(double randomValue) const {
 		if (optimizedForSampling) {
-			// Use binary search on the cumulativePMF
-			auto it = std::lower_bound(cumulativePMF.begin(), cumulativePMF.end(), randomValue);
-			size_t index = std::distance(cumulativePMF.begin(), it);
+			if (!aliasTable.Empty())
+				// Use the alias table; O(1) irrespective of the number of support points
+				return min + static_cast<int64_t>(aliasTable.Sample(randomValue));
+			// Invert the cdf using the guide table; same sample as the binary search over the cumulative pmf
+			size_t index = std::min(guideTable.LowerBound(randomValue), translatedPMF.size() - 1);
 			return min + static_cast<int64_t>(index);
 		}
 		else {
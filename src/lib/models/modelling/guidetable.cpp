@@ -0,0 +1,52 @@
+#include "dynaplex/modelling/guidetable.h"
+#include <algorithm>
+
+namespace DynaPlex
+{
+	GuideTable::GuideTable(const std::vector<double>& pmf)
+	{
+		cumulative.reserve(pmf.size());
+		double sum = 0.0;
+		for (double p : pmf)
+		{
+			sum += p;
+			cumulative.push_back(sum);
+		}
+		const size_t n = cumulative.size();
+		guide.assign(n, 0);
+		size_t index = 0;
+		for (size_t k = 0; k < n; k++)
+		{
+			double threshold = static_cast<double>(k) / static_cast<double>(n);
+			while (index < n && cumulative[index] < threshold)
+				index++;
+			guide[k] = index;
+		}
+	}
+
+	size_t GuideTable::Start(double uniform) const
+	{
+		//all indices before guide[k] have cumulative probability below k/n <= uniform, so they are skipped by either search. 
+		const size_t n = cumulative.size();
+		const size_t k = std::min(static_cast<size_t>(std::max(uniform, 0.0) * static_cast<double>(n)), n - 1);
+		return guide[k];
+	}
+
+	size_t GuideTable::LowerBound(double uniform, size_t startIndex) const
+	{
+		const size_t n = cumulative.size();
+		size_t index = std::max(Start(uniform), startIndex);
+		while (index < n && cumulative[index] < uniform)
+			index++;
+		return index;
+	}
+
+	size_t GuideTable::UpperBound(double uniform) const
+	{
+		const size_t n = cumulative.size();
+		size_t index = Start(uniform);
+		while (index < n && cumulative[index] <= uniform)
+			index++;
+		return index;
+	}
+}
@@ -139,9 +139,20 @@ namespace DynaPlex
 		return translatedPMF[value];
 	}
 
-	int64_t JointDiscreteDist::GetSample(DynaPlex::RNG& rng) const {
-		// Generate a uniform random number between 0 and 1
-		double randomValue = rng.genUniform();
+	void JointDiscreteDist::OptimizeForSampling(bool useAliasTable) {
+		guideTable = GuideTable(translatedPMF);
+		aliasTable = useAliasTable ? AliasTable(translatedPMF) : AliasTable{};
+	}
+
+	int64_t JointDiscreteDist::SampleFromUniform(double randomValue) const {
+		if (!aliasTable.Empty())
+			return static_cast<int64_t>(aliasTable.Sample(randomValue));
+		if (!guideTable.Empty())
+		{
+			//same position as the linear search below
+			size_t index = guideTable.UpperBound(randomValue);
+			return index < guideTable.Size() ? static_cast<int64_t>(index) : Max();
+		}
 		double cumulativeProbability = 0.0;
 		for (size_t i = 0; i < translatedPMF.size(); i++) {
 			cumulativeProbability += translatedPMF[i];
@@ -155,20 +166,14 @@ namespace DynaPlex
 		return Max();
 	}
 
-	std::vector<int64_t> JointDiscreteDist::GetSampleQtys(DynaPlex::RNG& rng) const {
+	int64_t JointDiscreteDist::GetSample(DynaPlex::RNG& rng) const {
 		// Generate a uniform random number between 0 and 1
-		double randomValue = rng.genUniform();
-		double cumulativeProbability = 0.0;
-		for (size_t i = 0; i < translatedPMF.size(); i++) {
-			cumulativeProbability += translatedPMF[i];
-			if (randomValue < cumulativeProbability) {
-				return GetQtysForJointDist(static_cast<int64_t>(i));
-			}
-		}
+		return SampleFromUniform(rng.genUniform());
+	}
 
-		// This should technically never be reached if probabilities sum to 1, 
-		// but it handles potential numerical inaccuracies.
-		return GetQtysForJointDist(Max());
+	std::vector<int64_t> JointDiscreteDist::GetSampleQtys(DynaPlex::RNG& rng) const {
+		// Generate a uniform random number between 0 and 1
+		return GetQtysForJointDist(SampleFromUniform(rng.genUniform()));
 	}
 
 	std::vector<int64_t> JointDiscreteDist::GetQtysForJointDist(int64_t pos) const {
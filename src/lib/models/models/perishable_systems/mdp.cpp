@@ -87,6 +87,7 @@ namespace DynaPlex::Models {
 			//demand_dist = JointDiscreteDist(dist);
 
 			demand_dist = JointDiscreteDist(fifo_demand_dist, lifo_demand_dist);
+			demand_dist.OptimizeForSampling();
 			demand_combination_holder = demand_dist.GetJointQtys();
 		}
 
@@ -102,7 +103,7 @@ namespace DynaPlex::Models {
 		{
 			state.cat = StateCategory::AwaitAction();
 
-			int64_t onHand = state.state_vector.at(ProductLife - 1);			
+			int64_t onHand = state.state_vector[ProductLife - 1];			
 			int64_t FIFOdemand = demand_combination_holder[event][0];
 			int64_t LIFOdemand = demand_combination_holder[event][1];
 			int64_t TotalDemand = FIFOdemand + LIFOdemand;
@@ -116,18 +117,18 @@ namespace DynaPlex::Models {
 				state.state_vector.pop_front();
 
 				for (size_t i = 0; i < ProductLife - 1; i++) {
-					state.state_vector.at(i) = 0;
+					state.state_vector[i] = 0;
 				}
 			}
 			else {
 				// Meet fifo demand
 				if (FIFOdemand > 0) {
 					for (size_t i = 0; i < ProductLife; i++) {
-						if (state.state_vector.at(i) <= FIFOdemand) {
-							state.state_vector.at(i) = 0;
+						if (state.state_vector[i] <= FIFOdemand) {
+							state.state_vector[i] = 0;
 						}
 						else {
-							state.state_vector.at(i) -= FIFOdemand;
+							state.state_vector[i] -= FIFOdemand;
 						}
 					}
 				}
@@ -136,29 +137,29 @@ namespace DynaPlex::Models {
 
 				// Meet lifo demand
 				if (LIFOdemand > 0) {
-					int64_t Inv = state.state_vector.at(ProductLife - 2) - LIFOdemand;
+					int64_t Inv = state.state_vector[ProductLife - 2] - LIFOdemand;
 					perishedInv = std::min(Inv, perishedInv);
 					for (size_t i = 0; i < ProductLife - 1; i++) {
-						int64_t curInv = state.state_vector.at(i);
-						state.state_vector.at(i) = std::min(Inv, curInv) - perishedInv;
+						int64_t curInv = state.state_vector[i];
+						state.state_vector[i] = std::min(Inv, curInv) - perishedInv;
 					}
 				}
 				else {
 					for (size_t i = 0; i < ProductLife - 1; i++) {
-						state.state_vector.at(i) -= perishedInv;
+						state.state_vector[i] -= perishedInv;
 					}
 				}
 
 				InvDecrease = TotalDemand + perishedInv;
 				cost += o * perishedInv;
 				if (ProductLife > 1 && h > 0.0) {
-					cost += h * state.state_vector.at(ProductLife - 2);
+					cost += h * state.state_vector[ProductLife - 2];
 				}
 			}
 
 			for (size_t i = ProductLife - 1; i < ProductLife + LeadTime - 1; i++)
 			{
-				state.state_vector.at(i) -= InvDecrease;
+				state.state_vector[i] -= InvDecrease;
 			}
 
 			return cost;
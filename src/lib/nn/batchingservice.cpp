@@ -0,0 +1,104 @@
+#include "dynaplex/batchingservice.h"
+#include "dynaplex/error.h"
+
+namespace DynaPlex::NN
+{
+	BatchingService::BatchingService(Forward forward, int64_t num_inputs, int64_t num_outputs, const DynaPlex::VarGroup& config)
+		: forward{ std::move(forward) }, num_inputs{ num_inputs }, num_outputs{ num_outputs }
+	{
+		if (!this->forward)
+			throw DynaPlex::Error("BatchingService: forward should not be null.");
+		if (num_inputs < 1 || num_outputs < 1)
+			throw DynaPlex::Error("BatchingService: num_inputs and num_outputs should be positive.");
+		config.GetOrDefault("max_batch_size", max_batch_size, 1024);
+		if (max_batch_size < 1)
+			throw DynaPlex::Error("BatchingService: max_batch_size should be positive.");
+		config.GetOrDefault("max_latency_us", max_latency_us, 200);
+		if (max_latency_us < 0)
+			throw DynaPlex::Error("BatchingService: max_latency_us should be non-negative.");
+		service_thread = std::thread([this]() { Run(); });
+	}
+
+	BatchingService::~BatchingService()
+	{
+		{
+			std::lock_guard lock(mutex);
+			stopping = true;
+		}
+		pending_changed.notify_all();
+		service_thread.join();
+	}
+
+	std::future<std::vector<float>> BatchingService::Submit(std::vector<float> inputs)
+	{
+		if (inputs.empty() || inputs.size() % num_inputs != 0)
+			throw DynaPlex::Error("BatchingService::Submit: number of inputs should be a positive multiple of num_inputs.");
+		Request request{ std::move(inputs), {}, std::chrono::steady_clock::now() };
+		auto future = request.result.get_future();
+		{
+			std::lock_guard lock(mutex);
+			pending_rows += static_cast<int64_t>(request.inputs.size()) / num_inputs;
+			pending.push_back(std::move(request));
+		}
+		pending_changed.notify_one();
+		return future;
+	}
+
+	void BatchingService::Run()
+	{
+		std::vector<Request> batch;
+		while (true)
+		{
+			{
+				std::unique_lock lock(mutex);
+				pending_changed.wait(lock, [this]() { return stopping || !pending.empty(); });
+				if (pending.empty())
+					return;//stopping, and nothing left to evaluate.
+				//wait for more rows until the batch is full, or the oldest request has waited long enough.
+				auto deadline = pending.front().submitted + std::chrono::microseconds(max_latency_us);
+				pending_changed.wait_until(lock, deadline, [this]() { return stopping || pending_rows >= max_batch_size; });
+
+				int64_t rows = 0;
+				while (!pending.empty())
+				{
+					int64_t request_rows = static_cast<int64_t>(pending.front().inputs.size()) / num_inputs;
+					if (rows > 0 && rows + request_rows > max_batch_size)
+						break;
+					rows += request_rows;
+					pending_rows -= request_rows;
+					batch.push_back(std::move(pending.front()));
+					pending.pop_front();
+				}
+			}
+			Evaluate(batch);
+			batch.clear();
+		}
+	}
+
+	void BatchingService::Evaluate(std::vector<Request>& batch)
+	{
+		std::vector<float> outputs;
+		try
+		{
+			std::vector<float> inputs;
+			for (auto& request : batch)
+				inputs.insert(inputs.end(), request.inputs.begin(), request.inputs.end());
+			int64_t rows = static_cast<int64_t>(inputs.size()) / num_inputs;
+			outputs.resize(rows * num_outputs);
+			forward(inputs, rows, outputs);
+		}
+		catch (...)
+		{
+			for (auto& request : batch)
+				request.result.set_exception(std::current_exception());
+			return;
+		}
+		auto output_iter = outputs.begin();
+		for (auto& request : batch)
+		{
+			int64_t request_outputs = static_cast<int64_t>(request.inputs.size()) / num_inputs * num_outputs;
+			request.result.set_value(std::vector<float>(output_iter, output_iter + request_outputs));
+			output_iter += request_outputs;
+		}
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+#include "dynaplex/vargroup.h"
+
+namespace DynaPlex::NN
+{
+	/**
+	 * Aggregates rows of inputs that are submitted concurrently by multiple threads, and evaluates them in a single call of a
+	 * forward function on a dedicated thread. Amortizes the per-call overhead of a neural network over the rows of all threads.
+	 *
+	 * A batch is evaluated as soon as it holds max_batch_size rows, or when the oldest pending request has waited max_latency_us
+	 * microseconds. Requests are never split over batches; a single request may exceed max_batch_size.
+	 */
+	class BatchingService
+	{
+	public:
+		/// Evaluates rows (row-major, rows x num_inputs) and writes the results (row-major, rows x num_outputs) to outputs.
+		using Forward = std::function<void(std::span<const float> inputs, int64_t rows, std::span<float> outputs)>;
+
+		/// Config: max_batch_size (default 1024) and max_latency_us (default 200).
+		BatchingService(Forward forward, int64_t num_inputs, int64_t num_outputs, const DynaPlex::VarGroup& config = VarGroup{});
+		/// Evaluates the pending requests, and stops the service thread.
+		~BatchingService();
+
+		BatchingService(const BatchingService&) = delete;
+		BatchingService& operator=(const BatchingService&) = delete;
+
+		/**
+		 * Submits rows of inputs (row-major, with num_inputs entries per row). The future obtains the outputs (row-major, num_outputs entries
+		 * per row), or the exception thrown by the forward function. Thread-safe.
+		 */
+		std::future<std::vector<float>> Submit(std::vector<float> inputs);
+
+		int64_t MaxBatchSize() const { return max_batch_size; }
+		int64_t MaxLatencyMicroseconds() const { return max_latency_us; }
+
+	private:
+		struct Request {
+			std::vector<float> inputs;
+			std::promise<std::vector<float>> result;
+			std::chrono::steady_clock::time_point submitted;
+		};
+
+		void Run();
+		void Evaluate(std::vector<Request>& batch);
+
+		Forward forward;
+		int64_t num_inputs, num_outputs;
+		int64_t max_batch_size, max_latency_us;
+
+		std::mutex mutex;
+		std::condition_variable pending_changed;
+		std::deque<Request> pending;
+		int64_t pending_rows = 0;
+		bool stopping = false;
+		std::thread service_thread;
+	};
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace DynaPlex::NN
+{
+	/**
+	 * Evaluates multi-layer perceptrons of type "mlp" (see NeuralNetworkProvider) without torch: fully connected layers, with a ReLU
+	 * after every layer but the last. Bias and ReLU are fused into a matrix product that is blocked such that a strip of the weights
+	 * stays in cache while it is applied to all rows. On x86-64 with GCC or Clang, AVX-512 or AVX2 code is selected at runtime;
+	 * otherwise a portable loop is used. Int8 products use AVX-512 VNNI where available.
+	 *
+	 * After training, the network may be evaluated in reduced precision, see SetPrecision. The float32 weights are retained, such that
+	 * Save and Layers are not affected by the precision.
+	 *
+	 * File layout (little-endian): Header, followed by the layers in order. Per layer: num_inputs and num_outputs (int64), the weights
+	 * (float32, num_outputs x num_inputs, row-major as in torch::nn::Linear) and the bias (float32, num_outputs).
+	 */
+	class MLPEngine
+	{
+	public:
+		static constexpr uint32_t Version = 1;
+		/// First bytes of every file written by Save.
+		static constexpr char Magic[8] = { 'D','P','M','L','P','N','E','T' };
+
+		struct Header {
+			char magic[8];
+			uint32_t version;
+			uint32_t num_layers;
+		};
+
+		/// Number format in which Forward evaluates the layers.
+		enum class Precision {
+			/// float32 weights and activations.
+			Float32,
+			/// bfloat16 weights, rounded from float32; float32 activations and accumulation.
+			BFloat16,
+			/// int8 weights with a scale per output, inputs of every layer rounded to int8 with a calibrated scale, int32 accumulation.
+			Int8
+		};
+		/// Converts "float32", "bf16" or "int8"; throws otherwise.
+		static Precision PrecisionFromString(const std::string& precision);
+		static std::string ToString(Precision precision);
+
+		struct Layer {
+			int64_t num_inputs;
+			int64_t num_outputs;
+			/// num_outputs x num_inputs, row-major.
+			std::vector<float> weights;
+			/// num_outputs.
+			std::vector<float> bias;
+		};
+
+		/// Throws if layers is empty, if the sizes of weights or bias are inconsistent, or if consecutive layers do not connect.
+		explicit MLPEngine(const std::vector<Layer>& layers);
+
+		/// Loads the network from a file written by Save. Throws if the file is not a valid network file of a supported version.
+		static MLPEngine Load(const std::string& path);
+		void Save(const std::string& path) const;
+
+		int64_t NumInputs() const { return layers.front().num_inputs; }
+		int64_t NumOutputs() const { return layers.back().num_outputs; }
+		/// Returns the layers, in the format that was passed to the constructor.
+		std::vector<Layer> Layers() const;
+
+		/// Evaluates rows (row-major, rows x NumInputs()) and writes the results (row-major, rows x NumOutputs()) to outputs. Thread-safe.
+		void Forward(std::span<const float> inputs, int64_t rows, std::span<float> outputs) const;
+
+		/// Returns for every layer the largest absolute value among its inputs when evaluating the rows of inputs in float32. Used to calibrate Int8.
+		std::vector<float> InputRanges(std::span<const float> inputs, int64_t rows) const;
+		/**
+		 * Sets the precision in which Forward evaluates. For Int8, input_ranges holds for every layer the absolute input that is mapped to
+		 * int8 value 127 (see InputRanges); inputs beyond it are clamped.
+		 */
+		void SetPrecision(Precision precision, const std::vector<float>& input_ranges = {});
+		Precision GetPrecision() const { return precision; }
+
+	private:
+		//weights are stored transposed (num_inputs x stride), with the outputs padded to a multiple of the block width.
+		struct PackedLayer {
+			int64_t num_inputs;
+			int64_t num_outputs;
+			int64_t stride;
+			std::vector<float> weights;
+			std::vector<float> bias;
+			//BFloat16: weights in the same layout. 
+			std::vector<uint16_t> bf16_weights{};
+			//Int8: quantized weights, in groups of four consecutive inputs ((num_inputs+3)/4 x stride x 4), and the scale of every output,
+			//such that output = bias + int8_scales * (sum of quantized inputs times quantized weights). Inputs are quantized with input_scale.
+			//int8_offsets is -128 times the sum of the quantized weights of every output; see the VNNI kernel. 
+			std::vector<int8_t> int8_weights{};
+			std::vector<float> int8_scales{};
+			std::vector<int32_t> int8_offsets{};
+			float input_scale = 1.0f;
+		};
+		std::vector<PackedLayer> layers;
+		Precision precision = Precision::Float32;
+	};
+}
@@ -10,7 +10,17 @@ namespace DynaPlex::NN
 		PolicyTrainer(const DynaPlex::System&, DynaPlex::MDP,const DynaPlex::VarGroup& training_config, int64_t rng_seed);
 		PolicyTrainer() = default;
 		void TrainPolicy(DynaPlex::VarGroup nn_architecture, int64_t generation, std::string path_to_sample_data, bool silent=false);
-		DynaPlex::Policy LoadPolicy(DynaPlex::VarGroup nn_architecture, int64_t generation);
+		/// inference_config "precision" ("float32" by default, "bf16" or "int8") selects the policy written by QuantizePolicy. 
+		DynaPlex::Policy LoadPolicy(DynaPlex::VarGroup nn_architecture, int64_t generation, const DynaPlex::VarGroup& inference_config = VarGroup{});
+		/**
+		 * Quantizes the mlp policy of the generation to precision ("bf16" or "int8"), and saves it next to the float32 policy. Int8 is
+		 * calibrated on the first calibration_samples samples at path_to_sample_data. Returns the quantization that is saved with the policy:
+		 * precision, input_ranges and action_agreement, the fraction of all samples on which the quantized policy selects the same action
+		 * as the float32 policy. Does not require torch. 
+		 */
+		DynaPlex::VarGroup QuantizePolicy(DynaPlex::VarGroup nn_architecture, int64_t generation, std::string path_to_sample_data, const std::string& precision, bool silent = false);
+		/// Whether TrainPolicy is a collective operation, in which every process trains on a share of the samples. 
+		bool DataParallel() const { return data_parallel; }
 
 	private:
 		DynaPlex::System system;
@@ -20,5 +30,11 @@ namespace DynaPlex::NN
 		int64_t early_stopping_patience;
 		int64_t max_training_epochs;
 		bool train_based_on_probs;
+		//whether the tensors of all samples are computed once before training, rather than per mini-batch. 
+		bool cache_tensors;
+		int64_t prefetch_batches, prefetch_threads;
+		bool parallel_validation;
+		bool data_parallel;
+		int64_t calibration_samples;
 	};
 }//DynaPlex::NN
\ No newline at end of file
@@ -0,0 +1,110 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "dynaplex/error.h"
+
+namespace DynaPlex::NN
+{
+	/**
+	 * Produces the items produce(0), ..., produce(count-1) on background threads, at most capacity items ahead of the consumer,
+	 * and hands them out in order of index. Used to prepare the next mini-batches while the optimizer works on the current one.
+	 *
+	 * With capacity 0, no threads are started, and Next() produces the item on the calling thread.
+	 */
+	template <typename T>
+	class Prefetcher
+	{
+	public:
+		using Producer = std::function<T(int64_t index)>;
+
+		Prefetcher(Producer produce, int64_t count, int64_t capacity, int64_t num_threads = 1)
+			: produce{ std::move(produce) }, count{ count }, capacity{ capacity }
+		{
+			if (!this->produce)
+				throw DynaPlex::Error("Prefetcher: produce should not be null.");
+			if (count < 0 || capacity < 0 || num_threads < 1)
+				throw DynaPlex::Error("Prefetcher: count and capacity should be non-negative, and num_threads positive.");
+			if (capacity > 0)
+				for (int64_t i = 0; i < std::min(num_threads, count); i++)
+					threads.emplace_back([this]() { Work(); });
+		}
+
+		/// Stops producing items that were not yet started, and waits for the items that are being produced.
+		~Prefetcher()
+		{
+			{
+				std::lock_guard lock(mutex);
+				stopping = true;
+			}
+			slot_freed.notify_all();
+			for (auto& thread : threads)
+				thread.join();
+		}
+
+		Prefetcher(const Prefetcher&) = delete;
+		Prefetcher& operator=(const Prefetcher&) = delete;
+
+		/// Returns the item with the next index; rethrows the exception if producing it failed.
+		T Next()
+		{
+			if (next_to_consume >= count)
+				throw DynaPlex::Error("Prefetcher::Next - all items were consumed.");
+			if (threads.empty())
+				return produce(next_to_consume++);
+
+			std::unique_lock lock(mutex);
+			item_ready.wait(lock, [this]() { return ready.contains(next_to_consume) || errors.contains(next_to_consume); });
+			if (auto error = errors.find(next_to_consume); error != errors.end())
+				std::rethrow_exception(error->second);
+			auto node = ready.extract(next_to_consume++);
+			lock.unlock();
+			slot_freed.notify_all();
+			return std::move(node.mapped());
+		}
+
+	private:
+		void Work()
+		{
+			while (true)
+			{
+				int64_t index;
+				{
+					std::unique_lock lock(mutex);
+					slot_freed.wait(lock, [this]() { return stopping || next_to_claim >= count || next_to_claim < next_to_consume + capacity; });
+					if (stopping || next_to_claim >= count)
+						return;
+					index = next_to_claim++;
+				}
+				try
+				{
+					T item = produce(index);
+					std::lock_guard lock(mutex);
+					ready.emplace(index, std::move(item));
+				}
+				catch (...)
+				{
+					std::lock_guard lock(mutex);
+					errors.emplace(index, std::current_exception());
+				}
+				item_ready.notify_all();
+			}
+		}
+
+		Producer produce;
+		int64_t count, capacity;
+		int64_t next_to_claim = 0, next_to_consume = 0;
+
+		std::mutex mutex;
+		std::condition_variable slot_freed, item_ready;
+		std::map<int64_t, T> ready;
+		std::map<int64_t, std::exception_ptr> errors;
+		bool stopping = false;
+		std::vector<std::thread> threads;
+	};
+}
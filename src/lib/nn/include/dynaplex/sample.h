@@ -20,6 +20,8 @@ namespace DynaPlex::NN
         double q_hat;
         std::vector<double> cost_improvement;
         std::vector<double> probabilities;
+        //whether the statistics were copied from an earlier sample of an equal state, rather than simulated; not serialized. 
+        bool memoized{ false };
 
         Sample() = default;
         Sample(int64_t action_label, DynaPlex::dp_State state);
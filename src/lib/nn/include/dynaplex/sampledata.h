@@ -1,5 +1,7 @@
 #pragma once
 #include <vector>
+#include <span>
+#include <cstdint>
 #include "dynaplex/sample.h" 
 #include "dynaplex/rng.h"
 #include "dynaplex/mdp.h"
@@ -9,12 +11,22 @@ namespace DynaPlex::NN
 	class SampleData
 	{
 		std::string unique_identifier;
+		//memoized samples among samples that were added from files or buffers. 
+		int64_t num_memoized_added = 0;
+		DynaPlex::VarGroup ToVarGroup(const DynaPlex::MDP&) const;
+		static SampleData FromVarGroup(DynaPlex::MDP, const DynaPlex::VarGroup&);
 	public:
 		std::vector<DynaPlex::NN::Sample> Samples;
+		/// Number of samples with Sample::memoized, including samples added from files or buffers. 
+		int64_t NumMemoized() const;
 		SampleData(DynaPlex::MDP);
 		void SaveToFile(DynaPlex::MDP, std::string path, int64_t json_indent=-1, bool silent=true);
 		static SampleData CreateNewFromFile(DynaPlex::MDP, std::string path);
 		void AddFromFile(DynaPlex::MDP, std::string path);
+		/// Compact binary representation of the samples, e.g. for sending them to another process. 
+		std::vector<uint8_t> Serialize(DynaPlex::MDP) const;
+		/// Adds the samples from a buffer obtained with Serialize. 
+		void AddFromSerialized(DynaPlex::MDP, std::span<const uint8_t> bytes);
 		void PrintStatistics();
 	};
 }
\ No newline at end of file
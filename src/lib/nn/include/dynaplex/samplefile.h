@@ -0,0 +1,103 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include "dynaplex/sample.h"
+#include "dynaplex/mdp.h"
+#include "dynaplex/threadpool.h"
+
+namespace DynaPlex::NN
+{
+	/**
+	 * Binary, columnar file with samples for supervised learning, in which states are stored as flat features. Files are read
+	 * through a read-only memory mapping, such that columns are accessible without parsing or copying.
+	 *
+	 * Layout (little-endian): Header, followed by the mdp identifier (identifier_length chars), followed by the columns. Each column
+	 * starts at the offset recorded in the header; offsets are multiples of 64 bytes. With N=num_samples, F=num_features and
+	 * A=num_valid_actions, all matrices row-major:
+	 * - features:         float32, N x F
+	 * - mask:             float32, N x A; 1.0 for allowed actions, 0.0 otherwise
+	 * - probabilities:    float32, N x A; 0.0 for actions that are not allowed
+	 * - cost_improvement: float32, N x A; 0.0 for actions that are not allowed
+	 * - action_label:     int64, N
+	 * - sample_number:    int64, N
+	 * - q_hat:            float32, N
+	 * - z_stat:           float32, N
+	 */
+	class SampleFile
+	{
+	public:
+		static constexpr uint32_t Version = 1;
+		/// First bytes of every sample file.
+		static constexpr char Magic[8] = { 'D','P','S','A','M','P','L','E' };
+
+		struct Header {
+			char magic[8];
+			uint32_t version;
+			uint32_t identifier_length;
+			int64_t num_samples;
+			int64_t num_features;
+			int64_t num_valid_actions;
+			int64_t features_offset;
+			int64_t mask_offset;
+			int64_t probabilities_offset;
+			int64_t cost_improvement_offset;
+			int64_t action_label_offset;
+			int64_t sample_number_offset;
+			int64_t q_hat_offset;
+			int64_t z_stat_offset;
+			int64_t file_size;
+		};
+
+		/**
+		 * Writes the samples to path. The states of the samples are converted to flat features; the states themselves are not stored.
+		 * Throws if a state was not created with mdp, or if mdp does not provide flat features.
+		 * If pool is not null, the states are converted on the threads of pool.
+		 */
+		static void Save(const DynaPlex::MDP& mdp, std::span<const DynaPlex::NN::Sample> samples, const std::string& path,
+			DynaPlex::Parallel::ThreadPool* pool = nullptr);
+
+		/// Returns whether the file at path exists and starts with SampleFile::Magic.
+		static bool IsSampleFile(const std::string& path);
+
+		/// Maps the file at path into memory. Throws if the file is not a valid sample file of a supported version.
+		explicit SampleFile(const std::string& path);
+		/// As SampleFile(path), but additionally throws if the samples were not created with an mdp with the same identifier as mdp.
+		SampleFile(const DynaPlex::MDP& mdp, const std::string& path);
+		~SampleFile();
+
+		SampleFile(SampleFile&&) noexcept;
+		SampleFile& operator=(SampleFile&&) noexcept;
+
+		int64_t NumSamples() const { return header.num_samples; }
+		int64_t NumFeatures() const { return header.num_features; }
+		int64_t NumValidActions() const { return header.num_valid_actions; }
+		/// Identifier of the mdp with which the samples were created.
+		const std::string& Identifier() const { return identifier; }
+
+		std::span<const float> Features() const;
+		std::span<const float> Mask() const;
+		std::span<const float> Probabilities() const;
+		std::span<const float> CostImprovement() const;
+		std::span<const int64_t> ActionLabels() const;
+		std::span<const int64_t> SampleNumbers() const;
+		std::span<const float> QHat() const;
+		std::span<const float> ZStat() const;
+
+		/// Features of sample i.
+		std::span<const float> Features(int64_t i) const
+		{
+			return Features().subspan(i * NumFeatures(), NumFeatures());
+		}
+
+	private:
+		template<typename T>
+		std::span<const T> Column(int64_t offset, int64_t count) const;
+
+		class Mapping;
+		std::unique_ptr<Mapping> mapping;
+		Header header;
+		std::string identifier;
+	};
+}
@@ -9,8 +9,10 @@ namespace DynaPlex {
 	public:
 		
 		//Attempts to load a policy from the mentioned path. 
-		static DynaPlex::Policy LoadPolicy(DynaPlex::MDP mdp, std::string path_to_policy_without_extension);
-		//Attempts to save the policy, assuming it is a neural network policy trained in c++. 
+		//inference_config: with batch_across_threads true, concurrent calls share forward passes (see NN::BatchingService for further keys).
+		//engine "native" (the default without torch, and for quantized policies) evaluates mlp networks with NN::MLPEngine; engine "torch" uses libtorch. 
+		static DynaPlex::Policy LoadPolicy(DynaPlex::MDP mdp, std::string path_to_policy_without_extension, const DynaPlex::VarGroup& inference_config = VarGroup{});
+		//Attempts to save the policy, assuming it is a neural network policy trained in c++. Weights of mlp networks are also saved for NN::MLPEngine. 
 		static void SavePolicy(DynaPlex::Policy, std::string path_to_policy_without_extension);
 	};
 
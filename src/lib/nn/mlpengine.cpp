@@ -0,0 +1,677 @@
+#include "dynaplex/mlpengine.h"
+#include "dynaplex/error.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace DynaPlex::NN
+{
+	static_assert(std::endian::native == std::endian::little, "MLPEngine assumes a little-endian platform.");
+	static_assert(sizeof(MLPEngine::Header) == 16, "MLPEngine::Header should not contain padding.");
+
+	namespace {
+		//a block of the output is block_rows x block_columns; 16 floats fill one AVX-512 or two AVX2 registers.
+		constexpr int64_t block_rows = 4;
+		constexpr int64_t block_columns = 16;
+
+		float FromBFloat16(uint16_t value)
+		{
+			return std::bit_cast<float>(static_cast<uint32_t>(value) << 16);
+		}
+
+		//rounds to the nearest bfloat16, ties to even.
+		uint16_t ToBFloat16(float value)
+		{
+			uint32_t bits = std::bit_cast<uint32_t>(value);
+			bits += 0x7FFF + ((bits >> 16) & 1);
+			return static_cast<uint16_t>(bits >> 16);
+		}
+
+		/**
+		 * Kernels compute y[r][j] = bias[j] + sum_k x[r][k] * w[k][j] for R rows and block_columns columns, optionally followed by
+		 * ReLU, keeping the R x block_columns accumulators in registers. Kernels for float (F32), bfloat16 (BF16) weights and for
+		 * int8 (I8) inputs and weights differ in the types of x and w:
+		 * - F32 and BF16: x is float (rows x depth), w is float or bfloat16 (depth x columns).
+		 * - I8: x and w are int8, in groups of four consecutive inputs: x is rows x (4 depth), w is depth x columns x 4. Products are
+		 *   summed in int32, and y[r][j] = bias[j] + scales[j] * sum. offsets[j] is -128 times the sum of the weights of column j.
+		 * ColumnWidth is the number of elements of w per column and depth. Supported() tells whether the processor supports the kernel.
+		 */
+		struct PortableF32Kernel {
+			static constexpr int64_t ColumnWidth = 1;
+			static bool Supported() { return true; }
+			template<int64_t R>
+			static void Apply(const float* x, int64_t x_stride, int64_t depth, const float* w, int64_t w_stride,
+				const float*, const int32_t*, const float* bias, float* y, int64_t y_stride, bool relu)
+			{
+				float acc[R][block_columns];
+				for (int64_t r = 0; r < R; r++)
+					for (int64_t j = 0; j < block_columns; j++)
+						acc[r][j] = bias[j];
+				for (int64_t k = 0; k < depth; k++)
+				{
+					const float* w_k = w + k * w_stride;
+					for (int64_t r = 0; r < R; r++)
+					{
+						const float x_rk = x[r * x_stride + k];
+						for (int64_t j = 0; j < block_columns; j++)
+							acc[r][j] += x_rk * w_k[j];
+					}
+				}
+				for (int64_t r = 0; r < R; r++)
+					for (int64_t j = 0; j < block_columns; j++)
+						y[r * y_stride + j] = relu ? std::max(acc[r][j], 0.0f) : acc[r][j];
+			}
+		};
+
+		struct PortableBF16Kernel {
+			static constexpr int64_t ColumnWidth = 1;
+			static bool Supported() { return true; }
+			template<int64_t R>
+			static void Apply(const float* x, int64_t x_stride, int64_t depth, const uint16_t* w, int64_t w_stride,
+				const float*, const int32_t*, const float* bias, float* y, int64_t y_stride, bool relu)
+			{
+				float acc[R][block_columns];
+				for (int64_t r = 0; r < R; r++)
+					for (int64_t j = 0; j < block_columns; j++)
+						acc[r][j] = bias[j];
+				for (int64_t k = 0; k < depth; k++)
+				{
+					float w_k[block_columns];
+					for (int64_t j = 0; j < block_columns; j++)
+						w_k[j] = FromBFloat16(w[k * w_stride + j]);
+					for (int64_t r = 0; r < R; r++)
+					{
+						const float x_rk = x[r * x_stride + k];
+						for (int64_t j = 0; j < block_columns; j++)
+							acc[r][j] += x_rk * w_k[j];
+					}
+				}
+				for (int64_t r = 0; r < R; r++)
+					for (int64_t j = 0; j < block_columns; j++)
+						y[r * y_stride + j] = relu ? std::max(acc[r][j], 0.0f) : acc[r][j];
+			}
+		};
+
+		struct PortableI8Kernel {
+			static constexpr int64_t ColumnWidth = 4;
+			static bool Supported() { return true; }
+			template<int64_t R>
+			static void Apply(const int8_t* x, int64_t x_stride, int64_t depth, const int8_t* w, int64_t w_stride,
+				const float* scales, const int32_t*, const float* bias, float* y, int64_t y_stride, bool relu)
+			{
+				int32_t acc[R][block_columns] = {};
+				for (int64_t p = 0; p < depth; p++)
+				{
+					const int8_t* w_p = w + p * w_stride;
+					for (int64_t r = 0; r < R; r++)
+					{
+						const int8_t* x_rp = x + r * x_stride + 4 * p;
+						for (int64_t j = 0; j < block_columns; j++)
+							for (int64_t t = 0; t < 4; t++)
+								acc[r][j] += x_rp[t] * w_p[4 * j + t];
+					}
+				}
+				for (int64_t r = 0; r < R; r++)
+					for (int64_t j = 0; j < block_columns; j++)
+					{
+						float value = bias[j] + scales[j] * static_cast<float>(acc[r][j]);
+						y[r * y_stride + j] = relu ? std::max(value, 0.0f) : value;
+					}
+			}
+		};
+
+		//the four int8 inputs of a group, sign-extended to int16, as a single 64-bit value.
+		int64_t WidenGroup(const int8_t* x)
+		{
+			uint64_t group = 0;
+			for (int64_t t = 0; t < 4; t++)
+				group |= static_cast<uint64_t>(static_cast<uint16_t>(static_cast<int16_t>(x[t]))) << (16 * t);
+			return static_cast<int64_t>(group);
+		}
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#if defined(__GNUC__) && !defined(__clang__)
+		//GCC 12 implements unmasked AVX-512 intrinsics (_mm512_max_ps, _mm512_cvtepu16_epi32, ...) as their masked forms with an
+		//_mm512_undefined_* source, and reports that source as (maybe) uninitialized once inlined. Every lane is written, so the
+		//warnings are false positives (fixed in GCC 13). 
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+		struct AVX512F32Kernel {
+			static constexpr int64_t ColumnWidth = 1;
+			static bool Supported() { return __builtin_cpu_supports("avx512f"); }
+			template<int64_t R>
+			__attribute__((target("avx512f")))
+			static void Apply(const float* x, int64_t x_stride, int64_t depth, const float* w, int64_t w_stride,
+				const float*, const int32_t*, const float* bias, float* y, int64_t y_stride, bool relu)
+			{
+				__m512 acc[R];
+				for (int64_t r = 0; r < R; r++)
+					acc[r] = _mm512_loadu_ps(bias);
+				for (int64_t k = 0; k < depth; k++)
+				{
+					const __m512 w_k = _mm512_loadu_ps(w + k * w_stride);
+					for (int64_t r = 0; r < R; r++)
+						acc[r] = _mm512_fmadd_ps(_mm512_set1_ps(x[r * x_stride + k]), w_k, acc[r]);
+				}
+				for (int64_t r = 0; r < R; r++)
+					_mm512_storeu_ps(y + r * y_stride, relu ? _mm512_max_ps(acc[r], _mm512_setzero_ps()) : acc[r]);
+			}
+		};
+
+		struct AVX512BF16Kernel {
+			static constexpr int64_t ColumnWidth = 1;
+			static bool Supported() { return __builtin_cpu_supports("avx512f"); }
+			template<int64_t R>
+			__attribute__((target("avx512f")))
+			static void Apply(const float* x, int64_t x_stride, int64_t depth, const uint16_t* w, int64_t w_stride,
+				const float*, const int32_t*, const float* bias, float* y, int64_t y_stride, bool relu)
+			{
+				__m512 acc[R];
+				for (int64_t r = 0; r < R; r++)
+					acc[r] = _mm512_loadu_ps(bias);
+				for (int64_t k = 0; k < depth; k++)
+				{
+					//a bfloat16 is the upper half of a float.
+					const __m256i w_16 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w + k * w_stride));
+					const __m512 w_k = _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_cvtepu16_epi32(w_16), 16));
+					for (int64_t r = 0; r < R; r++)
+						acc[r] = _mm512_fmadd_ps(_mm512_set1_ps(x[r * x_stride + k]), w_k, acc[r]);
+				}
+				for (int64_t r = 0; r < R; r++)
+					_mm512_storeu_ps(y + r * y_stride, relu ? _mm512_max_ps(acc[r], _mm512_setzero_ps()) : acc[r]);
+			}
+		};
+
+		//int8 products with vpdpbusd, which multiplies unsigned with signed bytes. The inputs are made unsigned by adding 128, for
+		//which offsets compensates. 
+		struct AVX512VNNII8Kernel {
+			static constexpr int64_t ColumnWidth = 4;
+			static bool Supported()
+			{
+				return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vnni");
+			}
+			template<int64_t R>
+			__attribute__((target("avx512f,avx512bw,avx512vnni")))
+			static void Apply(const int8_t* x, int64_t x_stride, int64_t depth, const int8_t* w, int64_t w_stride,
+				const float* scales, const int32_t* offsets, const float* bias, float* y, int64_t y_stride, bool relu)
+			{
+				//flipping the sign bit of every byte adds 128. 
+				constexpr int32_t sign_bits = static_cast<int32_t>(0x80808080u);
+				__m512i acc[R];
+				for (int64_t r = 0; r < R; r++)
+					acc[r] = _mm512_loadu_si512(offsets);
+				for (int64_t p = 0; p < depth; p++)
+				{
+					const __m512i w_p = _mm512_loadu_si512(w + p * w_stride);
+					for (int64_t r = 0; r < R; r++)
+					{
+						int32_t x_group;
+						std::memcpy(&x_group, x + r * x_stride + 4 * p, sizeof(x_group));
+						acc[r] = _mm512_dpbusd_epi32(acc[r], _mm512_set1_epi32(x_group ^ sign_bits), w_p);
+					}
+				}
+				const __m512 scale = _mm512_loadu_ps(scales), offset = _mm512_loadu_ps(bias);
+				for (int64_t r = 0; r < R; r++)
+				{
+					__m512 value = _mm512_fmadd_ps(_mm512_cvtepi32_ps(acc[r]), scale, offset);
+					_mm512_storeu_ps(y + r * y_stride, relu ? _mm512_max_ps(value, _mm512_setzero_ps()) : value);
+				}
+			}
+		};
+
+		//without VNNI, the int8 weights are sign-extended to int16 in registers, and multiplied with vpmaddwd. 
+		struct AVX512I8Kernel {
+			static constexpr int64_t ColumnWidth = 4;
+			static bool Supported() { return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"); }
+			template<int64_t R>
+			__attribute__((target("avx512f,avx512bw")))
+			static void Apply(const int8_t* x, int64_t x_stride, int64_t depth, const int8_t* w, int64_t w_stride,
+				const float* scales, const int32_t*, const float* bias, float* y, int64_t y_stride, bool relu)
+			{
+				//acc[r][h] holds two partial sums (of two inputs each) for each of the columns 8h,...,8h+7.
+				__m512i acc[R][2];
+				for (int64_t r = 0; r < R; r++)
+					acc[r][0] = acc[r][1] = _mm512_setzero_si512();
+				for (int64_t p = 0; p < depth; p++)
+				{
+					const __m256i* w_p = reinterpret_cast<const __m256i*>(w + p * w_stride);
+					const __m512i w_p0 = _mm512_cvtepi8_epi16(_mm256_loadu_si256(w_p)), w_p1 = _mm512_cvtepi8_epi16(_mm256_loadu_si256(w_p + 1));
+					for (int64_t r = 0; r < R; r++)
+					{
+						const __m512i x_rp = _mm512_set1_epi64(WidenGroup(x + r * x_stride + 4 * p));
+						acc[r][0] = _mm512_add_epi32(acc[r][0], _mm512_madd_epi16(x_rp, w_p0));
+						acc[r][1] = _mm512_add_epi32(acc[r][1], _mm512_madd_epi16(x_rp, w_p1));
+					}
+				}
+				const __m512i even = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+				const __m512 scale = _mm512_loadu_ps(scales), offset = _mm512_loadu_ps(bias);
+				for (int64_t r = 0; r < R; r++)
+				{
+					//add the partial sums of each column, and gather the even lanes that hold them. 
+					const __m512i sum0 = _mm512_add_epi32(acc[r][0], _mm512_srli_epi64(acc[r][0], 32));
+					const __m512i sum1 = _mm512_add_epi32(acc[r][1], _mm512_srli_epi64(acc[r][1], 32));
+					const __m512i sum = _mm512_permutex2var_epi32(sum0, even, sum1);
+					__m512 value = _mm512_fmadd_ps(_mm512_cvtepi32_ps(sum), scale, offset);
+					_mm512_storeu_ps(y + r * y_stride, relu ? _mm512_max_ps(value, _mm512_setzero_ps()) : value);
+				}
+			}
+		};
+
+		struct AVX2F32Kernel {
+			static constexpr int64_t ColumnWidth = 1;
+			static bool Supported() { return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"); }
+			template<int64_t R>
+			__attribute__((target("avx2,fma")))
+			static void Apply(const float* x, int64_t x_stride, int64_t depth, const float* w, int64_t w_stride,
+				const float*, const int32_t*, const float* bias, float* y, int64_t y_stride, bool relu)
+			{
+				__m256 acc[R][2];
+				for (int64_t r = 0; r < R; r++)
+				{
+					acc[r][0] = _mm256_loadu_ps(bias);
+					acc[r][1] = _mm256_loadu_ps(bias + 8);
+				}
+				for (int64_t k = 0; k < depth; k++)
+				{
+					const __m256 w_k0 = _mm256_loadu_ps(w + k * w_stride);
+					const __m256 w_k1 = _mm256_loadu_ps(w + k * w_stride + 8);
+					for (int64_t r = 0; r < R; r++)
+					{
+						const __m256 x_rk = _mm256_broadcast_ss(x + r * x_stride + k);
+						acc[r][0] = _mm256_fmadd_ps(x_rk, w_k0, acc[r][0]);
+						acc[r][1] = _mm256_fmadd_ps(x_rk, w_k1, acc[r][1]);
+					}
+				}
+				for (int64_t r = 0; r < R; r++)
+				{
+					if (relu)
+					{
+						acc[r][0] = _mm256_max_ps(acc[r][0], _mm256_setzero_ps());
+						acc[r][1] = _mm256_max_ps(acc[r][1], _mm256_setzero_ps());
+					}
+					_mm256_storeu_ps(y + r * y_stride, acc[r][0]);
+					_mm256_storeu_ps(y + r * y_stride + 8, acc[r][1]);
+				}
+			}
+		};
+
+		struct AVX2BF16Kernel {
+			static constexpr int64_t ColumnWidth = 1;
+			static bool Supported() { return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"); }
+			template<int64_t R>
+			__attribute__((target("avx2,fma")))
+			static void Apply(const float* x, int64_t x_stride, int64_t depth, const uint16_t* w, int64_t w_stride,
+				const float*, const int32_t*, const float* bias, float* y, int64_t y_stride, bool relu)
+			{
+				__m256 acc[R][2];
+				for (int64_t r = 0; r < R; r++)
+				{
+					acc[r][0] = _mm256_loadu_ps(bias);
+					acc[r][1] = _mm256_loadu_ps(bias + 8);
+				}
+				for (int64_t k = 0; k < depth; k++)
+				{
+					//a bfloat16 is the upper half of a float.
+					const __m128i* w_16 = reinterpret_cast<const __m128i*>(w + k * w_stride);
+					const __m256 w_k0 = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(_mm_loadu_si128(w_16)), 16));
+					const __m256 w_k1 = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(_mm_loadu_si128(w_16 + 1)), 16));
+					for (int64_t r = 0; r < R; r++)
+					{
+						const __m256 x_rk = _mm256_broadcast_ss(x + r * x_stride + k);
+						acc[r][0] = _mm256_fmadd_ps(x_rk, w_k0, acc[r][0]);
+						acc[r][1] = _mm256_fmadd_ps(x_rk, w_k1, acc[r][1]);
+					}
+				}
+				for (int64_t r = 0; r < R; r++)
+				{
+					if (relu)
+					{
+						acc[r][0] = _mm256_max_ps(acc[r][0], _mm256_setzero_ps());
+						acc[r][1] = _mm256_max_ps(acc[r][1], _mm256_setzero_ps());
+					}
+					_mm256_storeu_ps(y + r * y_stride, acc[r][0]);
+					_mm256_storeu_ps(y + r * y_stride + 8, acc[r][1]);
+				}
+			}
+		};
+
+		struct AVX2I8Kernel {
+			static constexpr int64_t ColumnWidth = 4;
+			static bool Supported() { return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"); }
+			template<int64_t R>
+			__attribute__((target("avx2,fma")))
+			static void Apply(const int8_t* x, int64_t x_stride, int64_t depth, const int8_t* w, int64_t w_stride,
+				const float* scales, const int32_t*, const float* bias, float* y, int64_t y_stride, bool relu)
+			{
+				//acc[r][c] holds two partial sums (of two inputs each) for each of the columns 4c,...,4c+3.
+				__m256i acc[R][4];
+				for (int64_t r = 0; r < R; r++)
+					for (int64_t c = 0; c < 4; c++)
+						acc[r][c] = _mm256_setzero_si256();
+				for (int64_t p = 0; p < depth; p++)
+				{
+					const __m128i* w_p = reinterpret_cast<const __m128i*>(w + p * w_stride);
+					__m256i w_pc[4];
+					for (int64_t c = 0; c < 4; c++)
+						w_pc[c] = _mm256_cvtepi8_epi16(_mm_loadu_si128(w_p + c));
+					for (int64_t r = 0; r < R; r++)
+					{
+						const __m256i x_rp = _mm256_set1_epi64x(WidenGroup(x + r * x_stride + 4 * p));
+						for (int64_t c = 0; c < 4; c++)
+							acc[r][c] = _mm256_add_epi32(acc[r][c], _mm256_madd_epi16(x_rp, w_pc[c]));
+					}
+				}
+				for (int64_t h = 0; h < 2; h++)
+				{
+					const __m256 scale = _mm256_loadu_ps(scales + 8 * h), offset = _mm256_loadu_ps(bias + 8 * h);
+					for (int64_t r = 0; r < R; r++)
+					{
+						//hadd yields the columns in the order 0,1,4,5,2,3,6,7 (relative to 8h). 
+						const __m256i sum = _mm256_permute4x64_epi64(_mm256_hadd_epi32(acc[r][2 * h], acc[r][2 * h + 1]), _MM_SHUFFLE(3, 1, 2, 0));
+						__m256 value = _mm256_fmadd_ps(_mm256_cvtepi32_ps(sum), scale, offset);
+						if (relu)
+							value = _mm256_max_ps(value, _mm256_setzero_ps());
+						_mm256_storeu_ps(y + r * y_stride + 8 * h, value);
+					}
+				}
+			}
+		};
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#endif
+
+		//y = x * w (+ bias, etc.; see the kernels) for all rows, with stride columns. The outer loop is over strips of columns, such
+		//that a strip of the weights (depth x block_columns) is reused from cache for all rows.
+		template<typename Kernel, typename X, typename W>
+		void ForwardLayerBlocked(const X* x, int64_t x_stride, int64_t rows, int64_t depth, const W* w, const float* scales, const int32_t* offsets,
+			const float* bias, int64_t stride, float* y, bool relu)
+		{
+			const int64_t w_stride = stride * Kernel::ColumnWidth;
+			for (int64_t j0 = 0; j0 < stride; j0 += block_columns)
+			{
+				const W* w_strip = w + j0 * Kernel::ColumnWidth;
+				const float* scales_strip = scales ? scales + j0 : nullptr;
+				const int32_t* offsets_strip = offsets ? offsets + j0 : nullptr;
+				for (int64_t r0 = 0; r0 < rows; r0 += block_rows)
+				{
+					const X* x_block = x + r0 * x_stride;
+					float* y_block = y + r0 * stride + j0;
+					switch (std::min(block_rows, rows - r0))
+					{
+					case 4: Kernel::template Apply<4>(x_block, x_stride, depth, w_strip, w_stride, scales_strip, offsets_strip, bias + j0, y_block, stride, relu); break;
+					case 3: Kernel::template Apply<3>(x_block, x_stride, depth, w_strip, w_stride, scales_strip, offsets_strip, bias + j0, y_block, stride, relu); break;
+					case 2: Kernel::template Apply<2>(x_block, x_stride, depth, w_strip, w_stride, scales_strip, offsets_strip, bias + j0, y_block, stride, relu); break;
+					default: Kernel::template Apply<1>(x_block, x_stride, depth, w_strip, w_stride, scales_strip, offsets_strip, bias + j0, y_block, stride, relu); break;
+					}
+				}
+			}
+		}
+
+		//evaluates the layer with the first of the kernels that the processor supports; the last kernel should be portable.
+		template<typename X, typename W, typename Kernel, typename... Fallbacks>
+		void ForwardLayer(const X* x, int64_t x_stride, int64_t rows, int64_t depth, const W* w, const float* scales, const int32_t* offsets,
+			const float* bias, int64_t stride, float* y, bool relu)
+		{
+			if constexpr (sizeof...(Fallbacks) > 0)
+			{
+				static const bool supported = Kernel::Supported();
+				if (!supported)
+					return ForwardLayer<X, W, Fallbacks...>(x, x_stride, rows, depth, w, scales, offsets, bias, stride, y, relu);
+			}
+			ForwardLayerBlocked<Kernel>(x, x_stride, rows, depth, w, scales, offsets, bias, stride, y, relu);
+		}
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+		constexpr auto ForwardF32 = ForwardLayer<float, float, AVX512F32Kernel, AVX2F32Kernel, PortableF32Kernel>;
+		constexpr auto ForwardBF16 = ForwardLayer<float, uint16_t, AVX512BF16Kernel, AVX2BF16Kernel, PortableBF16Kernel>;
+		constexpr auto ForwardI8 = ForwardLayer<int8_t, int8_t, AVX512VNNII8Kernel, AVX512I8Kernel, AVX2I8Kernel, PortableI8Kernel>;
+#else
+		constexpr auto ForwardF32 = ForwardLayer<float, float, PortableF32Kernel>;
+		constexpr auto ForwardBF16 = ForwardLayer<float, uint16_t, PortableBF16Kernel>;
+		constexpr auto ForwardI8 = ForwardLayer<int8_t, int8_t, PortableI8Kernel>;
+#endif
+	}
+
+	MLPEngine::MLPEngine(const std::vector<Layer>& layers)
+	{
+		if (layers.empty())
+			throw DynaPlex::Error("MLPEngine: network should have at least one layer.");
+		for (size_t l = 0; l < layers.size(); l++)
+		{
+			const auto& layer = layers[l];
+			if (layer.num_inputs < 1 || layer.num_outputs < 1
+				|| static_cast<int64_t>(layer.weights.size()) != layer.num_inputs * layer.num_outputs
+				|| static_cast<int64_t>(layer.bias.size()) != layer.num_outputs)
+				throw DynaPlex::Error("MLPEngine: layer " + std::to_string(l) + " has inconsistent sizes.");
+			if (l > 0 && layer.num_inputs != layers[l - 1].num_outputs)
+				throw DynaPlex::Error("MLPEngine: inputs of layer " + std::to_string(l) + " do not match the outputs of the previous layer.");
+
+			int64_t stride = (layer.num_outputs + block_columns - 1) / block_columns * block_columns;
+			PackedLayer packed{ layer.num_inputs, layer.num_outputs, stride,
+				std::vector<float>(layer.num_inputs * stride, 0.0f), std::vector<float>(stride, 0.0f) };
+			for (int64_t o = 0; o < layer.num_outputs; o++)
+				for (int64_t i = 0; i < layer.num_inputs; i++)
+					packed.weights[i * stride + o] = layer.weights[o * layer.num_inputs + i];
+			std::copy(layer.bias.begin(), layer.bias.end(), packed.bias.begin());
+			this->layers.push_back(std::move(packed));
+		}
+	}
+
+	std::vector<MLPEngine::Layer> MLPEngine::Layers() const
+	{
+		std::vector<Layer> result;
+		for (const auto& packed : layers)
+		{
+			Layer layer{ packed.num_inputs, packed.num_outputs, std::vector<float>(packed.num_inputs * packed.num_outputs),
+				std::vector<float>(packed.bias.begin(), packed.bias.begin() + packed.num_outputs) };
+			for (int64_t o = 0; o < packed.num_outputs; o++)
+				for (int64_t i = 0; i < packed.num_inputs; i++)
+					layer.weights[o * packed.num_inputs + i] = packed.weights[i * packed.stride + o];
+			result.push_back(std::move(layer));
+		}
+		return result;
+	}
+
+	void MLPEngine::Save(const std::string& path) const
+	{
+		Header header{};
+		std::memcpy(header.magic, Magic, sizeof(Magic));
+		header.version = Version;
+		header.num_layers = static_cast<uint32_t>(layers.size());
+
+		std::ofstream out(path, std::ios::binary | std::ios::trunc);
+		if (!out)
+			throw DynaPlex::Error("MLPEngine::Save - cannot open " + path + " for writing.");
+		out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+		for (const auto& layer : Layers())
+		{
+			out.write(reinterpret_cast<const char*>(&layer.num_inputs), sizeof(int64_t));
+			out.write(reinterpret_cast<const char*>(&layer.num_outputs), sizeof(int64_t));
+			out.write(reinterpret_cast<const char*>(layer.weights.data()), static_cast<std::streamsize>(layer.weights.size() * sizeof(float)));
+			out.write(reinterpret_cast<const char*>(layer.bias.data()), static_cast<std::streamsize>(layer.bias.size() * sizeof(float)));
+		}
+		if (!out)
+			throw DynaPlex::Error("MLPEngine::Save - error while writing " + path);
+	}
+
+	MLPEngine MLPEngine::Load(const std::string& path)
+	{
+		std::ifstream in(path, std::ios::binary);
+		if (!in)
+			throw DynaPlex::Error("MLPEngine::Load - cannot open " + path);
+		Header header;
+		if (!in.read(reinterpret_cast<char*>(&header), sizeof(Header)) || std::memcmp(header.magic, Magic, sizeof(Magic)) != 0)
+			throw DynaPlex::Error("MLPEngine::Load - " + path + " is not a network file.");
+		if (header.version != Version)
+			throw DynaPlex::Error("MLPEngine::Load - " + path + " has version " + std::to_string(header.version) + ", only version " + std::to_string(Version) + " is supported.");
+
+		//bounds the sizes that are read from the file, such that a corrupt file does not lead to huge allocations.
+		in.seekg(0, std::ios::end);
+		int64_t remaining = static_cast<int64_t>(in.tellg()) - static_cast<int64_t>(sizeof(Header));
+		in.seekg(sizeof(Header), std::ios::beg);
+
+		std::vector<Layer> layers(header.num_layers);
+		for (auto& layer : layers)
+		{
+			if (!in.read(reinterpret_cast<char*>(&layer.num_inputs), sizeof(int64_t)) || !in.read(reinterpret_cast<char*>(&layer.num_outputs), sizeof(int64_t)))
+				throw DynaPlex::Error("MLPEngine::Load - " + path + " is truncated or corrupt.");
+			remaining -= 2 * static_cast<int64_t>(sizeof(int64_t));
+			if (layer.num_inputs < 1 || layer.num_outputs < 1 || layer.num_inputs >= remaining
+				|| layer.num_outputs > remaining / static_cast<int64_t>(sizeof(float)) / (layer.num_inputs + 1))
+				throw DynaPlex::Error("MLPEngine::Load - " + path + " is truncated or corrupt.");
+			remaining -= (layer.num_inputs + 1) * layer.num_outputs * static_cast<int64_t>(sizeof(float));
+			layer.weights.resize(layer.num_inputs * layer.num_outputs);
+			layer.bias.resize(layer.num_outputs);
+			in.read(reinterpret_cast<char*>(layer.weights.data()), static_cast<std::streamsize>(layer.weights.size() * sizeof(float)));
+			in.read(reinterpret_cast<char*>(layer.bias.data()), static_cast<std::streamsize>(layer.bias.size() * sizeof(float)));
+			if (!in)
+				throw DynaPlex::Error("MLPEngine::Load - " + path + " is truncated or corrupt.");
+		}
+		return MLPEngine(layers);
+	}
+
+	MLPEngine::Precision MLPEngine::PrecisionFromString(const std::string& precision)
+	{
+		if (precision == "float32")
+			return Precision::Float32;
+		if (precision == "bf16")
+			return Precision::BFloat16;
+		if (precision == "int8")
+			return Precision::Int8;
+		throw DynaPlex::Error("MLPEngine: precision is: " + precision + ". Supported precisions are \"float32\", \"bf16\" and \"int8\".");
+	}
+
+	std::string MLPEngine::ToString(Precision precision)
+	{
+		switch (precision)
+		{
+		case Precision::BFloat16: return "bf16";
+		case Precision::Int8: return "int8";
+		default: return "float32";
+		}
+	}
+
+	void MLPEngine::SetPrecision(Precision precision, const std::vector<float>& input_ranges)
+	{
+		if (precision == Precision::Int8 && input_ranges.size() != layers.size())
+			throw DynaPlex::Error("MLPEngine::SetPrecision - Int8 requires an input range for every layer, see InputRanges.");
+		for (size_t l = 0; l < layers.size(); l++)
+		{
+			auto& layer = layers[l];
+			layer.bf16_weights.clear();
+			layer.int8_weights.clear();
+			layer.int8_scales.clear();
+			layer.int8_offsets.clear();
+			if (precision == Precision::BFloat16)
+			{
+				layer.bf16_weights.resize(layer.weights.size());
+				std::transform(layer.weights.begin(), layer.weights.end(), layer.bf16_weights.begin(), ToBFloat16);
+			}
+			else if (precision == Precision::Int8)
+			{
+				if (!std::isfinite(input_ranges[l]) || input_ranges[l] < 0.0f)
+					throw DynaPlex::Error("MLPEngine::SetPrecision - input ranges should be finite and non-negative.");
+				layer.input_scale = input_ranges[l] > 0.0f ? input_ranges[l] / 127.0f : 1.0f;
+				int64_t groups = (layer.num_inputs + 3) / 4;
+				layer.int8_weights.assign(groups * layer.stride * 4, 0);
+				layer.int8_scales.assign(layer.stride, 0.0f);
+				layer.int8_offsets.assign(layer.stride, 0);
+				for (int64_t o = 0; o < layer.num_outputs; o++)
+				{
+					float max_abs = 0.0f;
+					for (int64_t i = 0; i < layer.num_inputs; i++)
+						max_abs = std::max(max_abs, std::abs(layer.weights[i * layer.stride + o]));
+					float weight_scale = max_abs > 0.0f ? max_abs / 127.0f : 1.0f;
+					layer.int8_scales[o] = weight_scale * layer.input_scale;
+					for (int64_t i = 0; i < layer.num_inputs; i++)
+					{
+						auto weight = static_cast<int8_t>(std::clamp(std::nearbyint(layer.weights[i * layer.stride + o] / weight_scale), -127.0f, 127.0f));
+						layer.int8_weights[(i / 4) * layer.stride * 4 + o * 4 + i % 4] = weight;
+						layer.int8_offsets[o] -= 128 * weight;
+					}
+				}
+			}
+		}
+		this->precision = precision;
+	}
+
+	std::vector<float> MLPEngine::InputRanges(std::span<const float> inputs, int64_t rows) const
+	{
+		if (rows < 0 || static_cast<int64_t>(inputs.size()) != rows * NumInputs())
+			throw DynaPlex::Error("MLPEngine::InputRanges - inputs should have rows x NumInputs() entries.");
+		std::vector<float> ranges;
+		std::vector<float> current, next;
+		const float* x = inputs.data();
+		int64_t x_stride = NumInputs();
+		for (size_t l = 0; l < layers.size(); l++)
+		{
+			const auto& layer = layers[l];
+			float range = 0.0f;
+			for (int64_t r = 0; r < rows; r++)
+				for (int64_t i = 0; i < layer.num_inputs; i++)
+					range = std::max(range, std::abs(x[r * x_stride + i]));
+			ranges.push_back(range);
+			if (l + 1 == layers.size())
+				break;
+			next.resize(rows * layer.stride);
+			ForwardF32(x, x_stride, rows, layer.num_inputs, layer.weights.data(), nullptr, nullptr, layer.bias.data(), layer.stride, next.data(), true);
+			std::swap(current, next);
+			x = current.data();
+			x_stride = layer.stride;
+		}
+		return ranges;
+	}
+
+	void MLPEngine::Forward(std::span<const float> inputs, int64_t rows, std::span<float> outputs) const
+	{
+		if (rows < 0 || static_cast<int64_t>(inputs.size()) != rows * NumInputs() || static_cast<int64_t>(outputs.size()) != rows * NumOutputs())
+			throw DynaPlex::Error("MLPEngine::Forward - inputs should have rows x NumInputs() entries, and outputs rows x NumOutputs() entries.");
+
+		//activations of consecutive layers alternate between two buffers; rows are padded to the stride of their layer.
+		std::vector<float> current, next;
+		//with Int8, the inputs of a layer are quantized first, with the number of inputs padded to groups of four. 
+		std::vector<int8_t> quantized;
+		const float* x = inputs.data();
+		int64_t x_stride = NumInputs();
+		for (size_t l = 0; l < layers.size(); l++)
+		{
+			const auto& layer = layers[l];
+			next.resize(rows * layer.stride);
+			bool relu = l + 1 < layers.size();
+			switch (precision)
+			{
+			case Precision::Float32:
+				ForwardF32(x, x_stride, rows, layer.num_inputs, layer.weights.data(), nullptr, nullptr, layer.bias.data(), layer.stride, next.data(), relu);
+				break;
+			case Precision::BFloat16:
+				ForwardBF16(x, x_stride, rows, layer.num_inputs, layer.bf16_weights.data(), nullptr, nullptr, layer.bias.data(), layer.stride, next.data(), relu);
+				break;
+			case Precision::Int8:
+			{
+				int64_t groups = (layer.num_inputs + 3) / 4;
+				quantized.assign(rows * 4 * groups, 0);
+				const float inverse_scale = 1.0f / layer.input_scale;
+				for (int64_t r = 0; r < rows; r++)
+					for (int64_t i = 0; i < layer.num_inputs; i++)
+						quantized[r * 4 * groups + i] = static_cast<int8_t>(std::clamp(std::nearbyint(x[r * x_stride + i] * inverse_scale), -127.0f, 127.0f));
+				ForwardI8(quantized.data(), 4 * groups, rows, groups, layer.int8_weights.data(), layer.int8_scales.data(), layer.int8_offsets.data(),
+					layer.bias.data(), layer.stride, next.data(), relu);
+				break;
+			}
+			}
+			std::swap(current, next);
+			x = current.data();
+			x_stride = layer.stride;
+		}
+		for (int64_t r = 0; r < rows; r++)
+			std::copy_n(x + r * x_stride, NumOutputs(), outputs.begin() + r * NumOutputs());
+	}
+}
@@ -1,5 +1,6 @@
 #include "nn_policy.h"
 #include "dynaplex/system.h"
+#include <algorithm>
 #if DP_TORCH_AVAILABLE
 #include <torch/torch.h>
 #endif
@@ -18,7 +19,58 @@ namespace DynaPlex {
 		return policy_config;
 	}
 
+	void NN_Policy::EnableBatching(const DynaPlex::VarGroup& config) {
+		if (fw_type == NetworkForwardType::TensorDictMask)
+			throw DynaPlex::Error("NN_Policy::EnableBatching - not supported for networks that take a mask as input.");
+		batching_service = std::make_unique<DynaPlex::NN::BatchingService>(
+			[this](std::span<const float> features, int64_t rows, std::span<float> scores) { Forward(features, rows, scores); },
+			mdp->NumFlatFeatures(), mdp->NumValidActions(), config);
+	}
+
+	void NN_Policy::Forward(std::span<const float> features, int64_t rows, std::span<float> scores) const {
+		if (native_network)
+		{
+			native_network->Forward(features, rows, scores);
+			return;
+		}
+#if DP_TORCH_AVAILABLE
+		torch::NoGradGuard no_grad;
+		//the tensor refers to features without copying; forward does not modify its inputs.
+		torch::Tensor batched_inputs = torch::from_blob(const_cast<float*>(features.data()), { rows, mdp->NumFlatFeatures() }, torch::kFloat32);
+		torch::Tensor output_scores;
+		if (fw_type == NetworkForwardType::Tensor)
+			output_scores = neural_network->forward(batched_inputs);
+		else
+		{
+			torch::Dict<std::string, torch::Tensor> dict;
+			dict.insert("obs", batched_inputs);
+			output_scores = neural_network->forward(dict);
+		}
+		output_scores = output_scores.contiguous();
+		std::copy_n(output_scores.data_ptr<float>(), scores.size(), scores.begin());
+#else
+		throw DynaPlex::Error("NN_Policy: Torch not available - Cannot evaluate network.");
+#endif
+	}
+
 	void NN_Policy::SetAction(std::span<Trajectory> trajectories) const {
+		if (batching_service)
+		{//features are computed on the calling thread, the forward pass is shared with other threads.
+			std::vector<float> features(trajectories.size() * mdp->NumFlatFeatures());
+			mdp->GetFlatFeatures(trajectories, features);
+			auto scores = batching_service->Submit(std::move(features)).get();
+			mdp->SetArgMaxAction(trajectories, scores);
+			return;
+		}
+		if (native_network)
+		{
+			std::vector<float> features(trajectories.size() * mdp->NumFlatFeatures());
+			mdp->GetFlatFeatures(trajectories, features);
+			std::vector<float> scores(trajectories.size() * mdp->NumValidActions());
+			native_network->Forward(features, static_cast<int64_t>(trajectories.size()), scores);
+			mdp->SetArgMaxAction(trajectories, scores);
+			return;
+		}
 #if DP_TORCH_AVAILABLE
 		int64_t input_dim = mdp->NumFlatFeatures();
 		int64_t output_dim = mdp->NumValidActions();
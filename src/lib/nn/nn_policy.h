@@ -2,6 +2,8 @@
 #include "dynaplex/mdp.h"
 #include "dynaplex/policy.h"
 #include "neuralnetworkprovider.h"
+#include "dynaplex/batchingservice.h"
+#include "dynaplex/mlpengine.h"
 
 
 // Forward declarations
@@ -30,6 +32,8 @@ namespace DynaPlex {
 #if DP_TORCH_AVAILABLE
         std::unique_ptr<torch::nn::AnyModule> neural_network;
 #endif
+        //if set, evaluates the network instead of neural_network, without torch. 
+        std::unique_ptr<DynaPlex::NN::MLPEngine> native_network;
         DynaPlex::VarGroup policy_config;
         NN_Policy(DynaPlex::MDP mdp);
 
@@ -39,6 +43,18 @@ namespace DynaPlex {
 
         void SetAction(std::span<Trajectory> trajectories) const override;
 
+        /**
+         * Lets concurrent calls to SetAction share forward passes through a DynaPlex::NN::BatchingService, configured with config
+         * (max_batch_size, max_latency_us). Not supported for NetworkForwardType::TensorDictMask. 
+         */
+        void EnableBatching(const DynaPlex::VarGroup& config);
+
+    private:
+        //evaluates the network on rows x NumFlatFeatures() features. 
+        void Forward(std::span<const float> features, int64_t rows, std::span<float> scores) const;
+        //declared last, such that the service thread stops before the network is destroyed. 
+        std::unique_ptr<DynaPlex::NN::BatchingService> batching_service;
+
 
     };
 
@@ -1,11 +1,18 @@
 #include "dynaplex/policytrainer.h"
 #if DP_TORCH_AVAILABLE
 #include <torch/torch.h>
+#include <ATen/CPUGeneratorImpl.h>
 #include "nn_policy.h"
 #endif
 #include "dynaplex/trainedpolicyprovider.h"
 #include "neuralnetworkprovider.h"
+#include "dynaplex/samplefile.h"
+#include "dynaplex/prefetcher.h"
+#include "dynaplex/mlpengine.h"
 #include <algorithm>
+#include <filesystem>
+#include <future>
+#include <numeric>
 
 namespace DynaPlex::NN {
 
@@ -22,14 +29,34 @@ namespace DynaPlex::NN {
         training_config.GetOrDefault("early_stopping_patience", early_stopping_patience, 10);
         training_config.GetOrDefault("max_training_epochs", max_training_epochs, 1000);        
         training_config.GetOrDefault("train_based_on_probs", train_based_on_probs, false);
+        //by default, the tensors of all samples are computed once; set to false to save memory on large sample sets. 
+        training_config.GetOrDefault("cache_tensors", cache_tensors, true);
+        //mini-batches that are prepared ahead on background threads while the optimizer runs; 0 to prepare them inline. 
+        training_config.GetOrDefault("prefetch_batches", prefetch_batches, 4);
+        training_config.GetOrDefault("prefetch_threads", prefetch_threads, 1);
+        if (prefetch_batches < 0 || prefetch_threads < 1)
+            throw DynaPlex::Error("PolicyTrainer: prefetch_batches should be non-negative, and prefetch_threads positive.");
+        //whether validation runs on a copy of the weights while training continues. Training reaches the same weights either way. 
+        training_config.GetOrDefault("parallel_validation", parallel_validation, false);
+        //whether all processes train, each on its share of the mini-batches, with gradients averaged over the processes. Every process
+        //still loads (and caches) all samples. 
+        training_config.GetOrDefault("data_parallel", data_parallel, false);
+        if (data_parallel && !system.SupportsAllReduce())
+            throw DynaPlex::Error("PolicyTrainer: data_parallel requires a message-passing implementation (MPI) when WorldSize() > 1.");
+        //samples on which QuantizePolicy calibrates int8 inputs. 
+        training_config.GetOrDefault("calibration_samples", calibration_samples, 4096);
+        if (calibration_samples < 1)
+            throw DynaPlex::Error("PolicyTrainer: calibration_samples should be positive.");
 #if DP_TORCH_AVAILABLE
         torch::manual_seed(static_cast<uint64_t>(rng_seed));
 #endif
 
     }
 #if DP_TORCH_AVAILABLE
-    std::tuple<torch::Tensor, torch::Tensor, torch::Tensor, torch::Tensor, torch::Tensor> prepare_batch(const std::span<DynaPlex::NN::Sample> samples, const DynaPlex::MDP& mdp) {
-        int batch_size = samples.size();
+    using Batch = std::tuple<torch::Tensor, torch::Tensor, torch::Tensor, torch::Tensor, torch::Tensor>;
+
+    Batch prepare_batch(const std::span<const DynaPlex::NN::Sample> all_samples, std::span<const int64_t> indices, const DynaPlex::MDP& mdp) {
+        int batch_size = indices.size();
         int input_dim = mdp->NumFlatFeatures();
         int output_dim = mdp->NumValidActions();
 
@@ -46,7 +73,7 @@ namespace DynaPlex::NN {
         float* probs_ptr = batched_probs.data_ptr<float>();
 
         for (int idx = 0; idx < batch_size; idx++) {
-            const auto& sample = samples[idx];
+            const auto& sample = all_samples[indices[idx]];
 
             std::span<float> span(input_data_ptr + idx * input_dim, input_dim);
             mdp->GetFlatFeatures(sample.state, span);
@@ -69,21 +96,145 @@ namespace DynaPlex::NN {
 
         return { batched_inputs, batched_targets, mask, batched_probs, batched_relative_costs };
     }
+
+    //as above, but copies the rows directly from the columns of the (memory-mapped) sample file.
+    Batch prepare_batch(const SampleFile& file, std::span<const int64_t> indices) {
+        int batch_size = indices.size();
+        int input_dim = file.NumFeatures();
+        int output_dim = file.NumValidActions();
+
+        torch::Tensor batched_inputs = torch::empty({ batch_size, input_dim }, torch::kFloat32);
+        torch::Tensor batched_targets = torch::empty({ batch_size }, torch::kInt64);
+        torch::Tensor batched_probs = torch::empty({ batch_size, output_dim }, torch::kFloat32);
+        torch::Tensor batched_relative_costs = torch::empty({ batch_size, output_dim }, torch::kFloat32);
+        torch::Tensor mask = torch::empty({ batch_size, output_dim }, torch::kFloat32);
+
+        float* input_data_ptr = batched_inputs.data_ptr<float>();
+        int64_t* target_data_ptr = batched_targets.data_ptr<int64_t>();
+        float* mask_ptr = mask.data_ptr<float>();
+        float* cost_ptr = batched_relative_costs.data_ptr<float>();
+        float* probs_ptr = batched_probs.data_ptr<float>();
+
+        auto features = file.Features();
+        auto allowed = file.Mask();
+        auto probabilities = file.Probabilities();
+        auto costs = file.CostImprovement();
+        auto labels = file.ActionLabels();
+        for (int idx = 0; idx < batch_size; idx++) {
+            int64_t row = indices[idx];
+            std::copy_n(features.data() + row * input_dim, input_dim, input_data_ptr + idx * input_dim);
+            std::copy_n(probabilities.data() + row * output_dim, output_dim, probs_ptr + idx * output_dim);
+            target_data_ptr[idx] = labels[row];
+            for (int action = 0; action < output_dim; action++) {
+                //same conventions as for the overload above: disallowed actions get mask and cost 32.0. 
+                bool is_allowed = allowed[row * output_dim + action] != 0.0f;
+                mask_ptr[idx * output_dim + action] = is_allowed ? 0.0f : 32.0f;
+                cost_ptr[idx * output_dim + action] = is_allowed ? costs[row * output_dim + action] : 32.0f;
+            }
+        }
+
+        return { batched_inputs, batched_targets, mask, batched_probs, batched_relative_costs };
+    }
 #endif
-    DynaPlex::Policy PolicyTrainer::LoadPolicy(DynaPlex::VarGroup nn_architecture, int64_t generation) {
-#if DP_TORCH_AVAILABLE
-        return TrainedPolicyProvider::LoadPolicy(mdp, PathToPolicy(nn_architecture, generation));
-#else
-        throw DynaPlex::Error("PolicyTrainer::LoadPolicy - Torch not available, cannot load policy. To make torch available, set dynaplex_enable_pytorch to true and dynaplex_pytorch_path to an appropriate path, e.g. in CMakeUserPresets.txt ");
-#endif
+    DynaPlex::Policy PolicyTrainer::LoadPolicy(DynaPlex::VarGroup nn_architecture, int64_t generation, const DynaPlex::VarGroup& inference_config) {
+        //without torch, mlp policies are evaluated natively. 
+        std::string precision;
+        inference_config.GetOrDefault("precision", precision, "float32");
+        auto path = PathToPolicy(nn_architecture, generation);
+        if (MLPEngine::PrecisionFromString(precision) != MLPEngine::Precision::Float32)
+            path += "_" + precision;
+        return TrainedPolicyProvider::LoadPolicy(mdp, path, inference_config);
+    }
+
+    DynaPlex::VarGroup PolicyTrainer::QuantizePolicy(DynaPlex::VarGroup nn_architecture, int64_t generation, std::string path_to_sample_data, const std::string& precision, bool silent) {
+        auto precision_type = MLPEngine::PrecisionFromString(precision);
+        if (precision_type == MLPEngine::Precision::Float32)
+            throw DynaPlex::Error("PolicyTrainer::QuantizePolicy - precision should be \"bf16\" or \"int8\".");
+        auto path = PathToPolicy(nn_architecture, generation);
+        auto path_to_native_weights = System::SetFileExtension(path, "mlp");
+        if (!std::filesystem::exists(path_to_native_weights))
+            throw DynaPlex::Error("PolicyTrainer::QuantizePolicy - cannot find " + path_to_native_weights + "; only mlp policies can be quantized.");
+        auto policy_config = VarGroup::LoadFromFile(System::SetFileExtension(path, "json"));
+        auto reference = MLPEngine::Load(path_to_native_weights);
+        int64_t num_inputs = mdp->NumFlatFeatures();
+        int64_t num_outputs = mdp->NumValidActions();
+        if (reference.NumInputs() != num_inputs || reference.NumOutputs() != num_outputs)
+            throw DynaPlex::Error("PolicyTrainer::QuantizePolicy - policy in " + path + " does not match the mdp.");
+
+        //features of all samples, and which actions are allowed. 
+        std::vector<float> features;
+        std::vector<uint8_t> allowed;
+        if (SampleFile::IsSampleFile(path_to_sample_data)) {
+            SampleFile file(mdp, path_to_sample_data);
+            features.assign(file.Features().begin(), file.Features().end());
+            for (float mask : file.Mask())
+                allowed.push_back(mask != 0.0f);
+        }
+        else {
+            SampleData data{ mdp };
+            data.AddFromFile(mdp, path_to_sample_data);
+            features.resize(data.Samples.size() * num_inputs);
+            allowed.resize(data.Samples.size() * num_outputs);
+            for (size_t i = 0; i < data.Samples.size(); i++) {
+                mdp->GetFlatFeatures(data.Samples[i].state, std::span<float>(features.data() + i * num_inputs, num_inputs));
+                for (int64_t action = 0; action < num_outputs; action++)
+                    allowed[i * num_outputs + action] = mdp->IsAllowedAction(data.Samples[i].state, action);
+            }
+        }
+        int64_t num_samples = static_cast<int64_t>(features.size()) / num_inputs;
+        if (num_samples == 0)
+            throw DynaPlex::Error("PolicyTrainer::QuantizePolicy - no samples in " + path_to_sample_data + ".");
+
+        MLPEngine quantized = reference;
+        std::vector<float> input_ranges;
+        if (precision_type == MLPEngine::Precision::Int8) {
+            int64_t calibration_rows = std::min(num_samples, calibration_samples);
+            input_ranges = reference.InputRanges(std::span<const float>(features.data(), calibration_rows * num_inputs), calibration_rows);
+        }
+        quantized.SetPrecision(precision_type, input_ranges);
+
+        //both policies take the allowed action with the highest score. 
+        std::vector<float> reference_scores(num_samples * num_outputs), quantized_scores(num_samples * num_outputs);
+        reference.Forward(features, num_samples, reference_scores);
+        quantized.Forward(features, num_samples, quantized_scores);
+        auto best_action = [&](const std::vector<float>& scores, int64_t row) {
+            int64_t best = -1;
+            for (int64_t action = 0; action < num_outputs; action++)
+                if (allowed[row * num_outputs + action] && (best < 0 || scores[row * num_outputs + action] > scores[row * num_outputs + best]))
+                    best = action;
+            return best;
+        };
+        int64_t agreeing = 0;
+        for (int64_t row = 0; row < num_samples; row++)
+            if (best_action(reference_scores, row) == best_action(quantized_scores, row))
+                agreeing++;
+        double action_agreement = static_cast<double>(agreeing) / static_cast<double>(num_samples);
+
+        DynaPlex::VarGroup quantization{ {"precision", precision},
+            {"input_ranges", DynaPlex::VarGroup::DoubleVec(input_ranges.begin(), input_ranges.end())},
+            {"action_agreement", action_agreement} };
+        policy_config.Add("quantization", quantization);
+        auto quantized_path = path + "_" + precision;
+        quantized.Save(System::SetFileExtension(quantized_path, "mlp"));
+        policy_config.SaveToFile(System::SetFileExtension(quantized_path, "json"), 1);
+        if (!silent)
+            system << "quantized policy of generation " << generation << " to " << precision << "; selects the same action as float32 on "
+            << 100.0 * action_agreement << "% of " << num_samples << " samples." << std::endl;
+        return quantization;
     }
     	
 	void PolicyTrainer::TrainPolicy(DynaPlex::VarGroup nn_architecture, int64_t generation, std::string path_to_sample_data, bool silent) {
 		NeuralNetworkProvider provider(mdp);
+        //binary sample files are memory-mapped, json sample files are parsed into states. 
+        std::unique_ptr<SampleFile> sample_file;
         SampleData data{ mdp };
-        data.AddFromFile(mdp, path_to_sample_data);
+        if (SampleFile::IsSampleFile(path_to_sample_data))
+            sample_file = std::make_unique<SampleFile>(mdp, path_to_sample_data);
+        else
+            data.AddFromFile(mdp, path_to_sample_data);
+        int64_t num_samples = sample_file ? sample_file->NumSamples() : static_cast<int64_t>(data.Samples.size());
         if (!silent)
-            system << "loaded " << data.Samples.size() << " samples from " << path_to_sample_data << std::endl;
+            system << "loaded " << num_samples << " samples from " << path_to_sample_data << std::endl;
 
 #if DP_TORCH_AVAILABLE
         auto any_module = provider.GetTrainableNN(nn_architecture);
@@ -93,25 +244,83 @@ namespace DynaPlex::NN {
          // Set up the optimizer (for example, Adam optimizer).
       
         torch::optim::Adam optimizer(any_module_as_nn_module->parameters(), torch::optim::AdamOptions(1e-3).betas({ 0.9,0.999 }).weight_decay(0.0));
+
+        //with data_parallel, every process (shard) trains on every num_shards-th mini-batch of an epoch. Process 0 validates,
+        //keeps the best weights and decides on early stopping, like it does when it trains alone. 
+        int64_t num_shards = data_parallel ? system.WorldSize() : 1;
+        int64_t shard = data_parallel ? system.WorldRank() : 0;
+        bool validates = shard == 0;
+
+        //replaces the tensors (of type float) by their average over all processes. 
+        auto average_over_shards = [&](const std::vector<torch::Tensor>& tensors) {
+            torch::NoGradGuard no_grad;
+            std::vector<torch::Tensor> flat_tensors;
+            for (auto& tensor : tensors)
+                flat_tensors.push_back(tensor.reshape(-1));
+            torch::Tensor flat = torch::cat(flat_tensors).contiguous();
+            system.AllReduceSum(std::span<float>(flat.data_ptr<float>(), flat.numel()));
+            flat.div_(static_cast<float>(num_shards));
+            int64_t offset = 0;
+            for (auto& tensor : tensors) {
+                tensor.copy_(flat.narrow(0, offset, tensor.numel()).view_as(tensor));
+                offset += tensor.numel();
+            }
+        };
+        //all processes start from the same weights.
+        if (num_shards > 1)
+            average_over_shards(any_module_as_nn_module->parameters());
             
-        int64_t validation_size = std::max(static_cast<int64_t>(0.05 * data.Samples.size()), static_cast<int64_t>(1));
-        int64_t training_size = static_cast<int64_t>(data.Samples.size()) - validation_size;
+        int64_t validation_size = std::max(static_cast<int64_t>(0.05 * num_samples), static_cast<int64_t>(1));
+        int64_t training_size = num_samples - validation_size;
         
-        // Ensure we have at least one mini-batch of training data and one sample of test data
-        if (training_size < mini_batch_size || training_size < 0) {
-            throw DynaPlex::Error("PolicyTrainer::TrainPolicy - Insufficient data samples for training and validation: " + std::to_string(data.Samples.size()));
+        // Ensure we have at least one mini-batch of training data (per process) and one sample of test data
+        if (training_size < mini_batch_size * num_shards || training_size < 0) {
+            throw DynaPlex::Error("PolicyTrainer::TrainPolicy - Insufficient data samples for training and validation: " + std::to_string(num_samples));
         }
         
-        // Round the training data down to a multiple of the mini_batch_size
-        training_size = (training_size / mini_batch_size) * mini_batch_size;
+        // Round the training data down to a multiple of the mini_batch_size (times the number of processes)
+        training_size = (training_size / (mini_batch_size * num_shards)) * (mini_batch_size * num_shards);
+
+        //with cache_tensors, features, masks and targets of all samples are computed once, and mini-batches are gathered from them by index. 
+        Batch cache;
+        if (cache_tensors)
+        {
+            std::vector<int64_t> all_samples(num_samples);
+            std::iota(all_samples.begin(), all_samples.end(), 0);
+            if (sample_file)
+                cache = prepare_batch(*sample_file, all_samples);
+            else
+                cache = prepare_batch(data.Samples, all_samples, mdp);
+            //the states and the file are no longer needed.
+            data.Samples.clear();
+            sample_file.reset();
+        }
+
+        auto get_batch = [&](std::span<const int64_t> indices) -> Batch {
+            if (cache_tensors)
+            {
+                auto index = torch::from_blob(const_cast<int64_t*>(indices.data()), { static_cast<int64_t>(indices.size()) }, torch::kInt64);
+                auto& [inputs, targets, mask, probs, relative_costs] = cache;
+                return { inputs.index_select(0, index), targets.index_select(0, index), mask.index_select(0, index),
+                    probs.index_select(0, index), relative_costs.index_select(0, index) };
+            }
+            if (sample_file)
+                return prepare_batch(*sample_file, indices);
+            else
+                return prepare_batch(data.Samples, indices, mdp);
+        };
 
+        //samples are shuffled through their indices. 
+        std::vector<int64_t> order(num_samples);
+        std::iota(order.begin(), order.end(), 0);
         DynaPlex::RNG rng{false, 26071983 };
-        std::shuffle(data.Samples.begin(), data.Samples.end(), rng.gen());
-        std::span<DynaPlex::NN::Sample> training_data(data.Samples.begin(), data.Samples.begin() + training_size);
-        std::span<DynaPlex::NN::Sample> validation_data(data.Samples.begin() + training_size, data.Samples.end());
-        auto [validation_samples, validation_targets, validation_mask, validation_probs, validation_relative_costs] = prepare_batch(validation_data, mdp);
+        std::shuffle(order.begin(), order.end(), rng.gen());
+        std::span<int64_t> training_data(order.begin(), order.begin() + training_size);
+        std::span<int64_t> validation_data(order.begin() + training_size, order.end());
+        auto [validation_samples, validation_targets, validation_mask, validation_probs, validation_relative_costs] = get_batch(validation_data);
 
-        int64_t num_batches = training_size / mini_batch_size;
+        //mini-batches per epoch of this process. 
+        int64_t num_batches = training_size / (mini_batch_size * num_shards);
         float best_validation_loss = std::numeric_limits<float>::max();
         float best_training_loss = std::numeric_limits<float>::max();
         float best_cost_improvement = std::numeric_limits<float>::max();
@@ -122,12 +331,103 @@ namespace DynaPlex::NN {
 
         auto start_time = std::chrono::steady_clock::now();
 
+        //computes the validation loss and relative cost improvement of module. 
+        auto validate = [&](torch::nn::AnyModule& module) {
+            // Disable gradient computation for validation
+            torch::NoGradGuard no_grad;
+
+            float current_validation_loss = 0.0;
+            torch::Tensor validation_output = module.forward(validation_samples) - validation_mask;
+
+            if (!train_based_on_probs) {
+                torch::Tensor validation_loss = torch::nll_loss(torch::log_softmax(validation_output, 1), validation_targets);
+                current_validation_loss = validation_loss.item<float>();
+            }
+            else {
+                torch::Tensor probs = torch::softmax(validation_output, /*dim=*/1);
+                // Compute cross-entropy loss manually for soft labels.
+                torch::Tensor validation_loss = -validation_probs * torch::log(probs + 1e-8); // Adding epsilon to avoid log(0)
+                validation_loss = validation_loss.sum(1).mean(); // Sum over classes, then average over the batch.
+                current_validation_loss = validation_loss.item<float>();
+            }
+
+            torch::Tensor costs = torch::sum(torch::softmax(validation_output / 0.001, 1) * validation_relative_costs);
+            float relative_cost_improvement = costs.item<float>() / validation_data.size();
+            return std::make_pair(current_validation_loss, relative_cost_improvement);
+        };
+
+        //keeps the weights of module if its validation loss is the best so far; returns whether training should stop early. 
+        auto conclude_validation = [&](torch::nn::AnyModule& module, int64_t validated_epoch, float average_training_loss, float current_validation_loss, float relative_cost_improvement) {
+            best_cost_improvement = std::min(best_cost_improvement, relative_cost_improvement);
+
+            // Check for improvement in validation loss
+            if (current_validation_loss < best_validation_loss) {
+                best_validation_loss = current_validation_loss;
+                training_loss = average_training_loss;
+                cost_improvement = relative_cost_improvement;
+                auto saved_model_path = system.filepath(mdp->Identifier(), "temp", "model_weights.pth");
+                torch::save(module.ptr(), saved_model_path); // Save the model weights
+                epochs_without_improvement = 0; // Reset counter
+            }
+            else {
+                epochs_without_improvement += 5;
+                if (epochs_without_improvement > early_stopping_patience) {
+                    if (!silent)
+                        system << "Early stopping after " << early_stopping_patience << " epochs without improvement." << std::endl;
+                    return true;
+                }
+            }
+
+            auto end_time = std::chrono::steady_clock::now();
+            auto elapsed_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+
+            if (!silent)
+            {
+                system << "EPOCHS: " << validated_epoch
+                    << " - Training Loss: " << average_training_loss
+                    << " (" << (int)(100 * std::exp(-average_training_loss)) << "%)"
+                    << " - Validation Loss: " << current_validation_loss
+                    << " (" << (int)(100 * std::exp(-current_validation_loss)) << "%)"
+                    << " - Cost Imp.: " << relative_cost_improvement
+                    << " Time: " << system.Elapsed(elapsed_time)
+                    << std::endl;
+            }
+            return false;
+        };
+
+        //with parallel_validation, the weights are copied into snapshot, which is validated while training continues. The snapshot
+        //is built once, and the torch generator is restored after its (random) initialization, such that training draws the same
+        //random numbers, and hence reaches the same weights, as with serial validation. 
+        torch::nn::AnyModule snapshot;
+        if (validates && parallel_validation) {
+            auto generator = at::detail::getDefaultCPUGenerator();
+            auto generator_state = generator.get_state();
+            snapshot = provider.GetTrainableNN(nn_architecture);
+            generator.set_state(generator_state);
+        }
+        //the validation of snapshot that runs while training continues. 
+        struct PendingValidation {
+            int64_t epoch;
+            float average_training_loss;
+            std::future<std::pair<float, float>> result;
+        };
+        std::unique_ptr<PendingValidation> pending;
+        auto conclude_pending = [&]() {
+            auto [current_validation_loss, relative_cost_improvement] = pending->result.get();
+            bool stop = conclude_validation(snapshot, pending->epoch, pending->average_training_loss, current_validation_loss, relative_cost_improvement);
+            pending.reset();
+            return stop;
+        };
+
         do {
             std::shuffle(training_data.begin(), training_data.end(), rng.gen());
             float total_training_loss = 0.0;
+            //the next mini-batches are gathered on background threads while the optimizer works on the current one.
+            Prefetcher<Batch> loader([&](int64_t batch) { return get_batch(training_data.subspan((batch * num_shards + shard) * mini_batch_size, mini_batch_size)); },
+                num_batches, prefetch_batches, prefetch_threads);
             for (int64_t batch = 0; batch < num_batches; batch++) {
                 optimizer.zero_grad();       
-                auto [batched_inputs, batched_targets, mask, batched_probs, _] = prepare_batch({ &training_data[batch * mini_batch_size], static_cast<size_t>(mini_batch_size) }, mdp);
+                auto [batched_inputs, batched_targets, mask, batched_probs, _] = loader.Next();
 
                 // Forward pass.
                 torch::Tensor output = any_module.forward(batched_inputs) - mask;
@@ -150,72 +450,65 @@ namespace DynaPlex::NN {
                     loss.backward();
                 }
 
+                if (num_shards > 1) {
+                    std::vector<torch::Tensor> gradients;
+                    for (auto& parameter : any_module_as_nn_module->parameters()) {
+                        if (!parameter.grad().defined())
+                            parameter.mutable_grad() = torch::zeros_like(parameter);
+                        gradients.push_back(parameter.grad());
+                    }
+                    average_over_shards(gradients);
+                }
+
                 optimizer.step();
             }
+            if (num_shards > 1) {
+                system.AllReduceSum(std::span<float>(&total_training_loss, 1));
+                total_training_loss /= num_shards;
+            }
             float average_training_loss = total_training_loss / num_batches;
             best_training_loss = std::min(average_training_loss, best_training_loss);
 
             // Reporting losses every 5 epochs
             if (epoch % 5 == 0) {
-
-                // Disable gradient computation for validation
-                torch::NoGradGuard no_grad;
-
-                float current_validation_loss = 0.0;
-                torch::Tensor validation_output = any_module.forward(validation_samples) - validation_mask;
-
-                if (!train_based_on_probs) {
-                    torch::Tensor validation_loss = torch::nll_loss(torch::log_softmax(validation_output, 1), validation_targets);
-                    current_validation_loss = validation_loss.item<float>();
+                bool stop = false;
+                if (validates && !parallel_validation) {
+                    auto [current_validation_loss, relative_cost_improvement] = validate(any_module);
+                    stop = conclude_validation(any_module, epoch, average_training_loss, current_validation_loss, relative_cost_improvement);
                 }
-                else {
-                    torch::Tensor probs = torch::softmax(validation_output, /*dim=*/1);
-                    // Compute cross-entropy loss manually for soft labels.
-                    torch::Tensor validation_loss = -validation_probs * torch::log(probs + 1e-8); // Adding epsilon to avoid log(0)
-                    validation_loss = validation_loss.sum(1).mean(); // Sum over classes, then average over the batch.
-                    current_validation_loss = validation_loss.item<float>();
+                else if (validates) {
+                    stop = pending && conclude_pending();
                 }
-
-                torch::Tensor costs = torch::sum(torch::softmax(validation_output / 0.001, 1) * validation_relative_costs);
-                auto relative_cost_improvement = costs.item<float>() / validation_data.size();
-                best_cost_improvement = std::min(best_cost_improvement, relative_cost_improvement);
-
-                // Check for improvement in validation loss
-                if (current_validation_loss < best_validation_loss) {
-                    best_validation_loss = current_validation_loss;
-                    training_loss = average_training_loss;
-                    cost_improvement = relative_cost_improvement;
-                    auto saved_model_path = system.filepath(mdp->Identifier(), "temp", "model_weights.pth");
-                    torch::save(any_module_as_nn_module, saved_model_path); // Save the model weights
-                    epochs_without_improvement = 0; // Reset counter
+                if (num_shards > 1) {
+                    //all processes follow the early-stopping decision of process 0. 
+                    float stopping = (stop || epochs_without_improvement >= early_stopping_patience) ? 1.0f : 0.0f;
+                    system.AllReduceSum(std::span<float>(&stopping, 1));
+                    if (stopping > 0.0f)
+                        epochs_without_improvement = std::max(epochs_without_improvement, early_stopping_patience);
                 }
-                else {
-                    epochs_without_improvement += 5;
-                    if (epochs_without_improvement > early_stopping_patience) {
-                        if (!silent)
-                            system << "Early stopping after " << early_stopping_patience << " epochs without improvement." << std::endl;
-                        break; // Exit the training loop
+                if (stop)
+                    break; // Exit the training loop
+                if (validates && parallel_validation) {
+                    //any earlier validation of snapshot was concluded above. 
+                    pending = std::make_unique<PendingValidation>(PendingValidation{ epoch, average_training_loss, {} });
+                    {
+                        torch::NoGradGuard no_grad;
+                        auto source = any_module_as_nn_module->parameters();
+                        auto target = snapshot.ptr()->parameters();
+                        for (size_t i = 0; i < source.size(); i++)
+                            target[i].copy_(source[i]);
+                        auto source_buffers = any_module_as_nn_module->buffers();
+                        auto target_buffers = snapshot.ptr()->buffers();
+                        for (size_t i = 0; i < source_buffers.size(); i++)
+                            target_buffers[i].copy_(source_buffers[i]);
                     }
-                }
-
-
-                auto end_time = std::chrono::steady_clock::now();
-                auto elapsed_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
-
-                if (!silent)
-                {
-                    system << "EPOCHS: " << epoch
-                        << " - Training Loss: " << average_training_loss
-                        << " (" << (int)(100 * std::exp(-average_training_loss)) << "%)"
-                        << " - Validation Loss: " << current_validation_loss
-                        << " (" << (int)(100 * std::exp(-current_validation_loss)) << "%)"
-                        << " - Cost Imp.: " << relative_cost_improvement
-                        << " Time: " << system.Elapsed(elapsed_time)
-                        << std::endl;
+                    pending->result = std::async(std::launch::async, [&validate, &snapshot]() { return validate(snapshot); });
                 }
             }
             epoch++;
         } while (epoch < max_training_epochs && epochs_without_improvement < early_stopping_patience);
+        if (pending)
+            conclude_pending();
 
         if (!silent) {
             system << "Actual Epochs/Max Epochs: " << epoch << "/" << max_training_epochs
@@ -235,6 +528,10 @@ namespace DynaPlex::NN {
             << std::endl;
         }
 
+        //only process 0 keeps the best weights. 
+        if (!validates)
+            return;
+
         auto best_weights_path = system.filepath(mdp->Identifier(), "temp", "model_weights.pth");
 
         auto policy = std::make_shared<NN_Policy>(mdp);
@@ -73,12 +73,7 @@ namespace DynaPlex::NN {
 
 		std::vector<float> feats(num_feats);
 		mdp->GetFlatFeatures(state,feats);
-		std::vector<double> d_feats;
-		for (auto f: feats)
-		{
-			d_feats.push_back(static_cast<double>(f));
-		}
-		vars.Add("features", d_feats);
+		vars.Add("features", std::vector<double>(feats.begin(), feats.end()));
 
 		return vars;
 	}
@@ -21,15 +21,62 @@ namespace DynaPlex::NN
 			PrintStatistics();
 		}
 
+		ToVarGroup(mdp).SaveToFile(path,json_indent);
+	}
+
+	DynaPlex::VarGroup SampleData::ToVarGroup(const DynaPlex::MDP& mdp) const
+	{
 		VarGroup vars{};
 		vars.Add("unique_identifier", mdp->Identifier());
 		vars.Add("Samples", Samples);
+		if (int64_t num_memoized = NumMemoized(); num_memoized > 0)
+			vars.Add("num_memoized", num_memoized);
+		return vars;
+	}
 
-		vars.SaveToFile(path,json_indent);
+	std::vector<uint8_t> SampleData::Serialize(DynaPlex::MDP mdp) const
+	{
+		if (!mdp->SupportsGetStateFromVarGroup())
+		{
+			throw DynaPlex::Error("This MDP does not support getting state from VarGroup. Currently, samples cannot be serialized.");
+		}
+		for (auto& sample : Samples)
+		{
+			if (!mdp->CheckConformant(sample.state))
+			{
+				throw DynaPlex::Error("SampleData::Serialize : Error - trying to serialize samples that contain states not created with this mdp.");
+			}
+		}
+		return ToVarGroup(mdp).ToMsgPack();
+	}
+
+	void SampleData::AddFromSerialized(DynaPlex::MDP mdp, std::span<const uint8_t> bytes)
+	{
+		if (mdp->Identifier() != unique_identifier)
+		{
+			throw DynaPlex::Error("SampleData::AddFromSerialized - attempting to add data that results from a different (or differently parameterized) mdp:" + mdp->Identifier() + " vs " + unique_identifier);
+		}
+		SampleData dataToAdd = FromVarGroup(mdp, VarGroup::FromMsgPack(bytes));
+		num_memoized_added += dataToAdd.NumMemoized();
+		Samples.insert(Samples.end(), std::make_move_iterator(dataToAdd.Samples.begin()), std::make_move_iterator(dataToAdd.Samples.end()));
+	}
+
+	int64_t SampleData::NumMemoized() const
+	{
+		int64_t count = num_memoized_added;
+		for (auto& sample : Samples)
+			if (sample.memoized)
+				count++;
+		return count;
 	}
 
 	void SampleData::PrintStatistics()
 	{
+		if (Samples.empty())
+		{
+			std::cout << "Simulator statistics " << std::endl << "0 samples" << std::endl;
+			return;
+		}
 		std::vector<double> levels = { 0.5, 1.0, 1.5, 2.0, 2.5, 3.0 };
 		std::vector<size_t> counts(levels.size(), 0);
 		double avgMU = 0.0;
@@ -54,6 +101,8 @@ namespace DynaPlex::NN
 		}
 		std::cout << std::endl;
 		std::cout << "Avg Mean of Q values: " << avgMU / Samples.size() <<std::endl;
+		if (int64_t num_memoized = NumMemoized(); num_memoized > 0)
+			std::cout << "Memoized: " << (num_memoized * 100) / Samples.size() << "% of samples reused statistics of an equal state sampled earlier" << std::endl;
 	}
 
 	SampleData SampleData::CreateNewFromFile(DynaPlex::MDP mdp, std::string path)
@@ -62,19 +111,28 @@ namespace DynaPlex::NN
 		{
 			throw DynaPlex::Error("This MDP does not support getting state from VarGroup. Currently, samples cannot be saved or loaded.");
 		}
-		auto vars = VarGroup::LoadFromFile(path);
+		return FromVarGroup(mdp, VarGroup::LoadFromFile(path));
+	}
+
+	SampleData SampleData::FromVarGroup(DynaPlex::MDP mdp, const DynaPlex::VarGroup& vars)
+	{
+		if (!mdp->SupportsGetStateFromVarGroup())
+		{
+			throw DynaPlex::Error("This MDP does not support getting state from VarGroup. Currently, samples cannot be saved or loaded.");
+		}
 		std::string unique_identifier;
 		vars.Get("unique_identifier", unique_identifier);
 
 		std::string mdp_identifier = mdp->Identifier();
 		if (mdp_identifier != unique_identifier)
 		{
-			throw DynaPlex::Error("SampleData::CreateNewFromFile : Error - trying to load samples using a different (or differently parameterized) mdp compared to the mdp with which the states were created.");
+			throw DynaPlex::Error("SampleData : Error - trying to load samples using a different (or differently parameterized) mdp compared to the mdp with which the states were created.");
 		}
 		std::vector<DynaPlex::VarGroup> vg_vec;
 		vars.Get("Samples", vg_vec);
 
 		SampleData result{mdp};
+		vars.GetOrDefault("num_memoized", result.num_memoized_added, 0);
 		result.Samples.reserve(vg_vec.size());
 		for (auto& vg : vg_vec)
 		{
@@ -106,6 +164,7 @@ namespace DynaPlex::NN
 			throw DynaPlex::Error("SampleData::AddFromFile - attempting to add data that results from a different (or differently parameterized) mdp:"+mdp->Identifier()+" vs "+ unique_identifier);
 		}
 		SampleData dataToAdd = SampleData::CreateNewFromFile(mdp, path);
+		num_memoized_added += dataToAdd.NumMemoized();
 		Samples.insert(Samples.end(),std::make_move_iterator( dataToAdd.Samples.begin()),std::make_move_iterator( dataToAdd.Samples.end()));
 	}
 		
@@ -0,0 +1,309 @@
+#include "dynaplex/samplefile.h"
+#include "dynaplex/error.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <vector>
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace DynaPlex::NN
+{
+	static_assert(std::endian::native == std::endian::little, "SampleFile assumes a little-endian platform.");
+	static_assert(sizeof(SampleFile::Header) == 112, "SampleFile::Header should not contain padding.");
+
+	namespace {
+		constexpr int64_t ColumnAlignment = 64;
+
+		int64_t AlignUp(int64_t offset)
+		{
+			return (offset + ColumnAlignment - 1) / ColumnAlignment * ColumnAlignment;
+		}
+
+		void WritePadding(std::ofstream& out, int64_t target_offset)
+		{
+			static const char zeros[ColumnAlignment] = {};
+			int64_t position = static_cast<int64_t>(out.tellp());
+			out.write(zeros, target_offset - position);
+		}
+
+		template<typename T>
+		void WriteColumn(std::ofstream& out, int64_t offset, const std::vector<T>& values)
+		{
+			WritePadding(out, offset);
+			out.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+		}
+	}
+
+	class SampleFile::Mapping {
+	public:
+		explicit Mapping(const std::string& path)
+		{
+#if defined(_WIN32)
+			file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (file == INVALID_HANDLE_VALUE)
+				throw DynaPlex::Error("SampleFile - cannot open file " + path);
+			LARGE_INTEGER file_size;
+			if (!GetFileSizeEx(file, &file_size))
+			{
+				CloseHandle(file);
+				throw DynaPlex::Error("SampleFile - cannot determine size of file " + path);
+			}
+			size = static_cast<size_t>(file_size.QuadPart);
+			if (size > 0)
+			{
+				mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+				if (mapping)
+					data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+				if (!data)
+				{
+					if (mapping)
+						CloseHandle(mapping);
+					CloseHandle(file);
+					throw DynaPlex::Error("SampleFile - cannot map file " + path);
+				}
+			}
+#else
+			int fd = open(path.c_str(), O_RDONLY);
+			if (fd < 0)
+				throw DynaPlex::Error("SampleFile - cannot open file " + path);
+			struct stat st;
+			if (fstat(fd, &st) != 0)
+			{
+				close(fd);
+				throw DynaPlex::Error("SampleFile - cannot determine size of file " + path);
+			}
+			size = static_cast<size_t>(st.st_size);
+			if (size > 0)
+			{
+				void* ptr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+				if (ptr == MAP_FAILED)
+				{
+					close(fd);
+					throw DynaPlex::Error("SampleFile - cannot map file " + path);
+				}
+				data = ptr;
+			}
+			//the mapping remains valid after closing the descriptor.
+			close(fd);
+#endif
+		}
+
+		~Mapping()
+		{
+#if defined(_WIN32)
+			if (data)
+				UnmapViewOfFile(data);
+			if (mapping)
+				CloseHandle(mapping);
+			CloseHandle(file);
+#else
+			if (data)
+				munmap(data, size);
+#endif
+		}
+
+		Mapping(const Mapping&) = delete;
+		Mapping& operator=(const Mapping&) = delete;
+
+		const char* Data() const { return static_cast<const char*>(data); }
+		size_t Size() const { return size; }
+
+	private:
+		void* data = nullptr;
+		size_t size = 0;
+#if defined(_WIN32)
+		HANDLE file = INVALID_HANDLE_VALUE;
+		HANDLE mapping = nullptr;
+#endif
+	};
+
+	void SampleFile::Save(const DynaPlex::MDP& mdp, std::span<const DynaPlex::NN::Sample> samples, const std::string& path,
+		DynaPlex::Parallel::ThreadPool* pool)
+	{
+		if (!mdp->ProvidesFlatFeatures())
+			throw DynaPlex::Error("SampleFile::Save - mdp does not provide flat features. This is currently unsupported.");
+
+		const int64_t N = static_cast<int64_t>(samples.size());
+		const int64_t F = mdp->NumFlatFeatures();
+		const int64_t A = mdp->NumValidActions();
+		const std::string mdp_identifier = mdp->Identifier();
+
+		Header header{};
+		std::memcpy(header.magic, Magic, sizeof(Magic));
+		header.version = Version;
+		header.identifier_length = static_cast<uint32_t>(mdp_identifier.size());
+		header.num_samples = N;
+		header.num_features = F;
+		header.num_valid_actions = A;
+		int64_t offset = static_cast<int64_t>(sizeof(Header)) + header.identifier_length;
+		auto next_column = [&offset](int64_t bytes) {
+			int64_t column_offset = AlignUp(offset);
+			offset = column_offset + bytes;
+			return column_offset;
+		};
+		header.features_offset = next_column(N * F * sizeof(float));
+		header.mask_offset = next_column(N * A * sizeof(float));
+		header.probabilities_offset = next_column(N * A * sizeof(float));
+		header.cost_improvement_offset = next_column(N * A * sizeof(float));
+		header.action_label_offset = next_column(N * sizeof(int64_t));
+		header.sample_number_offset = next_column(N * sizeof(int64_t));
+		header.q_hat_offset = next_column(N * sizeof(float));
+		header.z_stat_offset = next_column(N * sizeof(float));
+		header.file_size = offset;
+
+		std::vector<float> features(N * F);
+		std::vector<float> mask(N * A, 0.0f), probabilities(N * A, 0.0f), cost_improvement(N * A, 0.0f);
+		std::vector<int64_t> action_labels(N), sample_numbers(N);
+		std::vector<float> q_hat(N), z_stat(N);
+		//each sample writes to its own rows of the columns, such that samples can be converted concurrently. 
+		auto convert = [&](int64_t begin, int64_t end) {
+			for (int64_t i = begin; i < end; i++)
+			{
+				const auto& sample = samples[i];
+				if (!mdp->CheckConformant(sample.state))
+					throw DynaPlex::Error("SampleFile::Save - trying to save samples that contain states not created with this mdp.");
+				mdp->GetFlatFeatures(sample.state, std::span<float>(features.data() + i * F, F));
+
+				auto allowed_actions = mdp->AllowedActions(sample.state);
+				bool has_costs = !sample.cost_improvement.empty();
+				bool has_probs = !sample.probabilities.empty();
+				if ((has_costs && sample.cost_improvement.size() != allowed_actions.size()) || (has_probs && sample.probabilities.size() != allowed_actions.size()))
+					throw DynaPlex::Error("SampleFile::Save - cost_improvement and probabilities of a sample should have an entry for each allowed action.");
+				for (size_t index = 0; index < allowed_actions.size(); index++)
+				{
+					int64_t entry = i * A + allowed_actions[index];
+					mask[entry] = 1.0f;
+					if (has_costs)
+						cost_improvement[entry] = static_cast<float>(sample.cost_improvement[index]);
+					if (has_probs)
+						probabilities[entry] = static_cast<float>(sample.probabilities[index]);
+				}
+				action_labels[i] = sample.action_label;
+				sample_numbers[i] = sample.sample_number;
+				q_hat[i] = static_cast<float>(sample.q_hat);
+				z_stat[i] = static_cast<float>(sample.z_stat);
+			}
+			};
+		if (pool && N > 1)
+			pool->ForEach(N, 4 * pool->NumThreads(), convert);
+		else
+			convert(0, N);
+
+		std::ofstream out(path, std::ios::binary | std::ios::trunc);
+		if (!out)
+			throw DynaPlex::Error("SampleFile::Save - cannot open " + path + " for writing.");
+		out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+		out.write(mdp_identifier.data(), static_cast<std::streamsize>(mdp_identifier.size()));
+		WriteColumn(out, header.features_offset, features);
+		WriteColumn(out, header.mask_offset, mask);
+		WriteColumn(out, header.probabilities_offset, probabilities);
+		WriteColumn(out, header.cost_improvement_offset, cost_improvement);
+		WriteColumn(out, header.action_label_offset, action_labels);
+		WriteColumn(out, header.sample_number_offset, sample_numbers);
+		WriteColumn(out, header.q_hat_offset, q_hat);
+		WriteColumn(out, header.z_stat_offset, z_stat);
+		if (!out)
+			throw DynaPlex::Error("SampleFile::Save - error while writing " + path);
+	}
+
+	bool SampleFile::IsSampleFile(const std::string& path)
+	{
+		std::ifstream in(path, std::ios::binary);
+		char magic[sizeof(Magic)];
+		if (!in.read(magic, sizeof(magic)))
+			return false;
+		return std::memcmp(magic, Magic, sizeof(Magic)) == 0;
+	}
+
+	SampleFile::SampleFile(const std::string& path)
+		: mapping{ std::make_unique<Mapping>(path) }
+	{
+		if (mapping->Size() < sizeof(Header))
+			throw DynaPlex::Error("SampleFile - " + path + " is not a sample file: too small.");
+		std::memcpy(&header, mapping->Data(), sizeof(Header));
+		if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0)
+			throw DynaPlex::Error("SampleFile - " + path + " is not a sample file.");
+		if (header.version != Version)
+			throw DynaPlex::Error("SampleFile - " + path + " has version " + std::to_string(header.version) + ", only version " + std::to_string(Version) + " is supported.");
+		if (header.file_size != static_cast<int64_t>(mapping->Size()) || header.num_samples < 0 || header.num_features < 0 || header.num_valid_actions < 0
+			|| sizeof(Header) + header.identifier_length > mapping->Size())
+			throw DynaPlex::Error("SampleFile - " + path + " is truncated or corrupt.");
+		identifier.assign(mapping->Data() + sizeof(Header), header.identifier_length);
+
+		const int64_t N = header.num_samples;
+		std::pair<int64_t, int64_t> columns[] = {
+			{header.features_offset, N * header.num_features * int64_t(sizeof(float))},
+			{header.mask_offset, N * header.num_valid_actions * int64_t(sizeof(float))},
+			{header.probabilities_offset, N * header.num_valid_actions * int64_t(sizeof(float))},
+			{header.cost_improvement_offset, N * header.num_valid_actions * int64_t(sizeof(float))},
+			{header.action_label_offset, N * int64_t(sizeof(int64_t))},
+			{header.sample_number_offset, N * int64_t(sizeof(int64_t))},
+			{header.q_hat_offset, N * int64_t(sizeof(float))},
+			{header.z_stat_offset, N * int64_t(sizeof(float))}
+		};
+		for (auto& [offset, bytes] : columns)
+			if (offset % ColumnAlignment != 0 || offset < 0 || offset + bytes > header.file_size)
+				throw DynaPlex::Error("SampleFile - " + path + " is truncated or corrupt.");
+	}
+
+	SampleFile::SampleFile(const DynaPlex::MDP& mdp, const std::string& path)
+		: SampleFile(path)
+	{
+		if (mdp->Identifier() != identifier)
+			throw DynaPlex::Error("SampleFile - trying to load samples using a different (or differently parameterized) mdp compared to the mdp with which the samples were created: " + mdp->Identifier() + " vs " + identifier);
+		if (mdp->NumFlatFeatures() != NumFeatures() || mdp->NumValidActions() != NumValidActions())
+			throw DynaPlex::Error("SampleFile - number of features or valid actions in " + path + " does not match the mdp.");
+	}
+
+	SampleFile::~SampleFile() = default;
+	SampleFile::SampleFile(SampleFile&&) noexcept = default;
+	SampleFile& SampleFile::operator=(SampleFile&&) noexcept = default;
+
+	template<typename T>
+	std::span<const T> SampleFile::Column(int64_t offset, int64_t count) const
+	{
+		return std::span<const T>(reinterpret_cast<const T*>(mapping->Data() + offset), static_cast<size_t>(count));
+	}
+
+	std::span<const float> SampleFile::Features() const
+	{
+		return Column<float>(header.features_offset, header.num_samples * header.num_features);
+	}
+	std::span<const float> SampleFile::Mask() const
+	{
+		return Column<float>(header.mask_offset, header.num_samples * header.num_valid_actions);
+	}
+	std::span<const float> SampleFile::Probabilities() const
+	{
+		return Column<float>(header.probabilities_offset, header.num_samples * header.num_valid_actions);
+	}
+	std::span<const float> SampleFile::CostImprovement() const
+	{
+		return Column<float>(header.cost_improvement_offset, header.num_samples * header.num_valid_actions);
+	}
+	std::span<const int64_t> SampleFile::ActionLabels() const
+	{
+		return Column<int64_t>(header.action_label_offset, header.num_samples);
+	}
+	std::span<const int64_t> SampleFile::SampleNumbers() const
+	{
+		return Column<int64_t>(header.sample_number_offset, header.num_samples);
+	}
+	std::span<const float> SampleFile::QHat() const
+	{
+		return Column<float>(header.q_hat_offset, header.num_samples);
+	}
+	std::span<const float> SampleFile::ZStat() const
+	{
+		return Column<float>(header.z_stat_offset, header.num_samples);
+	}
+}
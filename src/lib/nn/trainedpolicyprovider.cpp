@@ -2,25 +2,68 @@
 #include "neuralnetworkprovider.h"
 #include "torchscriptwrapper.h"
 #include "nn_policy.h"
+#include "dynaplex/torchavailability.h"
+#include <filesystem>
+#include <fstream>
 #if DP_TORCH_AVAILABLE
 #include <torch/torch.h>
 #endif
 //#if DP_TORCH_AVAILABLE
 namespace DynaPlex {
 
+	namespace {
+		//FNV-1a hash of the contents of the file at path. 
+		int64_t FileHash(const std::string& path)
+		{
+			std::ifstream in(path, std::ios::binary);
+			if (!in)
+				throw DynaPlex::Error("NeuralNetworkProvider::LoadPolicy - cannot read " + path);
+			uint64_t hash = 14695981039346656037ull;
+			std::vector<char> buffer(1 << 16);
+			while (in.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || in.gcount() > 0)
+				for (std::streamsize i = 0; i < in.gcount(); i++)
+				{
+					hash ^= static_cast<uint8_t>(buffer[i]);
+					hash *= 1099511628211ull;
+				}
+			return static_cast<int64_t>(hash);
+		}
 
-	DynaPlex::Policy TrainedPolicyProvider::LoadPolicy(DynaPlex::MDP mdp, std::string path_to_policy_without_extension)
+		bool IsMLP(const DynaPlex::VarGroup& policy_config)
+		{
+			if (!policy_config.HasKey("nn_architecture"))
+				return false;
+			DynaPlex::VarGroup nn_architecture;
+			policy_config.Get("nn_architecture", nn_architecture);
+			std::string type;
+			nn_architecture.Get("type", type);
+			return type == "mlp";
+		}
+	}
+
+	DynaPlex::Policy TrainedPolicyProvider::LoadPolicy(DynaPlex::MDP mdp, std::string path_to_policy_without_extension, const DynaPlex::VarGroup& inference_config)
 	{
-		//policy is saved over two different files, architecture (json) and weights (pth). 
+		bool batch_across_threads;
+		inference_config.GetOrDefault("batch_across_threads", batch_across_threads, false);
+		//policy is saved over two different files, architecture (json) and weights (pth). mlp networks have their weights also in a
+		//native file (mlp), which is evaluated without torch. 
 		auto path_to_json = System::SetFileExtension(path_to_policy_without_extension, "json");
 		auto path_to_weights = System::SetFileExtension(path_to_policy_without_extension, "pth");
+		auto path_to_native_weights = System::SetFileExtension(path_to_policy_without_extension, "mlp");
 		
 		//load architecture:
 		auto policy_config = VarGroup::LoadFromFile(path_to_json);
 		std::string id;
 			
 		policy_config.Get("id", id);
-#if DP_TORCH_AVAILABLE		
+		//quantized policies (see PolicyTrainer::QuantizePolicy) are evaluated natively. 
+		bool quantized = policy_config.HasKey("quantization");
+		std::string engine;
+		inference_config.GetOrDefault("engine", engine, TorchAvailability::TorchAvailable() && !quantized ? "torch" : "native");
+		if (engine != "torch" && engine != "native")
+			throw DynaPlex::Error("NeuralNetworkProvider::LoadPolicy: engine is: " + engine + ". Supported engines are \"torch\" and \"native\".");
+		if (engine == "torch" && quantized)
+			throw DynaPlex::Error("NeuralNetworkProvider::LoadPolicy: quantized policies can only be evaluated with engine \"native\".");
 		if (id == "NN_Policy")
 		{
 			//check whether dimensionalities are matching:
@@ -31,7 +74,37 @@ namespace DynaPlex {
 			policy_config.Get("num_outputs", num_outputs);
 			if (num_outputs != mdp->NumValidActions())
 				throw DynaPlex::Error("NeuralNetworkProvider::LoadPolicy - cannot create neural network policy from loaded data for this mdp because num_outputs for the loaded policy does not match mdp->NumValidActions(). ");
-	
+
+			if (engine == "native")
+			{
+				if (!IsMLP(policy_config) || !std::filesystem::exists(path_to_native_weights))
+					throw DynaPlex::Error("NeuralNetworkProvider::LoadPolicy: Torch not available or engine \"native\" requested, but no native weights (" + path_to_native_weights + ") found. Only networks of type \"mlp\" that were saved with native weights can be evaluated without torch.");
+				auto policy = std::make_shared<NN_Policy>(mdp);
+				policy->native_network = std::make_unique<DynaPlex::NN::MLPEngine>(DynaPlex::NN::MLPEngine::Load(path_to_native_weights));
+				if (policy->native_network->NumInputs() != num_inputs || policy->native_network->NumOutputs() != num_outputs)
+					throw DynaPlex::Error("NeuralNetworkProvider::LoadPolicy - native weights in " + path_to_native_weights + " do not match num_inputs and num_outputs of the policy.");
+				if (quantized)
+				{
+					DynaPlex::VarGroup quantization;
+					policy_config.Get("quantization", quantization);
+					std::string precision;
+					quantization.Get("precision", precision);
+					DynaPlex::VarGroup::DoubleVec input_ranges;
+					if (quantization.HasKey("input_ranges"))
+						quantization.Get("input_ranges", input_ranges);
+					policy->native_network->SetPrecision(DynaPlex::NN::MLPEngine::PrecisionFromString(precision), std::vector<float>(input_ranges.begin(), input_ranges.end()));
+				}
+				//the configuration is equal for policies of different generations; the hash of the weights tells these apart. 
+				policy_config.Set("weights_hash", FileHash(path_to_native_weights));
+				policy->policy_config = policy_config;
+				if (batch_across_threads)
+					policy->EnableBatching(inference_config);
+				return policy;
+			}
+		}
+#if DP_TORCH_AVAILABLE		
+		if (id == "NN_Policy")
+		{
 			//create policy:
 			auto policy = std::make_shared<NN_Policy>(mdp);
 			DynaPlex::VarGroup nn_architecture;
@@ -42,12 +115,17 @@ namespace DynaPlex {
 			auto as_nn_module = policy->neural_network->ptr();
 			torch::load(as_nn_module, path_to_weights);
 			//set config:
+			policy_config.Set("weights_hash", FileHash(path_to_weights));
 			policy->policy_config = policy_config;
+			if (batch_across_threads)
+				policy->EnableBatching(inference_config);
 			return policy;
 
 		}
 		else if (id == "torchscript")
 		{
+			if (engine == "native")
+				throw DynaPlex::Error("NeuralNetworkProvider::LoadPolicy: engine \"native\" does not support torchscript networks.");
 
 			auto policy = std::make_shared<NN_Policy>(mdp);
 			// Use the TorchScriptWrapper class to wrap the TorchScript module
@@ -83,7 +161,10 @@ namespace DynaPlex {
 				throw DynaPlex::Error("NeuralNetworkProvider::LoadPolicy: input_type of neural network is: " + input_type + ". This input_type is not available.");
 
 			}
+			policy_config.Set("weights_hash", FileHash(path_to_weights));
 			policy->policy_config = policy_config;
+			if (batch_across_threads)
+				policy->EnableBatching(inference_config);
 			return policy;
 		}
 		else
@@ -107,10 +188,32 @@ namespace DynaPlex {
 			if (!as_NN_policy) {
 				throw DynaPlex::Error("NeuralNetworkProvider::SavePolicy - cannot save this policy of declared type+ " + id + ". Cast to NN_Policy fails.");
 			}
+			auto json_path = System::SetFileExtension(path_to_policy_without_extension, "json");
+			auto native_weights_path = System::SetFileExtension(path_to_policy_without_extension, "mlp");
+			if (as_NN_policy->native_network)
+			{
+				as_NN_policy->native_network->Save(native_weights_path);
+				as_NN_policy->policy_config.SaveToFile(json_path, 1);
+				return;
+			}
 #if DP_TORCH_AVAILABLE		
 			auto weights_path = System::SetFileExtension(path_to_policy_without_extension, "pth");
 			torch::save(as_NN_policy->neural_network->ptr(), weights_path);
-			auto json_path = System::SetFileExtension(path_to_policy_without_extension, "json");
+			//mlp networks are also exported for evaluation without torch; their parameters are the weights and biases of the linear layers, in order. 
+			if (IsMLP(as_NN_policy->policy_config))
+			{
+				std::vector<DynaPlex::NN::MLPEngine::Layer> layers;
+				auto parameters = as_NN_policy->neural_network->ptr()->parameters();
+				for (size_t i = 0; i + 1 < parameters.size(); i += 2)
+				{
+					auto weights = parameters[i].detach().to(torch::kFloat32).contiguous();
+					auto bias = parameters[i + 1].detach().to(torch::kFloat32).contiguous();
+					layers.push_back({ weights.size(1), weights.size(0),
+						std::vector<float>(weights.data_ptr<float>(), weights.data_ptr<float>() + weights.numel()),
+						std::vector<float>(bias.data_ptr<float>(), bias.data_ptr<float>() + bias.numel()) });
+				}
+				DynaPlex::NN::MLPEngine(layers).Save(native_weights_path);
+			}
 			as_NN_policy->policy_config.SaveToFile(json_path, 1);
 #else
 			throw DynaPlex::Error("NeuralNetworkProvider::SavePolicy - Torch not available, cannot save. To make torch available, set dynaplex_enable_pytorch to true and dynaplex_pytorch_path to an appropriate path, e.g. in CMakeUserPresets.txt ");
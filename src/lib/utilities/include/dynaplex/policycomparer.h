@@ -6,11 +6,8 @@
 namespace DynaPlex::Utilities {
 	class PolicyComparer {
 
-		template<bool SkipTrivialActions=false>
-		void Evolve(const DynaPlex::Policy& policy, std::span<DynaPlex::Trajectory>, int64_t) const;
-
-		void CheckTrajectoriesInfiniteHorizon(std::span<DynaPlex::Trajectory>, int64_t) const;
-		void CheckTrajectoriesFiniteHorizon(std::span<DynaPlex::Trajectory>) const;
+		void CheckTrajectoriesInfiniteHorizon(const DynaPlex::TrajectoryBatchInterface&, int64_t) const;
+		void CheckTrajectoriesFiniteHorizon(const DynaPlex::TrajectoryBatchInterface&) const;
 
 		void ComputeReturns(std::span<double>& ReturnPerTrajectory, const DynaPlex::Policy& policy, int64_t offset) const;
 
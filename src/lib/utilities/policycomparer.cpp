@@ -1,23 +1,28 @@
 #include "dynaplex/policycomparer.h"
 #include "dynaplex/trajectory.h"
+#include "dynaplex/trajectoryspanbatch.h"
 #include "dynaplex/parallel_execute.h"
 #include "dynaplex/policycomparison.h"
 namespace DynaPlex::Utilities {
 
 	void PolicyComparer::ComputeReturns(std::span<double>& ReturnPerTrajectory,const DynaPlex::Policy& policy, int64_t offset) const
 	{
+		//policies of the mdp itself simulate on contiguous typed states; others on DynaPlex::Trajectory. 
 		std::vector<DynaPlex::Trajectory> trajectories{};
-		trajectories.reserve(ReturnPerTrajectory.size());
+		std::unique_ptr<DynaPlex::TrajectoryBatchInterface> batch = mdp->CreateTrajectoryBatch(policy, ReturnPerTrajectory.size());
+		if (!batch)
+		{
+			trajectories.resize(ReturnPerTrajectory.size());
+			batch = std::make_unique<DynaPlex::TrajectorySpanBatch>(*mdp, policy, trajectories);
+		}
 
-		
 		for (int64_t experiment_number = 0; experiment_number < ReturnPerTrajectory.size(); experiment_number++)
 		{
-			trajectories.emplace_back(experiment_number + offset);
-			trajectories.back().RNGProvider.SeedEventStreams(true, rng_seed, experiment_number + offset);
+			batch->RNGProvider(experiment_number).SeedEventStreams(true, rng_seed, experiment_number + offset);
 		}
 
 		//Initiate each trajectory with a random state. 
-		mdp->InitiateState(trajectories);		
+		batch->InitiateState();
 
 		if (mdp->IsInfiniteHorizon())
 		{
@@ -28,21 +33,21 @@ namespace DynaPlex::Utilities {
 			//For undiscounted case, we try to assess average cost per period. 
 			if (mdp->DiscountFactor() == 1.0)
 			{
-				Evolve(policy, trajectories, warmup_periods);
+				batch->Evolve(warmup_periods);
 				for (size_t i = 0; i < ReturnPerTrajectory.size(); i++)
-					ReturnPerTrajectory[i] = trajectories[i].CumulativeReturn;
+					ReturnPerTrajectory[i] = batch->CumulativeReturn(i);
 			}
 			else
 				if (warmup_periods != 0)
 					throw DynaPlex::Error("PolicyComparer: Error in logic - warmup_periods should be zero for discounted cost logic.");
 				
 			
-			CheckTrajectoriesInfiniteHorizon(trajectories, warmup_periods);
-			Evolve(policy, trajectories, warmup_periods + periods_per_trajectory);
-			CheckTrajectoriesInfiniteHorizon(trajectories, warmup_periods + periods_per_trajectory);
+			CheckTrajectoriesInfiniteHorizon(*batch, warmup_periods);
+			batch->Evolve(warmup_periods + periods_per_trajectory);
+			CheckTrajectoriesInfiniteHorizon(*batch, warmup_periods + periods_per_trajectory);
 			for (size_t i = 0; i < ReturnPerTrajectory.size(); i++)
 			{
-				ReturnPerTrajectory[i] = trajectories[i].CumulativeReturn - ReturnPerTrajectory[i];
+				ReturnPerTrajectory[i] = batch->CumulativeReturn(i) - ReturnPerTrajectory[i];
 			}
 			if (mdp->DiscountFactor() == 1)
 			{
@@ -52,11 +57,11 @@ namespace DynaPlex::Utilities {
 		}
 		else
 		{//finite horizon:
-			Evolve(policy, trajectories, max_periods_until_error);
-			CheckTrajectoriesFiniteHorizon(trajectories);
+			batch->Evolve(max_periods_until_error);
+			CheckTrajectoriesFiniteHorizon(*batch);
 			for (size_t i = 0; i < ReturnPerTrajectory.size(); i++)
 			{
-				ReturnPerTrajectory[i] = trajectories[i].CumulativeReturn;
+				ReturnPerTrajectory[i] = batch->CumulativeReturn(i);
 			}
 		}
 	}
@@ -94,23 +99,23 @@ namespace DynaPlex::Utilities {
 			throw DynaPlex::Error("PolicyComparer :: Invalid rng_seed - should be non-negative");
 	}
 
-	void PolicyComparer::CheckTrajectoriesInfiniteHorizon(std::span<DynaPlex::Trajectory> trajectories, int64_t cumulative_periods) const {
-		for (auto& traj : trajectories)
+	void PolicyComparer::CheckTrajectoriesInfiniteHorizon(const DynaPlex::TrajectoryBatchInterface& batch, int64_t cumulative_periods) const {
+		for (size_t i = 0; i < batch.Size(); i++)
 		{
-			if (traj.Category.IsFinal())
+			if (batch.Category(i).IsFinal())
 			{
 				throw DynaPlex::Error("PolicyComparer: mdp " + mdp->TypeIdentifier() + " has infinite horizon but returns categories that are IsFinal.");
 			}
-			if (traj.PeriodCount != cumulative_periods)
+			if (batch.PeriodCount(i) != cumulative_periods)
 			{
 				throw DynaPlex::Error("PolicyComparer: Error in logic for mdp: " + mdp->TypeIdentifier()+". Please contact developers.");
 			}
 		}
 	}
-	void PolicyComparer::CheckTrajectoriesFiniteHorizon(std::span<DynaPlex::Trajectory> trajectories) const {
-		for (auto& traj : trajectories)
+	void PolicyComparer::CheckTrajectoriesFiniteHorizon(const DynaPlex::TrajectoryBatchInterface& batch) const {
+		for (size_t i = 0; i < batch.Size(); i++)
 		{
-			if (!traj.Category.IsFinal())
+			if (!batch.Category(i).IsFinal())
 			{
 				throw DynaPlex::Error("PolicyComparer: mdp " + mdp->TypeIdentifier() + " has finite horizon but does not reach state with IsFinal after max_periods_until_error=" + std::to_string(max_periods_until_error) + " periods. ");
 			}
@@ -118,38 +123,6 @@ namespace DynaPlex::Utilities {
 	}
 
 
-	template<bool SkipTrivialActions>
-	void PolicyComparer::Evolve(const DynaPlex::Policy& policy, std::span<DynaPlex::Trajectory> span, int64_t max_periods) const
-	{
-		while (true)
-		{
-			bool all_require_action;
-			if constexpr (SkipTrivialActions)
-			{
-				all_require_action = mdp->IncorporateUntilAction(span, max_periods);
-			}
-			else
-			{
-				all_require_action = mdp->IncorporateUntilNonTrivialAction(span, max_periods);
-			}
-			if (!all_require_action)
-			{
-				//This "sorts" the trajectories, such that the trajectories that are IsAwaitAction are at the front.
-				// Note that mdp->IncorporateAction only accepts set of adjacent trajectories that are all AwaitAction. 
-				std::span<DynaPlex::Trajectory>::iterator new_partition_point = std::partition(span.begin(), span.end(),
-					[](const DynaPlex::Trajectory& traj) {return traj.Category.IsAwaitAction(); }
-				);
-				//new_partition_point is the first element which does not require an action. 
-				//Make the span refer to a set of trajectories each awaiting an action:
-				span = std::span<DynaPlex::Trajectory>(span.begin(), new_partition_point);
-			}
-			//This means all trajectories are at period warmup_periods or final. 
-			if (span.size() == 0)
-				break;
-			mdp->IncorporateAction(span, policy);
-		}
-	}
-
 	DynaPlex::VarGroup PolicyComparer::Assess(DynaPlex::Policy policy) const {
 		std::vector<DynaPlex::Policy> polVec{};
 		polVec.reserve(1);
@@ -185,7 +158,7 @@ namespace DynaPlex::Utilities {
 
 			DynaPlex::Parallel::parallel_compute<double>(nestedReturnValues[i], [this, &policy](std::span<double> span, int64_t start) {
 				this->ComputeReturns(span, policy, start);
-				}, system.HardwareThreads());			
+				}, system.WorkerPool());
 		}
 
 		DynaPlex::PolicyComparison comparison{ nestedReturnValues };
@@ -769,4 +769,85 @@ namespace DynaPlex::Tests {
 		}
 	}
 
-} // namespace DynaPlex::Tests
\ No newline at end of file
+	TEST(discretedist, GetSamples) {
+		auto dist = DiscreteDist::GetCustomDist({ 0.1, 0.2, 0.3, 0.4 }, -1);
+		for (bool optimized : {false, true})
+		{
+			if (optimized)
+				dist.OptimizeForSampling();
+			//identical to repeated GetSample
+			DynaPlex::RNG rng{ false, 123, 4 }, rng2{ false, 123, 4 };
+			std::vector<int64_t> samples(201);
+			dist.GetSamples(rng, samples);
+			for (auto sample : samples)
+				ASSERT_EQ(sample, dist.GetSample(rng2));
+
+			DynaPlex::MultiLaneRNG lanes{ 1234ull };
+			std::vector<int64_t> lane_samples(100000);
+			dist.GetSamples(lanes, lane_samples);
+			for (int64_t value = -1; value <= 2; value++)
+			{
+				auto count = std::count(lane_samples.begin(), lane_samples.end(), value);
+				EXPECT_NEAR(static_cast<double>(count) / lane_samples.size(), dist.ProbabilityAt(value), 0.01);
+			}
+		}
+	}
+
+	TEST(discretedist, alias_and_guide_tables) {
+		//heavy-tailed, with interior zeros
+		std::vector<double> probs;
+		for (int64_t i = 0; i < 300; i++)
+			probs.push_back(i % 7 == 3 ? 0.0 : 1.0 / ((i + 1.0) * (i + 1.0)));
+		double total = std::accumulate(probs.begin(), probs.end(), 0.0);
+		for (auto& p : probs)
+			p /= total;
+		auto plain = DiscreteDist::GetCustomDist(probs, 5);
+		auto optimized = plain;
+		optimized.OptimizeForSampling();
+		auto aliased = plain;
+		aliased.OptimizeForSampling(true);
+
+		//by default, the guide table inverts the same cdf, so samples are identical to those without optimization.
+		{
+			DynaPlex::RNG rng1{ false, 42, 6 }, rng2{ false, 42, 6 };
+			for (size_t i = 0; i < 10000; i++)
+				ASSERT_EQ(plain.GetSample(rng1), optimized.GetSample(rng2));
+		}
+
+		DynaPlex::RNG rng{ false, 42, 7 };
+		const size_t num_samples = 400000;
+		std::vector<size_t> counts(probs.size(), 0);
+		for (size_t i = 0; i < num_samples; i++)
+		{
+			int64_t sample = aliased.GetSample(rng);
+			ASSERT_GE(sample, aliased.Min());
+			ASSERT_LE(sample, aliased.Max());
+			counts[sample - 5]++;
+		}
+		for (size_t i = 0; i < probs.size(); i++)
+		{
+			if (probs[i] == 0.0)
+				ASSERT_EQ(counts[i], 0);
+			else
+				EXPECT_NEAR(static_cast<double>(counts[i]) / num_samples, probs[i], 5 * std::sqrt(probs[i] / num_samples) + 1e-9);
+		}
+
+		//conditional samples invert the same cdf with and without optimization, so they are identical.
+		for (int64_t minimum_value : { 0ll, 5ll, 6ll, 40ll, 200ll, 304ll })
+		{
+			DynaPlex::RNG rng1{ false, 42, 8 }, rng2{ false, 42, 8 }, rng3{ false, 42, 8 };
+			for (size_t i = 0; i < 1000; i++)
+			{
+				auto sample = plain.GetConditionalSample(rng1, minimum_value);
+				ASSERT_EQ(sample, optimized.GetConditionalSample(rng2, minimum_value));
+				ASSERT_EQ(sample, aliased.GetConditionalSample(rng3, minimum_value));
+			}
+		}
+
+		//optimizing twice has no effect
+		auto twice = aliased;
+		twice.OptimizeForSampling(true);
+		EXPECT_TRUE(twice == aliased);
+	}
+
+} // namespace DynaPlex::Tests
@@ -163,4 +163,36 @@ namespace DynaPlex::Tests {
 		EXPECT_THROW(jointDist.FindPositionInJointQtys({ 4, 1, 3 }), DynaPlex::Error);
 	}
 
+	TEST(jointdiscretedist, optimized_sampling) {
+		auto first = DiscreteDist::GetCustomDist({ 0.1, 0.5, 0.3, 0.1 }, -1);
+		auto second = DiscreteDist::GetCustomDist({ 0.1, 0.3, 0.0, 0.3, 0.3 }, 1);
+		JointDiscreteDist plain(first, second);
+		JointDiscreteDist optimized(first, second);
+		optimized.OptimizeForSampling();
+		JointDiscreteDist aliased(first, second);
+		aliased.OptimizeForSampling(true);
+
+		//by default, samples are identical to those without optimization.
+		{
+			DynaPlex::RNG rng1{ false, 1, 1 }, rng2{ false, 1, 1 };
+			for (size_t i = 0; i < 10000; i++)
+				ASSERT_EQ(plain.GetSample(rng1), optimized.GetSample(rng2));
+		}
+
+		DynaPlex::RNG rng{ false, 1, 2 };
+		const size_t num_samples = 200000;
+		std::vector<size_t> counts(aliased.DistinctValueCount(), 0);
+		for (size_t i = 0; i < num_samples; i++)
+			counts[aliased.GetSample(rng)]++;
+		for (const auto& [pos, prob] : plain)
+		{
+			if (prob == 0.0)
+				ASSERT_EQ(counts[pos], 0);
+			else
+				EXPECT_NEAR(static_cast<double>(counts[pos]) / num_samples, prob, 0.005);
+		}
+		auto qtys = aliased.GetSampleQtys(rng);
+		EXPECT_EQ(qtys.size(), 2);
+	}
+
 } // namespace DynaPlex::Tests
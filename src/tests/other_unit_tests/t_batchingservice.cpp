@@ -0,0 +1,61 @@
+#include <vector>
+#include <atomic>
+#include <thread>
+#include "dynaplex/error.h"
+#include "dynaplex/batchingservice.h"
+#include <gtest/gtest.h>
+
+namespace DynaPlex::Tests {
+
+	TEST(BatchingService, aggregates_rows_of_threads) {
+		const int64_t num_inputs = 3, num_outputs = 2;
+		std::atomic<int64_t> largest_batch = 0, num_calls = 0;
+		//output row i is (sum of input row i, number of rows in the batch)
+		auto forward = [&](std::span<const float> inputs, int64_t rows, std::span<float> outputs) {
+			num_calls++;
+			int64_t largest = largest_batch;
+			while (rows > largest && !largest_batch.compare_exchange_weak(largest, rows));
+			for (int64_t i = 0; i < rows; i++)
+			{
+				outputs[i * num_outputs] = inputs[i * num_inputs] + inputs[i * num_inputs + 1] + inputs[i * num_inputs + 2];
+				outputs[i * num_outputs + 1] = static_cast<float>(rows);
+			}
+			};
+		const int64_t num_threads = 8, rounds = 20, max_batch_size = 8;
+		DynaPlex::NN::BatchingService service(forward, num_inputs, num_outputs,
+			VarGroup{ {"max_batch_size",max_batch_size},{"max_latency_us",100000} });
+
+		std::atomic<int64_t> wrong_results = 0;
+		std::vector<std::thread> threads;
+		for (int64_t t = 0; t < num_threads; t++)
+			threads.emplace_back([&, t]() {
+			for (int64_t r = 0; r < rounds; r++)
+			{
+				float value = static_cast<float>(t * rounds + r);
+				auto result = service.Submit({ value, 1.0f, 2.0f }).get();
+				if (result.size() != num_outputs || result[0] != value + 3.0f)
+					wrong_results++;
+			}
+				});
+		for (auto& thread : threads)
+			thread.join();
+
+		EXPECT_EQ(wrong_results, 0);
+		EXPECT_LE(largest_batch, max_batch_size);
+		//rows of different threads were combined in a single forward pass:
+		EXPECT_GT(largest_batch, 1);
+		EXPECT_LT(num_calls, num_threads * rounds);
+	}
+
+	TEST(BatchingService, forwards_exceptions_and_validates) {
+		auto failing = [](std::span<const float>, int64_t, std::span<float>) {
+			throw DynaPlex::Error("forward failed");
+			};
+		DynaPlex::NN::BatchingService service(failing, 2, 1, VarGroup{ {"max_latency_us",0} });
+		auto future = service.Submit({ 1.0f, 2.0f, 3.0f, 4.0f });
+		EXPECT_THROW(future.get(), DynaPlex::Error);
+		//inputs must consist of complete rows:
+		EXPECT_THROW(service.Submit({ 1.0f }), DynaPlex::Error);
+		EXPECT_THROW(DynaPlex::NN::BatchingService(failing, 2, 1, VarGroup{ {"max_batch_size",0} }), DynaPlex::Error);
+	}
+}
@@ -0,0 +1,73 @@
+#include <vector>
+#include "dynaplex/vargroup.h"
+#include "dynaplex/error.h"
+#include "dynaplex/dynaplexprovider.h"
+#include "dynaplex/trajectory.h"
+#include <gtest/gtest.h>
+
+namespace DynaPlex::Tests {
+
+	namespace {
+		//returns the cumulative return of every action for H periods from the state of traj, with all trajectories seeded alike.
+		std::vector<double> RolloutAllActions(DynaPlex::MDP& mdp, DynaPlex::Policy& policy, const DynaPlex::dp_State& root, bool share_scenario)
+		{
+			auto actions = mdp->AllowedActions(root);
+			std::vector<DynaPlex::Trajectory> trajectories(actions.size());
+			auto scenario = mdp->CreateEventScenario();
+			for (size_t i = 0; i < actions.size(); i++)
+			{
+				trajectories[i].RNGProvider.SeedEventStreams(false, 1234, 17, 3);
+				if (share_scenario)
+					trajectories[i].RNGProvider.AttachScenario(scenario);
+				trajectories[i].NextAction = actions[i];
+			}
+			mdp->InitiateState(trajectories, root);
+			mdp->IncorporateAction(trajectories);
+			mdp->Evolve(trajectories, policy, 25);
+			std::vector<double> returns;
+			for (auto& traj : trajectories)
+				returns.push_back(traj.CumulativeReturn);
+			return returns;
+		}
+	}
+
+	TEST(EventScenario, replay_matches_drawing) {
+		auto& dp = DynaPlexProvider::Get();
+		DynaPlex::VarGroup config{ {"id","lost_sales"},{"p",9.0},{"h",1.0},{"leadtime",2},
+			{"demand_dist",DynaPlex::VarGroup({{"type","poisson"},{"mean",4.0}})} };
+		auto mdp = dp.GetMDP(config);
+		auto policy = mdp->GetPolicy("base_stock");
+		ASSERT_TRUE(mdp->SupportsEventScenarios());
+		ASSERT_NE(mdp->CreateEventScenario(), nullptr);
+
+		DynaPlex::Trajectory traj{};
+		traj.RNGProvider.SeedEventStreams(false, 1234, 5);
+		mdp->InitiateState({ &traj,1 });
+		mdp->Evolve({ &traj,1 }, policy, 10);
+		mdp->IncorporateUntilAction({ &traj,1 });
+		auto root = traj.GetState()->Clone();
+		ASSERT_GT(mdp->AllowedActions(root).size(), 1);
+
+		auto drawn = RolloutAllActions(mdp, policy, root, false);
+		auto replayed = RolloutAllActions(mdp, policy, root, true);
+		EXPECT_EQ(drawn, replayed);
+
+		//events come from the scenario, not from the streams of the trajectory:
+		auto scenario = mdp->CreateEventScenario();
+		std::vector<DynaPlex::Trajectory> pair(2);
+		for (int64_t i = 0; i < 2; i++)
+		{
+			pair[i].RNGProvider.SeedEventStreams(false, 1234, 17, 3 + i);
+			pair[i].RNGProvider.AttachScenario(scenario);
+		}
+		mdp->InitiateState(pair, root);
+		mdp->Evolve(pair, policy, 25);
+		EXPECT_EQ(pair[0].CumulativeReturn, pair[1].CumulativeReturn);
+
+		//seeding detaches the scenario:
+		traj.RNGProvider.AttachScenario(mdp->CreateEventScenario());
+		EXPECT_NE(traj.RNGProvider.Scenario(), nullptr);
+		traj.RNGProvider.SeedEventStreams(false, 1234, 6);
+		EXPECT_EQ(traj.RNGProvider.Scenario(), nullptr);
+	}
+}
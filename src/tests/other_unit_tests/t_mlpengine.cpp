@@ -0,0 +1,238 @@
+#include <cmath>
+#include <vector>
+#include "dynaplex/error.h"
+#include "dynaplex/mlpengine.h"
+#include "dynaplex/dynaplexprovider.h"
+#include "dynaplex/trajectory.h"
+#include "dynaplex/policytrainer.h"
+#include "dynaplex/samplegenerator.h"
+#include "dynaplex/rng.h"
+#include <gtest/gtest.h>
+
+namespace DynaPlex::Tests {
+
+	namespace {
+		std::vector<DynaPlex::NN::MLPEngine::Layer> RandomLayers(const std::vector<int64_t>& sizes, DynaPlex::RNG& rng)
+		{
+			std::vector<DynaPlex::NN::MLPEngine::Layer> layers;
+			for (size_t l = 0; l + 1 < sizes.size(); l++)
+			{
+				DynaPlex::NN::MLPEngine::Layer layer{ sizes[l], sizes[l + 1], std::vector<float>(sizes[l] * sizes[l + 1]), std::vector<float>(sizes[l + 1]) };
+				for (auto& weight : layer.weights)
+					weight = static_cast<float>(rng.genUniform() - 0.5);
+				for (auto& bias : layer.bias)
+					bias = static_cast<float>(rng.genUniform() - 0.5);
+				layers.push_back(std::move(layer));
+			}
+			return layers;
+		}
+
+		//straightforward evaluation, in double precision.
+		std::vector<double> Reference(const std::vector<DynaPlex::NN::MLPEngine::Layer>& layers, const std::vector<float>& inputs, int64_t rows)
+		{
+			std::vector<double> current(inputs.begin(), inputs.end());
+			for (size_t l = 0; l < layers.size(); l++)
+			{
+				const auto& layer = layers[l];
+				std::vector<double> next(rows * layer.num_outputs);
+				for (int64_t r = 0; r < rows; r++)
+					for (int64_t o = 0; o < layer.num_outputs; o++)
+					{
+						double value = layer.bias[o];
+						for (int64_t i = 0; i < layer.num_inputs; i++)
+							value += layer.weights[o * layer.num_inputs + i] * current[r * layer.num_inputs + i];
+						next[r * layer.num_outputs + o] = (l + 1 < layers.size()) ? std::max(value, 0.0) : value;
+					}
+				current = std::move(next);
+			}
+			return current;
+		}
+	}
+
+	TEST(MLPEngine, matches_reference) {
+		auto& system = DynaPlexProvider::Get().System();
+		DynaPlex::RNG rng{ false, 1234, 0, 0, 0 };
+		auto layers = RandomLayers({ 7, 33, 18, 5 }, rng);
+		DynaPlex::NN::MLPEngine engine(layers);
+		EXPECT_EQ(engine.NumInputs(), 7);
+		EXPECT_EQ(engine.NumOutputs(), 5);
+
+		for (int64_t rows : { 0, 1, 3, 13 })
+		{
+			std::vector<float> inputs(rows * 7);
+			for (auto& input : inputs)
+				input = static_cast<float>(4.0 * rng.genUniform() - 2.0);
+			std::vector<float> outputs(rows * 5);
+			engine.Forward(inputs, rows, outputs);
+			auto expected = Reference(layers, inputs, rows);
+			for (size_t i = 0; i < outputs.size(); i++)
+				EXPECT_NEAR(outputs[i], expected[i], 1e-4);
+		}
+
+		//saving and loading preserves the network:
+		auto path = system.filepath("tests", "mlpengine", "network.mlp");
+		engine.Save(path);
+		auto loaded = DynaPlex::NN::MLPEngine::Load(path);
+		auto loaded_layers = loaded.Layers();
+		ASSERT_EQ(loaded_layers.size(), layers.size());
+		for (size_t l = 0; l < layers.size(); l++)
+		{
+			EXPECT_EQ(loaded_layers[l].weights, layers[l].weights);
+			EXPECT_EQ(loaded_layers[l].bias, layers[l].bias);
+		}
+
+		//layers must connect, and inputs must consist of complete rows:
+		auto mismatched = layers;
+		mismatched[1].num_inputs = 32;
+		EXPECT_THROW(DynaPlex::NN::MLPEngine{ mismatched }, DynaPlex::Error);
+		std::vector<float> too_few(6), outputs(5);
+		EXPECT_THROW(engine.Forward(too_few, 1, outputs), DynaPlex::Error);
+		EXPECT_THROW(DynaPlex::NN::MLPEngine::Load(system.filepath("mdp_config_examples", "lost_sales", "mdp_config_0.json")), DynaPlex::Error);
+	}
+
+	TEST(MLPEngine, torch_free_policy) {
+		auto& dp = DynaPlexProvider::Get();
+		auto& system = dp.System();
+		auto mdp = dp.GetMDP(VarGroup::LoadFromFile(system.filepath("mdp_config_examples", "lost_sales", "mdp_config_0.json")));
+		DynaPlex::RNG rng{ false, 4321, 0, 0, 0 };
+		auto layers = RandomLayers({ mdp->NumFlatFeatures(), 8, mdp->NumValidActions() }, rng);
+		DynaPlex::NN::MLPEngine engine(layers);
+
+		//files as written by TrainedPolicyProvider::SavePolicy for an mlp network:
+		auto path = system.filepath("tests", "mlpengine", "policy");
+		engine.Save(System::SetFileExtension(path, "mlp"));
+		DynaPlex::VarGroup policy_config{ {"id","NN_Policy"},{"gen",1},
+			{"nn_architecture",DynaPlex::VarGroup{{"type","mlp"},{"hidden_layers",DynaPlex::VarGroup::Int64Vec{8}}}},
+			{"num_inputs",mdp->NumFlatFeatures()},{"num_outputs",mdp->NumValidActions()} };
+		policy_config.SaveToFile(System::SetFileExtension(path, "json"), 1);
+
+		auto policy = dp.LoadPolicy(mdp, path, VarGroup{ {"engine","native"} });
+		auto batched_policy = dp.LoadPolicy(mdp, path, VarGroup{ {"engine","native"},{"batch_across_threads",true} });
+
+		std::vector<DynaPlex::Trajectory> trajectories(16);
+		for (int64_t i = 0; i < 16; i++)
+			trajectories[i].RNGProvider.SeedEventStreams(false, 1234, i);
+		mdp->InitiateState(trajectories);
+		mdp->Evolve(trajectories, mdp->GetPolicy("base_stock"), 5);
+		mdp->IncorporateUntilAction(trajectories);
+
+		//the action is the allowed action with the highest score:
+		std::vector<float> features(16 * mdp->NumFlatFeatures()), scores(16 * mdp->NumValidActions());
+		mdp->GetFlatFeatures(trajectories, features);
+		engine.Forward(features, 16, scores);
+		policy->SetAction(trajectories);
+		for (int64_t i = 0; i < 16; i++)
+		{
+			int64_t best = -1;
+			for (int64_t action = 0; action < mdp->NumValidActions(); action++)
+				if (mdp->IsAllowedAction(trajectories[i].GetState(), action) && (best < 0 || scores[i * mdp->NumValidActions() + action] > scores[i * mdp->NumValidActions() + best]))
+					best = action;
+			EXPECT_EQ(trajectories[i].NextAction, best);
+		}
+		std::vector<int64_t> actions;
+		for (auto& trajectory : trajectories)
+			actions.push_back(trajectory.NextAction);
+		batched_policy->SetAction(trajectories);
+		for (int64_t i = 0; i < 16; i++)
+			EXPECT_EQ(trajectories[i].NextAction, actions[i]);
+
+		//the policy can be compared with other policies, and saved again:
+		auto comparer = dp.GetPolicyComparer(mdp, VarGroup{ {"number_of_trajectories",4},{"periods_per_trajectory",20} });
+		EXPECT_NO_THROW(comparer.Assess(policy));
+		auto resaved_path = system.filepath("tests", "mlpengine", "policy_resaved");
+		dp.SavePolicy(policy, resaved_path);
+		EXPECT_EQ(DynaPlex::NN::MLPEngine::Load(System::SetFileExtension(resaved_path, "mlp")).Layers()[0].weights, layers[0].weights);
+
+		EXPECT_THROW(dp.LoadPolicy(mdp, path, VarGroup{ {"engine","other"} }), DynaPlex::Error);
+	}
+
+	TEST(MLPEngine, quantized_precisions) {
+		DynaPlex::RNG rng{ false, 5678, 0, 0, 0 };
+		auto layers = RandomLayers({ 11, 40, 24, 6 }, rng);
+		DynaPlex::NN::MLPEngine engine(layers);
+		int64_t rows = 37;
+		std::vector<float> inputs(rows * 11);
+		for (auto& input : inputs)
+			input = static_cast<float>(4.0 * rng.genUniform() - 2.0);
+		auto expected = Reference(layers, inputs, rows);
+
+		EXPECT_THROW(DynaPlex::NN::MLPEngine::PrecisionFromString("fp16"), DynaPlex::Error);
+		EXPECT_THROW(engine.SetPrecision(DynaPlex::NN::MLPEngine::Precision::Int8), DynaPlex::Error);
+		auto input_ranges = engine.InputRanges(inputs, rows);
+		ASSERT_EQ(input_ranges.size(), layers.size());
+
+		for (auto precision : { "bf16","int8" })
+		{
+			auto quantized = engine;
+			quantized.SetPrecision(DynaPlex::NN::MLPEngine::PrecisionFromString(precision), input_ranges);
+			EXPECT_EQ(DynaPlex::NN::MLPEngine::ToString(quantized.GetPrecision()), precision);
+			std::vector<float> outputs(rows * 6);
+			quantized.Forward(inputs, rows, outputs);
+			double largest = 0.0, largest_error = 0.0;
+			for (size_t i = 0; i < outputs.size(); i++)
+			{
+				largest = std::max(largest, std::abs(expected[i]));
+				largest_error = std::max(largest_error, std::abs(outputs[i] - expected[i]));
+			}
+			EXPECT_LT(largest_error, 0.05 * largest) << precision;
+			//weights are saved in float32, regardless of precision:
+			EXPECT_EQ(quantized.Layers()[0].weights, layers[0].weights);
+		}
+	}
+
+	TEST(MLPEngine, quantized_policy) {
+		auto& dp = DynaPlexProvider::Get();
+		auto& system = dp.System();
+		auto mdp = dp.GetMDP(VarGroup::LoadFromFile(system.filepath("mdp_config_examples", "lost_sales", "mdp_config_0.json")));
+		DynaPlex::RNG rng{ false, 8765, 0, 0, 0 };
+		auto layers = RandomLayers({ mdp->NumFlatFeatures(), 32, mdp->NumValidActions() }, rng);
+		DynaPlex::NN::MLPEngine engine(layers);
+
+		//a float32 policy of generation 1, at the location where PolicyTrainer::TrainPolicy saves it:
+		DynaPlex::VarGroup nn_architecture{ {"type","mlp"},{"hidden_layers",DynaPlex::VarGroup::Int64Vec{32}} };
+		auto path = system.filepath(mdp->Identifier(), "dcl_policy_gen1");
+		engine.Save(System::SetFileExtension(path, "mlp"));
+		DynaPlex::VarGroup{ {"id","NN_Policy"},{"gen",1},{"nn_architecture",nn_architecture},
+			{"num_inputs",mdp->NumFlatFeatures()},{"num_outputs",mdp->NumValidActions()} }.SaveToFile(System::SetFileExtension(path, "json"), 1);
+
+		auto samples_path = system.filepath("tests", "mlpengine", "samples.dpsf");
+		DynaPlex::DCL::SampleGenerator generator(system, mdp, VarGroup{ {"N",40},{"M",4},{"H",3},{"silent",true},{"sample_file_format","binary"} });
+		generator.GenerateSamples(mdp->GetPolicy("base_stock"), samples_path);
+
+		DynaPlex::NN::PolicyTrainer trainer(system, mdp, VarGroup{ {"calibration_samples",16} }, 1234);
+		EXPECT_THROW(trainer.QuantizePolicy(nn_architecture, 1, samples_path, "float32", true), DynaPlex::Error);
+		for (std::string precision : { "bf16","int8" })
+		{
+			auto quantization = trainer.QuantizePolicy(nn_architecture, 1, samples_path, precision, true);
+			double action_agreement;
+			quantization.Get("action_agreement", action_agreement);
+			EXPECT_GT(action_agreement, 0.9) << precision;
+
+			auto policy = trainer.LoadPolicy(nn_architecture, 1, VarGroup{ {"precision",precision} });
+			EXPECT_THROW(trainer.LoadPolicy(nn_architecture, 1, VarGroup{ {"precision",precision},{"engine","torch"} }), DynaPlex::Error);
+			DynaPlex::VarGroup::DoubleVec input_ranges;
+			quantization.Get("input_ranges", input_ranges);
+			auto quantized = engine;
+			quantized.SetPrecision(DynaPlex::NN::MLPEngine::PrecisionFromString(precision), std::vector<float>(input_ranges.begin(), input_ranges.end()));
+
+			std::vector<DynaPlex::Trajectory> trajectories(8);
+			for (int64_t i = 0; i < 8; i++)
+				trajectories[i].RNGProvider.SeedEventStreams(false, 4321, i);
+			mdp->InitiateState(trajectories);
+			mdp->Evolve(trajectories, mdp->GetPolicy("base_stock"), 5);
+			mdp->IncorporateUntilAction(trajectories);
+			std::vector<float> features(8 * mdp->NumFlatFeatures()), scores(8 * mdp->NumValidActions());
+			mdp->GetFlatFeatures(trajectories, features);
+			quantized.Forward(features, 8, scores);
+			policy->SetAction(trajectories);
+			for (int64_t i = 0; i < 8; i++)
+			{
+				int64_t best = -1;
+				for (int64_t action = 0; action < mdp->NumValidActions(); action++)
+					if (mdp->IsAllowedAction(trajectories[i].GetState(), action) && (best < 0 || scores[i * mdp->NumValidActions() + action] > scores[i * mdp->NumValidActions() + best]))
+						best = action;
+				EXPECT_EQ(trajectories[i].NextAction, best) << precision;
+			}
+		}
+	}
+}
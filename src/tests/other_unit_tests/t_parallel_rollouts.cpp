@@ -0,0 +1,66 @@
+#include "dynaplex/vargroup.h"
+#include "dynaplex/error.h"
+#include <gtest/gtest.h>
+#include "dynaplex/dynaplexprovider.h"
+#include "dynaplex/trajectory.h"
+#include "dynaplex/sample.h"
+#include "dynaplex/sequentialhalving.h"
+#include "dynaplex/uniformactionselector.h"
+#include "dynaplex/threadpool.h"
+
+namespace DynaPlex::Tests {
+
+	namespace {
+		DynaPlex::MDP GetLostSalesMDP()
+		{
+			DynaPlex::VarGroup config;
+			config.Add("id", "lost_sales");
+			config.Add("p", 9.0);
+			config.Add("h", 1.0);
+			config.Add("leadtime", 2);
+			config.Add("demand_dist", DynaPlex::VarGroup({
+				{"type", "poisson"},
+				{"mean", 4.0}
+				}));
+			return DynaPlexProvider::Get().GetMDP(config);
+		}
+
+		template<typename t_Selector>
+		DynaPlex::NN::Sample Select(DynaPlex::MDP& mdp, DynaPlex::Policy& policy, DynaPlex::Parallel::ThreadPool* pool)
+		{
+			t_Selector selector(1234, 10, 300, mdp, policy, pool);
+			DynaPlex::Trajectory traj{};
+			traj.RNGProvider.SeedEventStreams(false, 1234, 5);
+			mdp->InitiateState({ &traj,1 });
+			mdp->IncorporateUntilAction({ &traj,1 });
+			for (int64_t period = 0; period < 20; period++)
+			{
+				mdp->IncorporateAction({ &traj,1 }, policy);
+				mdp->IncorporateUntilAction({ &traj,1 });
+			}
+			DynaPlex::NN::Sample sample{};
+			selector.SetAction(traj, sample, 17);
+			return sample;
+		}
+	}
+
+	TEST(ParallelRollouts, results_identical_to_sequential) {
+		auto mdp = GetLostSalesMDP();
+		auto policy = mdp->GetPolicy("base_stock");
+		DynaPlex::Parallel::ThreadPool pool(3);
+
+		auto sequential = Select<DynaPlex::DCL::SequentialHalving>(mdp, policy, nullptr);
+		auto parallel = Select<DynaPlex::DCL::SequentialHalving>(mdp, policy, &pool);
+		EXPECT_EQ(sequential.action_label, parallel.action_label);
+		EXPECT_EQ(sequential.q_hat_vec, parallel.q_hat_vec);
+		EXPECT_EQ(sequential.probabilities, parallel.probabilities);
+		EXPECT_EQ(sequential.q_hat, parallel.q_hat);
+
+		sequential = Select<DynaPlex::DCL::UniformActionSelector>(mdp, policy, nullptr);
+		parallel = Select<DynaPlex::DCL::UniformActionSelector>(mdp, policy, &pool);
+		EXPECT_EQ(sequential.action_label, parallel.action_label);
+		EXPECT_EQ(sequential.q_hat_vec, parallel.q_hat_vec);
+		EXPECT_EQ(sequential.cost_improvement, parallel.cost_improvement);
+		EXPECT_EQ(sequential.z_stat, parallel.z_stat);
+	}
+}
@@ -10,6 +10,47 @@
 #include "dynaplex/erasure/makegeneric.h"
 
 namespace DynaPlex::Tests {
+	namespace {
+		//forwards to another policy, but hides its type, such that MDP->Evolve must use the generic path.
+		class ForwardingPolicy : public DynaPlex::PolicyInterface
+		{
+			DynaPlex::Policy inner;
+		public:
+			explicit ForwardingPolicy(DynaPlex::Policy inner) : inner{ inner } {}
+			std::string TypeIdentifier() const override { return inner->TypeIdentifier(); }
+			const DynaPlex::VarGroup& GetConfig() const override { return inner->GetConfig(); }
+			void SetAction(std::span<Trajectory> trajectories) const override { inner->SetAction(trajectories); }
+		};
+
+		//evolves trajectories with both the fused and the generic path, and checks that the outcomes are identical. 
+		void CheckFusedEvolveMatchesGeneric(DynaPlex::MDP& mdp, DynaPlex::Policy policy, int64_t max_periods)
+		{
+			const int64_t num_traj = 64;
+			std::vector<DynaPlex::Trajectory> fused, generic;
+			for (int64_t i = 0; i < num_traj; i++)
+			{
+				fused.emplace_back(i);
+				fused.back().RNGProvider.SeedEventStreams(true, 4321, i);
+				generic.emplace_back(i);
+				generic.back().RNGProvider.SeedEventStreams(true, 4321, i);
+			}
+			mdp->InitiateState(fused);
+			mdp->InitiateState(generic);
+			mdp->Evolve(fused, policy, max_periods);
+			mdp->Evolve(generic, std::make_shared<ForwardingPolicy>(policy), max_periods);
+			//the generic path may reorder trajectories
+			std::sort(generic.begin(), generic.end(), [](const auto& a, const auto& b) {return a.ExternalIndex < b.ExternalIndex; });
+			for (int64_t i = 0; i < num_traj; i++)
+			{
+				ASSERT_EQ(fused[i].ExternalIndex, i);
+				EXPECT_EQ(fused[i].CumulativeReturn, generic[i].CumulativeReturn);
+				EXPECT_EQ(fused[i].PeriodCount, generic[i].PeriodCount);
+				EXPECT_EQ(fused[i].Category, generic[i].Category);
+				EXPECT_TRUE(mdp->StatesAreEqual(fused[i].GetState(), generic[i].GetState()));
+			}
+		}
+	}
+
 	namespace AddOn::ProblemWithNonStandardDurations {
 		class MDP
 		{
@@ -216,4 +257,35 @@ namespace DynaPlex::Tests {
 		auto assessment = evaluator.Assess(policy);
 		//std::cout << assessment.Dump() << std::endl;
 	}
+
+	TEST(PolicyComparer, fused_evolve_matches_generic)
+	{
+		auto& dp = DynaPlexProvider::Get();
+		DynaPlex::VarGroup config;
+		config.Add("id", "lost_sales");
+		config.Add("p", 9.0);
+		config.Add("h", 1.0);
+		config.Add("leadtime", 3);
+		config.Add("demand_dist", DynaPlex::VarGroup({ {"type", "poisson"},{"mean", 4.0} }));
+		auto mdp = dp.GetMDP(config);
+		CheckFusedEvolveMatchesGeneric(mdp, mdp->GetPolicy("base_stock"), 50);
+		CheckFusedEvolveMatchesGeneric(mdp, mdp->GetPolicy("random"), 50);
+
+		//multiple actions per period, several event streams and a final state. 
+		auto custom_mdp = DynaPlex::Erasure::MakeGenericMDP<AddOn::ProblemWithNonStandardDurations::MDP>(
+			VarGroup{ {"id","customclass"},{"discount_factor",1.0},{"finite_horizon",true},{"reported_finite_horizon",true} }
+		);
+		CheckFusedEvolveMatchesGeneric(custom_mdp, custom_mdp->GetPolicy("random"), 100);
+
+		//policies can only act on states of the mdp they were obtained from
+		config.Set("p", 19.0);
+		auto other_mdp = dp.GetMDP(config);
+		std::vector<DynaPlex::Trajectory> trajectories(4);
+		for (auto& traj : trajectories)
+			traj.RNGProvider.SeedEventStreams(true);
+		mdp->InitiateState(trajectories);
+		EXPECT_THROW(other_mdp->Evolve(trajectories, mdp->GetPolicy("base_stock"), 10), DynaPlex::Error);
+		EXPECT_THROW(mdp->Evolve(trajectories, other_mdp->GetPolicy("base_stock"), 10), DynaPlex::Error);
+		EXPECT_THROW(other_mdp->Evolve(trajectories, other_mdp->GetPolicy("base_stock"), 10), DynaPlex::Error);
+	}
 }
\ No newline at end of file
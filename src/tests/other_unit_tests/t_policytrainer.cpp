@@ -0,0 +1,40 @@
+#include <span>
+#include <vector>
+#include "dynaplex/vargroup.h"
+#include "dynaplex/error.h"
+#include <gtest/gtest.h>
+#include "dynaplex/dynaplexprovider.h"
+#include "dynaplex/policytrainer.h"
+namespace DynaPlex::Tests {
+
+	TEST(PolicyTrainer, data_parallel_requires_all_reduce) {
+		auto& dp = DynaPlexProvider::Get();
+		auto& system = dp.System();
+		auto mdp = dp.GetMDP(VarGroup::LoadFromFile(system.filepath("mdp_config_examples", "lost_sales", "mdp_config_0.json")));
+		DynaPlex::VarGroup nn_training{ {"data_parallel",true} };
+
+		//a single process sums over itself:
+		std::vector<float> buffer{ 1.0f, -2.5f };
+		EXPECT_TRUE(system.SupportsAllReduce());
+		system.AllReduceSum(buffer);
+		EXPECT_EQ(buffer, (std::vector<float>{ 1.0f, -2.5f }));
+		EXPECT_NO_THROW(DynaPlex::NN::PolicyTrainer(system, mdp, nn_training, 0));
+
+		//without message passing, multiple processes cannot train data-parallel:
+		DynaPlex::System without_all_reduce(false, 0, 2, nullptr);
+		EXPECT_FALSE(without_all_reduce.SupportsAllReduce());
+		EXPECT_THROW(without_all_reduce.AllReduceSum(buffer), DynaPlex::Error);
+		EXPECT_THROW(DynaPlex::NN::PolicyTrainer(without_all_reduce, mdp, nn_training, 0), DynaPlex::Error);
+		EXPECT_NO_THROW(DynaPlex::NN::PolicyTrainer(without_all_reduce, mdp, VarGroup{}, 0));
+
+		//emulates two processes with equal buffers:
+		DynaPlex::System with_all_reduce(false, 1, 2, nullptr, nullptr, nullptr, [](std::span<float> values) {
+			for (auto& value : values)
+				value *= 2.0f;
+			});
+		EXPECT_TRUE(with_all_reduce.SupportsAllReduce());
+		with_all_reduce.AllReduceSum(buffer);
+		EXPECT_EQ(buffer, (std::vector<float>{ 2.0f, -5.0f }));
+		EXPECT_TRUE(DynaPlex::NN::PolicyTrainer(with_all_reduce, mdp, nn_training, 0).DataParallel());
+	}
+}
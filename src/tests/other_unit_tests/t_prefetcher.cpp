@@ -0,0 +1,53 @@
+#include <atomic>
+#include <vector>
+#include "dynaplex/error.h"
+#include "dynaplex/prefetcher.h"
+#include <gtest/gtest.h>
+
+namespace DynaPlex::Tests {
+
+	TEST(Prefetcher, in_order_and_bounded) {
+		const int64_t count = 200, capacity = 3;
+		std::atomic<int64_t> produced = 0, consumed = 0, largest_lead = 0;
+		auto produce = [&](int64_t index) {
+			int64_t lead = ++produced - consumed;
+			int64_t largest = largest_lead;
+			while (lead > largest && !largest_lead.compare_exchange_weak(largest, lead));
+			return std::vector<int64_t>(3, index);
+			};
+		for (int64_t num_threads : {1, 4})
+		{
+			produced = 0;
+			consumed = 0;
+			largest_lead = 0;
+			DynaPlex::NN::Prefetcher<std::vector<int64_t>> prefetcher(produce, count, capacity, num_threads);
+			for (int64_t i = 0; i < count; i++)
+			{
+				EXPECT_EQ(prefetcher.Next(), std::vector<int64_t>(3, i));
+				consumed++;
+			}
+			EXPECT_THROW(prefetcher.Next(), DynaPlex::Error);
+			//besides the items that are waiting, one item per thread may be produced:
+			EXPECT_LE(largest_lead, capacity + num_threads);
+		}
+
+		//without capacity, items are produced on demand:
+		DynaPlex::NN::Prefetcher<int64_t> on_demand([](int64_t index) { return 2 * index; }, 2, 0);
+		EXPECT_EQ(on_demand.Next(), 0);
+		EXPECT_EQ(on_demand.Next(), 2);
+	}
+
+	TEST(Prefetcher, forwards_exceptions) {
+		auto produce = [](int64_t index) {
+			if (index == 2)
+				throw DynaPlex::Error("cannot produce");
+			return index;
+			};
+		DynaPlex::NN::Prefetcher<int64_t> prefetcher(produce, 10, 4, 2);
+		EXPECT_EQ(prefetcher.Next(), 0);
+		EXPECT_EQ(prefetcher.Next(), 1);
+		EXPECT_THROW(prefetcher.Next(), DynaPlex::Error);
+		//destroying a prefetcher that was not drained does not block.
+		DynaPlex::NN::Prefetcher<int64_t> abandoned(produce, 1000, 4, 2);
+	}
+}
@@ -209,5 +209,121 @@ namespace DynaPlex::Tests {
 		EXPECT_NEAR(significance * tries, independence_failures_90, 0.03 * tries);
 	}
 
+	TEST(rng, generators) {
+		//all-zero seed; also the key of the Random123 known-answer test for Philox4x32-10
+		DynaPlex::RNG xoshiro(false, 0, 0, 0, 0);
+		XoshiroCpp::Xoshiro256PlusPlus reference(0);
+		for (size_t i = 0; i < 100; i++)
+			ASSERT_EQ(xoshiro.gen()(), reference());
+
+		DynaPlex::RNG philox(false, 0, 0, 0, 0, DynaPlex::RNG::Generator::Philox);
+		EXPECT_EQ(philox.gen()(), 0xe169c58d6627e8d5ull);
+		EXPECT_EQ(philox.gen()(), 0x9b00dbd8bc57ac4cull);
+
+		//skip-ahead
+		for (DynaPlex::RNG::Generator generator : { DynaPlex::RNG::Generator::Xoshiro, DynaPlex::RNG::Generator::Philox })
+		{
+			for (uint64_t offset = 0; offset < 3; offset++)
+				for (uint64_t n = 0; n < 6; n++)
+				{
+					DynaPlex::RNG stepped(false, 123, 4, 5, 6, generator), skipped(false, 123, 4, 5, 6, generator);
+					for (uint64_t i = 0; i < offset; i++)
+					{
+						stepped.genInt();
+						skipped.genInt();
+					}
+					for (uint64_t i = 0; i < n; i++)
+						stepped.genInt();
+					skipped.gen().Discard(n);
+					ASSERT_EQ(stepped.genInt(), skipped.genInt());
+				}
+		}
+	}
+
+	TEST(rngprovider, counter_based) {
+		DynaPlex::RNGProvider provider{}, provider2{};
+		provider.SeedEventStreams(true, 123, 7, 8, DynaPlex::RNG::Generator::Philox);
+		provider2.SeedEventStreams(true, 123, 7, 8, DynaPlex::RNG::Generator::Philox);
+		//streams are independent of the order in which they are first requested
+		auto& late_event = provider2.GetEventRNG(9);
+		auto& early_event = provider2.GetEventRNG(1);
+		DynaPlex::RNG direct(true, 123, 7, 8, 3, DynaPlex::RNG::Generator::Philox);
+		for (size_t i = 0; i < 10; i++)
+		{
+			auto value = provider.GetEventRNG(1).genUniform();
+			EXPECT_EQ(value, early_event.genUniform());
+			EXPECT_EQ(value, direct.genUniform());
+			EXPECT_EQ(provider.GetEventRNG(9).genInt(), late_event.genInt());
+		}
+		EXPECT_NE(provider.GetPolicyRNG().genInt(), provider.GetInitiationRNG().genInt());
+
+		//reseeding restarts the streams
+		provider.SeedEventStreams(true, 123, 7, 8, DynaPlex::RNG::Generator::Philox);
+		DynaPlex::RNG direct2(true, 123, 7, 8, 3, DynaPlex::RNG::Generator::Philox);
+		EXPECT_EQ(provider.GetEventRNG(1).genInt(), direct2.genInt());
+
+		EXPECT_THROW(provider.SeedEventStreams(false, 123, 1ll << 30), DynaPlex::Error);
+
+		int64_t rng_seed = 123123;
+		int number_of_samples = 1000;
+		auto uniformity_failures = 0;
+		auto tries = 200;
+		auto significance = 0.1;
+		for (size_t i = 0; i < tries; i++)
+		{
+			std::vector<double> first_drawn_numbers;
+			first_drawn_numbers.reserve(number_of_samples);
+			for (int sample = 0; sample < number_of_samples; ++sample) {
+				DynaPlex::RNGProvider provider{};
+				provider.SeedEventStreams(false, rng_seed, sample, i, DynaPlex::RNG::Generator::Philox);
+				first_drawn_numbers.push_back(provider.GetEventRNG(0).genUniform());
+			}
+			if (!isUniform(first_drawn_numbers, significance))
+				uniformity_failures++;
+		}
+		EXPECT_NEAR(significance * tries, uniformity_failures, 0.05 * tries);
+	}
 
+	TEST(rng, fill_uniform) {
+		DynaPlex::RNG rng(false, 1, 2, 3, 4), rng2(false, 1, 2, 3, 4);
+		std::vector<double> values(37);
+		rng.FillUniform(values);
+		for (double value : values)
+			ASSERT_EQ(value, rng2.genUniform());
+
+		//reference: lane j is a xoshiro256++ generator with state taken from outputs 4j,...,4j+3 of splitmix64(seed)
+		const uint64_t seed = 987654321;
+		const size_t lanes = DynaPlex::MultiLaneRNG::Lanes;
+		XoshiroCpp::SplitMix64 splitmix{ seed };
+		std::vector<XoshiroCpp::Xoshiro256PlusPlus> reference;
+		for (size_t j = 0; j < lanes; j++)
+		{
+			XoshiroCpp::Xoshiro256PlusPlus::state_type state;
+			for (auto& word : state)
+				word = splitmix();
+			reference.emplace_back(state);
+		}
+		std::vector<double> expected(lanes * 40);
+		for (size_t i = 0; i < expected.size(); i++)
+			expected[i] = ((reference[i % lanes]() >> 12) * 0x1.0p-52);
+
+		//the sequence does not depend on how it is split over calls. 
+		DynaPlex::MultiLaneRNG multi{ seed };
+		std::vector<double> actual;
+		size_t size = 1;
+		while (actual.size() < expected.size())
+		{
+			std::vector<double> part(std::min(size, expected.size() - actual.size()));
+			multi.FillUniform(part);
+			actual.insert(actual.end(), part.begin(), part.end());
+			size = (size * 3) % 29 + 1;
+		}
+		ASSERT_EQ(actual, expected);
+		for (double value : actual)
+		{
+			ASSERT_GE(value, 0.0);
+			ASSERT_LT(value, 1.0);
+		}
+		EXPECT_TRUE(isUniform(actual, 0.001));
+	}
 }
\ No newline at end of file
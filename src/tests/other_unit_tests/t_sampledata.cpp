@@ -5,6 +5,11 @@
 #include "dynaplex/trajectory.h"
 #include "dynaplex/demonstrator.h"
 #include "dynaplex/sampledata.h"
+#include "dynaplex/samplegenerator.h"
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <limits>
 namespace DynaPlex::Tests {
 	
 
@@ -71,4 +76,316 @@ namespace DynaPlex::Tests {
 		//lost_sales starts with action, and alternates between actions and events, never final. Hence, there will be 2*maxevents elements in trace. 
 		ASSERT_EQ(trace.size(), max_periods *2);
 	}
-}
\ No newline at end of file
+
+	TEST(sampledata, gather_on_node_zero) {
+		auto& dp = DynaPlexProvider::Get();
+		auto& system = dp.System();
+		auto mdp_vars = VarGroup::LoadFromFile(system.filepath("mdp_config_examples", "lost_sales", "mdp_config_0.json"));
+		auto mdp = dp.GetMDP(mdp_vars);
+		DynaPlex::Policy policy = mdp->GetPolicy("random");
+		auto io_root = std::filesystem::path(system.IOLocation()).parent_path().string();
+
+		//emulates a run on two nodes: node 1 runs first, node 0 receives what node 1 passed to GatherOnRoot.
+		auto collect_on_two_nodes = [&](bool gather_via_files, const std::string& path) {
+			std::filesystem::remove(path);
+			std::vector<uint8_t> node_1_buffer;
+			DynaPlex::System node_1(false, 1, 2, nullptr, [&](std::span<const uint8_t> buffer) {
+				node_1_buffer.assign(buffer.begin(), buffer.end());
+				return std::vector<std::vector<uint8_t>>{};
+				});
+			DynaPlex::System node_0(false, 0, 2, nullptr, [&](std::span<const uint8_t> buffer) {
+				return std::vector<std::vector<uint8_t>>{ {buffer.begin(), buffer.end()}, node_1_buffer };
+				});
+			node_1.SetIOLocation(io_root, "IO_DynaPlex");
+			node_0.SetIOLocation(io_root, "IO_DynaPlex");
+			DynaPlex::VarGroup config{ {"N",10},{"M",2},{"H",3},{"silent",true},{"gather_via_files",gather_via_files} };
+			DynaPlex::DCL::SampleGenerator(node_1, mdp, config).GenerateStateSamples(policy, path);
+			EXPECT_FALSE(std::filesystem::exists(path));
+			DynaPlex::DCL::SampleGenerator(node_0, mdp, config).GenerateStateSamples(policy, path);
+			return DynaPlex::NN::SampleData::CreateNewFromFile(mdp, path);
+		};
+
+		auto via_files = collect_on_two_nodes(true, system.filepath("tests", "sampledata_gather", "via_files.json"));
+		auto via_gather = collect_on_two_nodes(false, system.filepath("tests", "sampledata_gather", "via_gather.json"));
+		ASSERT_EQ(via_files.Samples.size(), 10);
+		ASSERT_EQ(via_gather.Samples.size(), 10);
+		for (size_t i = 0; i < via_files.Samples.size(); i++)
+		{
+			EXPECT_EQ(via_files.Samples[i].sample_number, via_gather.Samples[i].sample_number);
+			EXPECT_EQ(via_files.Samples[i].action_label, via_gather.Samples[i].action_label);
+			EXPECT_EQ(via_files.Samples[i].q_hat_vec, via_gather.Samples[i].q_hat_vec);
+			EXPECT_TRUE(mdp->StatesAreEqual(via_files.Samples[i].state, via_gather.Samples[i].state));
+		}
+
+		//without message passing, only a single node can gather:
+		DynaPlex::System without_gather(false, 0, 2, nullptr);
+		EXPECT_FALSE(without_gather.SupportsGather());
+		EXPECT_THROW(without_gather.GatherOnRoot({}), DynaPlex::Error);
+		EXPECT_TRUE(system.SupportsGather());
+	}
+
+	TEST(sampledata, dynamic_load_balancing) {
+		auto& dp = DynaPlexProvider::Get();
+		auto& system = dp.System();
+		auto mdp_vars = VarGroup::LoadFromFile(system.filepath("mdp_config_examples", "lost_sales", "mdp_config_0.json"));
+		auto mdp = dp.GetMDP(mdp_vars);
+		DynaPlex::Policy policy = mdp->GetPolicy("random");
+		auto io_root = std::filesystem::path(system.IOLocation()).parent_path().string();
+		int64_t N = 12;
+		DynaPlex::VarGroup config{ {"N",N},{"M",2},{"H",3},{"silent",true},{"load_balancing","dynamic"},{"block_size",2} };
+
+		auto single_path = system.filepath("tests", "sampledata_dynamic", "single_node.json");
+		DynaPlex::DCL::SampleGenerator(system, mdp, config).GenerateStateSamples(policy, single_path);
+		auto single_node = DynaPlex::NN::SampleData::CreateNewFromFile(mdp, single_path);
+
+		//emulates a run on two nodes, where node 1 is slow: it stops claiming blocks after half of the samples are handed out.
+		auto value = std::make_shared<std::atomic<int64_t>>(0);
+		std::vector<uint8_t> node_1_buffer;
+		DynaPlex::System node_1(false, 1, 2, nullptr, [&](std::span<const uint8_t> buffer) {
+			node_1_buffer.assign(buffer.begin(), buffer.end());
+			return std::vector<std::vector<uint8_t>>{};
+			}, [&]() {
+				return std::make_unique<DynaPlex::SharedCounter>([value, N](int64_t increment) {
+					return *value >= N / 2 ? N : value->fetch_add(increment); });
+			});
+		//blocks are claimed one at a time, by a single thread:
+		std::vector<int64_t> increments;
+		DynaPlex::System node_0(false, 0, 2, nullptr, [&](std::span<const uint8_t> buffer) {
+			return std::vector<std::vector<uint8_t>>{ {buffer.begin(), buffer.end()}, node_1_buffer };
+			}, [&]() {
+				return std::make_unique<DynaPlex::SharedCounter>([value, &increments](int64_t increment) {
+					increments.push_back(increment);
+					return value->fetch_add(increment); });
+			});
+		node_1.SetIOLocation(io_root, "IO_DynaPlex");
+		node_0.SetIOLocation(io_root, "IO_DynaPlex");
+		auto two_node_path = system.filepath("tests", "sampledata_dynamic", "two_nodes.json");
+		std::filesystem::remove(two_node_path);
+		DynaPlex::DCL::SampleGenerator(node_1, mdp, config).GenerateStateSamples(policy, two_node_path);
+		EXPECT_FALSE(node_1_buffer.empty());
+		DynaPlex::DCL::SampleGenerator(node_0, mdp, config).GenerateStateSamples(policy, two_node_path);
+		auto two_nodes = DynaPlex::NN::SampleData::CreateNewFromFile(mdp, two_node_path);
+		ASSERT_FALSE(increments.empty());
+		for (int64_t increment : increments)
+			EXPECT_EQ(increment, 2);
+
+		//the samples do not depend on which node collected which block:
+		ASSERT_EQ(single_node.Samples.size(), N);
+		ASSERT_EQ(two_nodes.Samples.size(), N);
+		for (size_t i = 0; i < single_node.Samples.size(); i++)
+		{
+			EXPECT_EQ(single_node.Samples[i].sample_number, two_nodes.Samples[i].sample_number);
+			EXPECT_EQ(single_node.Samples[i].action_label, two_nodes.Samples[i].action_label);
+			EXPECT_EQ(single_node.Samples[i].q_hat_vec, two_nodes.Samples[i].q_hat_vec);
+			EXPECT_TRUE(mdp->StatesAreEqual(single_node.Samples[i].state, two_nodes.Samples[i].state));
+		}
+
+		DynaPlex::VarGroup invalid{ {"load_balancing","round_robin"} };
+		EXPECT_THROW(DynaPlex::DCL::SampleGenerator(system, mdp, invalid), DynaPlex::Error);
+	}
+
+	TEST(sampledata, lockstep_trajectories) {
+		auto& dp = DynaPlexProvider::Get();
+		auto& system = dp.System();
+		auto mdp_vars = VarGroup::LoadFromFile(system.filepath("mdp_config_examples", "lost_sales", "mdp_config_0.json"));
+		auto mdp = dp.GetMDP(mdp_vars);
+		DynaPlex::Policy policy = mdp->GetPolicy("base_stock");
+		int64_t N = 12;
+
+		auto collect = [&](int64_t block_size, int64_t trajectories_per_thread, double sampling_probability) {
+			DynaPlex::VarGroup config{ {"N",N},{"M",2},{"H",3},{"silent",true},{"load_balancing","dynamic"},{"block_size",block_size},
+				{"trajectories_per_thread",trajectories_per_thread},{"sampling_probability",sampling_probability} };
+			auto path = system.filepath("tests", "sampledata_lockstep", "samples.json");
+			DynaPlex::DCL::SampleGenerator(system, mdp, config).GenerateStateSamples(policy, path);
+			return DynaPlex::NN::SampleData::CreateNewFromFile(mdp, path);
+		};
+
+		auto expect_equal = [&](const DynaPlex::NN::SampleData& a, const DynaPlex::NN::SampleData& b) {
+			ASSERT_EQ(a.Samples.size(), N);
+			ASSERT_EQ(b.Samples.size(), N);
+			for (size_t i = 0; i < a.Samples.size(); i++)
+			{
+				EXPECT_EQ(a.Samples[i].sample_number, b.Samples[i].sample_number);
+				EXPECT_EQ(a.Samples[i].action_label, b.Samples[i].action_label);
+				EXPECT_EQ(a.Samples[i].q_hat_vec, b.Samples[i].q_hat_vec);
+				EXPECT_TRUE(mdp->StatesAreEqual(a.Samples[i].state, b.Samples[i].state));
+			}
+		};
+
+		//with K lanes, a block of block_size samples is collected as K blocks of block_size/K samples with a single trajectory each: 
+		for (double sampling_probability : {1.0, 0.3})
+			for (int64_t K : {1, 2, 4})
+				expect_equal(collect(4, K, sampling_probability), collect(4 / K, 1, sampling_probability));
+
+		//hence, for a fixed block_size, the samples depend on the number of lanes:
+		auto one_lane = collect(4, 1, 1.0);
+		auto four_lanes = collect(4, 4, 1.0);
+		bool any_different = false;
+		for (size_t i = 0; i < one_lane.Samples.size(); i++)
+			any_different = any_different || !mdp->StatesAreEqual(one_lane.Samples[i].state, four_lanes.Samples[i].state);
+		EXPECT_TRUE(any_different);
+
+		DynaPlex::VarGroup invalid{ {"trajectories_per_thread",0} };
+		EXPECT_THROW(DynaPlex::DCL::SampleGenerator(system, mdp, invalid), DynaPlex::Error);
+	}
+
+	TEST(sampledata, memoize_states) {
+		auto& dp = DynaPlexProvider::Get();
+		auto& system = dp.System();
+		auto mdp_vars = VarGroup::LoadFromFile(system.filepath("mdp_config_examples", "lost_sales", "mdp_config_0.json"));
+		auto mdp = dp.GetMDP(mdp_vars);
+		ASSERT_TRUE(mdp->SupportsEqualityTest());
+		DynaPlex::Policy policy = mdp->GetPolicy("base_stock");
+
+		DynaPlex::VarGroup config{ {"N",200},{"M",4},{"H",4},{"silent",true},{"memoize_states",true} };
+		auto path = system.filepath("tests", "sampledata_memoize", "samples.json");
+		DynaPlex::DCL::SampleGenerator(system, mdp, config).GenerateStateSamples(policy, path);
+		auto data = DynaPlex::NN::SampleData::CreateNewFromFile(mdp, path);
+		ASSERT_EQ(data.Samples.size(), 200);
+		//the base-stock policy visits few distinct states, so many samples are recalled. 
+		EXPECT_GT(data.NumMemoized(), 0);
+
+		//equal states have equal hashes, and a recalled sample carries the statistics of another sample of an equal state:
+		int64_t num_with_copy = 0;
+		for (size_t i = 0; i < data.Samples.size(); i++)
+		{
+			bool has_copy = false;
+			for (size_t j = 0; j < data.Samples.size(); j++)
+				if (i != j && mdp->StatesAreEqual(data.Samples[i].state, data.Samples[j].state))
+				{
+					EXPECT_EQ(mdp->StateHash(data.Samples[i].state), mdp->StateHash(data.Samples[j].state));
+					if (data.Samples[i].q_hat_vec == data.Samples[j].q_hat_vec && data.Samples[i].action_label == data.Samples[j].action_label)
+						has_copy = true;
+				}
+			if (has_copy)
+				num_with_copy++;
+		}
+		EXPECT_GE(num_with_copy, data.NumMemoized());
+
+		//memos are per lane, and a recalled sample queries the (here: random) base policy as rollouts would, so samples are reproducible:
+		DynaPlex::Policy random_policy = mdp->GetPolicy("random");
+		config.Set("trajectories_per_thread", 3);
+		auto collect = [&]() {
+			DynaPlex::DCL::SampleGenerator(system, mdp, config).GenerateStateSamples(random_policy, path);
+			return DynaPlex::NN::SampleData::CreateNewFromFile(mdp, path);
+			};
+		auto first = collect();
+		auto second = collect();
+		EXPECT_GT(first.NumMemoized(), 0);
+		EXPECT_EQ(first.NumMemoized(), second.NumMemoized());
+		ASSERT_EQ(first.Samples.size(), second.Samples.size());
+		for (size_t i = 0; i < first.Samples.size(); i++)
+		{
+			EXPECT_EQ(first.Samples[i].sample_number, second.Samples[i].sample_number);
+			EXPECT_EQ(first.Samples[i].action_label, second.Samples[i].action_label);
+			EXPECT_EQ(first.Samples[i].q_hat_vec, second.Samples[i].q_hat_vec);
+			EXPECT_TRUE(mdp->StatesAreEqual(first.Samples[i].state, second.Samples[i].state));
+		}
+	}
+
+	namespace {
+		//delegates to policy, and throws once it is called more than limit times. 
+		class CountingPolicy : public DynaPlex::PolicyInterface {
+		public:
+			CountingPolicy(DynaPlex::Policy policy, int64_t limit) : policy{ policy }, limit{ limit } {}
+			std::string TypeIdentifier() const override { return policy->TypeIdentifier(); }
+			const DynaPlex::VarGroup& GetConfig() const override { return policy->GetConfig(); }
+			void SetAction(std::span<DynaPlex::Trajectory> trajectories) const override
+			{
+				if (++calls > limit)
+					throw DynaPlex::Error("CountingPolicy: limit reached");
+				policy->SetAction(trajectories);
+			}
+			mutable std::atomic<int64_t> calls = 0;
+		private:
+			DynaPlex::Policy policy;
+			int64_t limit;
+		};
+	}
+
+	TEST(sampledata, time_out_and_checkpoint) {
+		auto& dp = DynaPlexProvider::Get();
+		auto& system = dp.System();
+		auto mdp_vars = VarGroup::LoadFromFile(system.filepath("mdp_config_examples", "lost_sales", "mdp_config_0.json"));
+		auto mdp = dp.GetMDP(mdp_vars);
+		DynaPlex::Policy base_stock = mdp->GetPolicy("base_stock");
+		//four claims of a block per thread:
+		int64_t N = 4 * system.WorkerPool().NumThreads();
+
+		auto path = system.filepath("tests", "sampledata_checkpoint", "samples.json");
+		auto checkpoint = path + ".checkpoint_node0";
+		std::filesystem::remove(path);
+		std::filesystem::remove(checkpoint);
+		auto collect = [&](int64_t limit, int64_t sampling_time_out, DynaPlex::Policy base_policy = nullptr) {
+			DynaPlex::VarGroup config{ {"N",N},{"M",2},{"H",3},{"silent",true},{"block_size",1},{"checkpoint",true},{"sampling_time_out",sampling_time_out} };
+			auto policy = std::make_shared<CountingPolicy>(base_policy ? base_policy : base_stock, limit);
+			DynaPlex::DCL::SampleGenerator(system, mdp, config).GenerateStateSamples(policy, path);
+			return policy->calls.load();
+		};
+
+		int64_t reference_calls = collect(std::numeric_limits<int64_t>::max(), 3600);
+		auto reference = DynaPlex::NN::SampleData::CreateNewFromFile(mdp, path);
+		ASSERT_EQ(reference.Samples.size(), N);
+		//the checkpoint is removed once all samples are saved:
+		EXPECT_FALSE(std::filesystem::exists(checkpoint));
+
+		//the time-out passes before any sample is collected, and the checkpoint is kept for a later call: 
+		collect(std::numeric_limits<int64_t>::max(), 0);
+		EXPECT_EQ(DynaPlex::NN::SampleData::CreateNewFromFile(mdp, path).Samples.size(), 0);
+		EXPECT_TRUE(std::filesystem::exists(checkpoint));
+
+		//a failure halfway keeps the blocks that completed; a record that is cut off is ignored when resuming: 
+		EXPECT_THROW(collect(reference_calls / 2, 3600), DynaPlex::Error);
+		std::ofstream(checkpoint, std::ios::binary | std::ios::app) << "cut off";
+
+		int64_t resumed_calls = collect(std::numeric_limits<int64_t>::max(), 3600);
+		EXPECT_LT(resumed_calls, reference_calls);
+		EXPECT_FALSE(std::filesystem::exists(checkpoint));
+		auto resumed = DynaPlex::NN::SampleData::CreateNewFromFile(mdp, path);
+		ASSERT_EQ(resumed.Samples.size(), N);
+		for (size_t i = 0; i < resumed.Samples.size(); i++)
+		{
+			EXPECT_EQ(reference.Samples[i].sample_number, resumed.Samples[i].sample_number);
+			EXPECT_EQ(reference.Samples[i].action_label, resumed.Samples[i].action_label);
+			EXPECT_EQ(reference.Samples[i].q_hat_vec, resumed.Samples[i].q_hat_vec);
+			EXPECT_TRUE(mdp->StatesAreEqual(reference.Samples[i].state, resumed.Samples[i].state));
+		}
+
+		//a checkpoint of another policy of the same type is not resumed:
+		auto other_base_stock = mdp->GetPolicy(VarGroup{ {"id","base_stock"},{"base_stock_level",3} });
+		int64_t other_calls = collect(std::numeric_limits<int64_t>::max(), 3600, other_base_stock);
+		EXPECT_THROW(collect(reference_calls / 2, 3600), DynaPlex::Error);
+		EXPECT_EQ(collect(std::numeric_limits<int64_t>::max(), 3600, other_base_stock), other_calls);
+
+		//nor is a checkpoint of a collection with another seed_offset, i.e. a later collection of the same generator:
+		EXPECT_THROW(collect(reference_calls / 2, 3600), DynaPlex::Error);
+		DynaPlex::DCL::SampleGenerator generator(system, mdp, VarGroup{ {"N",N},{"M",2},{"H",3},{"silent",true},{"block_size",1},{"checkpoint",true} });
+		generator.GenerateStateSamples(base_stock, system.filepath("tests", "sampledata_checkpoint", "first_collection.json"));
+		generator.GenerateStateSamples(base_stock, path);
+		for (auto& sample : DynaPlex::NN::SampleData::CreateNewFromFile(mdp, path).Samples)
+			EXPECT_GT(sample.sample_number, N);
+		EXPECT_FALSE(std::filesystem::exists(checkpoint));
+	}
+
+	TEST(sampledata, features_of_generated_samples) {
+		auto& dp = DynaPlexProvider::Get();
+		auto& system = dp.System();
+		auto mdp_vars = VarGroup::LoadFromFile(system.filepath("mdp_config_examples", "lost_sales", "mdp_config_0.json"));
+		auto mdp = dp.GetMDP(mdp_vars);
+		DynaPlex::Policy policy = mdp->GetPolicy("base_stock");
+		DynaPlex::VarGroup config{ {"N",30},{"M",2},{"H",3},{"silent",true} };
+
+		auto state_path = system.filepath("tests", "sampledata_features", "states.json");
+		auto feats_path = system.filepath("tests", "sampledata_features", "feats.json");
+		DynaPlex::DCL::SampleGenerator(system, mdp, config).GenerateStateSamples(policy, state_path);
+		DynaPlex::DCL::SampleGenerator(system, mdp, config).GenerateSamples(policy, feats_path);
+
+		//the features that are computed on the worker threads are those of the collected states, in the same order:
+		auto data = DynaPlex::NN::SampleData::CreateNewFromFile(mdp, state_path);
+		std::vector<DynaPlex::VarGroup> feats;
+		DynaPlex::VarGroup::LoadFromFile(feats_path).Get("samples", feats);
+		ASSERT_EQ(feats.size(), data.Samples.size());
+		for (size_t i = 0; i < feats.size(); i++)
+			EXPECT_EQ(feats[i], data.Samples[i].ToVarGroupWithFeats(mdp));
+	}
+}
@@ -0,0 +1,88 @@
+#include <algorithm>
+#include <filesystem>
+#include "dynaplex/vargroup.h"
+#include "dynaplex/error.h"
+#include <gtest/gtest.h>
+#include "dynaplex/dynaplexprovider.h"
+#include "dynaplex/samplegenerator.h"
+#include "dynaplex/sampledata.h"
+#include "dynaplex/samplefile.h"
+namespace DynaPlex::Tests {
+
+	TEST(SampleFile, matches_state_samples) {
+		auto& dp = DynaPlexProvider::Get();
+		auto& system = dp.System();
+
+		DynaPlex::VarGroup config;
+		config.Add("id", "lost_sales");
+		config.Add("p", 9.0);
+		config.Add("h", 1.0);
+		config.Add("leadtime", 2);
+		config.Add("demand_dist", DynaPlex::VarGroup({
+			{"type", "poisson"},
+			{"mean", 4.0}
+			}));
+		DynaPlex::MDP mdp = dp.GetMDP(config);
+		auto policy = mdp->GetPolicy("base_stock");
+
+		DynaPlex::VarGroup generator_config{
+			{"N",20},
+			{"M",4},
+			{"H",3},
+			{"silent",true }
+		};
+		auto json_path = system.filepath("test", "t_samplefile", "samples.json");
+		DynaPlex::DCL::SampleGenerator json_generator(system, mdp, generator_config);
+		json_generator.GenerateStateSamples(policy, json_path);
+
+		generator_config.Add("sample_file_format", "binary");
+		auto binary_path = system.filepath("test", "t_samplefile", "samples.dpsf");
+		DynaPlex::DCL::SampleGenerator binary_generator(system, mdp, generator_config);
+		binary_generator.GenerateSamples(policy, binary_path);
+
+		EXPECT_TRUE(DynaPlex::NN::SampleFile::IsSampleFile(binary_path));
+		EXPECT_FALSE(DynaPlex::NN::SampleFile::IsSampleFile(json_path));
+		EXPECT_THROW(DynaPlex::NN::SampleFile{ json_path }, DynaPlex::Error);
+
+		auto data = DynaPlex::NN::SampleData::CreateNewFromFile(mdp, json_path);
+		DynaPlex::NN::SampleFile file(mdp, binary_path);
+		ASSERT_EQ(file.NumSamples(), static_cast<int64_t>(data.Samples.size()));
+		ASSERT_EQ(file.NumFeatures(), mdp->NumFlatFeatures());
+		ASSERT_EQ(file.NumValidActions(), mdp->NumValidActions());
+		EXPECT_EQ(file.Identifier(), mdp->Identifier());
+
+		std::vector<float> feats(mdp->NumFlatFeatures());
+		auto A = file.NumValidActions();
+		for (int64_t i = 0; i < file.NumSamples(); i++)
+		{
+			const auto& sample = data.Samples[i];
+			mdp->GetFlatFeatures(sample.state, feats);
+			auto file_feats = file.Features(i);
+			EXPECT_TRUE(std::equal(feats.begin(), feats.end(), file_feats.begin(), file_feats.end()));
+			EXPECT_EQ(file.ActionLabels()[i], sample.action_label);
+			EXPECT_EQ(file.SampleNumbers()[i], sample.sample_number);
+			EXPECT_FLOAT_EQ(file.QHat()[i], static_cast<float>(sample.q_hat));
+
+			auto allowed = mdp->AllowedActions(sample.state);
+			int64_t num_allowed = 0;
+			for (int64_t action = 0; action < A; action++)
+				if (file.Mask()[i * A + action] != 0.0f)
+					num_allowed++;
+			EXPECT_EQ(num_allowed, static_cast<int64_t>(allowed.size()));
+			for (size_t index = 0; index < allowed.size(); index++)
+			{
+				auto entry = i * A + allowed[index];
+				EXPECT_EQ(file.Mask()[entry], 1.0f);
+				EXPECT_FLOAT_EQ(file.CostImprovement()[entry], static_cast<float>(sample.cost_improvement[index]));
+				EXPECT_FLOAT_EQ(file.Probabilities()[entry], static_cast<float>(sample.probabilities[index]));
+			}
+		}
+
+		config.Set("p", 19.0);
+		DynaPlex::MDP other_mdp = dp.GetMDP(config);
+		EXPECT_THROW(DynaPlex::NN::SampleFile(other_mdp, binary_path), DynaPlex::Error);
+
+		std::filesystem::remove(json_path);
+		std::filesystem::remove(binary_path);
+	}
+}
@@ -0,0 +1,75 @@
+#include <atomic>
+#include "dynaplex/vargroup.h"
+#include "dynaplex/error.h"
+#include <gtest/gtest.h>
+#include "dynaplex/dynaplexprovider.h"
+#include "dynaplex/trajectory.h"
+#include "dynaplex/sample.h"
+#include "dynaplex/sequentialhalving.h"
+
+namespace DynaPlex::Tests {
+
+	namespace {
+		//delegates to policy, counting the calls. 
+		class CountingPolicy : public DynaPlex::PolicyInterface {
+		public:
+			explicit CountingPolicy(DynaPlex::Policy policy) : policy{ policy } {}
+			std::string TypeIdentifier() const override { return policy->TypeIdentifier(); }
+			const DynaPlex::VarGroup& GetConfig() const override { return policy->GetConfig(); }
+			void SetAction(std::span<DynaPlex::Trajectory> trajectories) const override
+			{
+				calls += trajectories.size();
+				policy->SetAction(trajectories);
+			}
+			mutable std::atomic<int64_t> calls = 0;
+		private:
+			DynaPlex::Policy policy;
+		};
+	}
+
+	TEST(SequentialHalving, adaptive_budget) {
+		auto& dp = DynaPlexProvider::Get();
+		DynaPlex::VarGroup config{ {"id","lost_sales"},{"p",9.0},{"h",1.0},{"leadtime",2},
+			{"demand_dist",DynaPlex::VarGroup({{"type","poisson"},{"mean",4.0}})} };
+		auto mdp = dp.GetMDP(config);
+		auto counting = std::make_shared<CountingPolicy>(mdp->GetPolicy("base_stock"));
+		DynaPlex::Policy policy = counting;
+
+		DynaPlex::DCL::SequentialHalving fixed(1234, 10, 400, mdp, policy);
+		//stops as soon as differences are fairly clear; the level is corrected for the number of stages, so it is lenient:
+		DynaPlex::DCL::SequentialHalving frugal(1234, 10, 400, mdp, policy, nullptr, 0.5);
+		//only drops clearly worse actions, and spends the budget this saves on the others:
+		DynaPlex::DCL::SequentialHalving thorough(1234, 10, 400, mdp, policy, nullptr, 3.0);
+
+		int64_t fixed_calls = 0, frugal_calls = 0;
+		double fixed_z_stats = 0.0, thorough_z_stats = 0.0;
+		DynaPlex::Trajectory traj{};
+		traj.RNGProvider.SeedEventStreams(false, 1234, 5);
+		mdp->InitiateState({ &traj,1 });
+		for (int64_t period = 0; period < 10; period++)
+		{
+			mdp->IncorporateUntilAction({ &traj,1 });
+			DynaPlex::NN::Sample fixed_sample{}, frugal_sample{}, thorough_sample{};
+			counting->calls = 0;
+			fixed.SetAction(traj, fixed_sample, 17 + period);
+			fixed_calls += counting->calls;
+			counting->calls = 0;
+			frugal.SetAction(traj, frugal_sample, 17 + period);
+			frugal_calls += counting->calls;
+			thorough.SetAction(traj, thorough_sample, 17 + period);
+
+			//labels agree whenever the fixed budget finds the best action with some confidence; frugal may stop before it 
+			//separates close actions, but thorough keeps all actions that are not clearly worse:
+			if (fixed_sample.z_stat > 1.5)
+				EXPECT_EQ(fixed_sample.action_label, thorough_sample.action_label);
+			EXPECT_EQ(frugal_sample.q_hat_vec.size(), mdp->AllowedActions(traj.GetState()).size());
+			fixed_z_stats += fixed_sample.z_stat;
+			thorough_z_stats += thorough_sample.z_stat;
+			mdp->IncorporateAction({ &traj,1 }, policy);
+		}
+		EXPECT_LT(10 * frugal_calls, 9 * fixed_calls);
+		EXPECT_GT(thorough_z_stats, fixed_z_stats);
+
+		EXPECT_THROW(DynaPlex::DCL::SequentialHalving(1234, 10, 400, mdp, policy, nullptr, -1.0), DynaPlex::Error);
+	}
+}
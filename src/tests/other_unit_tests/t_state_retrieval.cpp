@@ -90,5 +90,41 @@ namespace DynaPlex::Tests {
         );
     }
 
-
+    TEST(StateRetrieval, span_entry_points_validate) {
+        auto& dp = DynaPlexProvider::Get();
+        auto& system = dp.System();
+        std::string file_path = system.filepath("mdp_config_examples", "lost_sales", "mdp_config_0.json");
+        auto mdp_vars = VarGroup::LoadFromFile(file_path);
+        auto mdp = dp.GetMDP(mdp_vars);
+        mdp_vars.Set("p", 1234.0);
+        auto other_mdp = dp.GetMDP(mdp_vars);
+
+        std::vector<Trajectory> trajectories(3);
+        for (auto& traj : trajectories)
+            traj.RNGProvider.SeedEventStreams(true, 1);
+        mdp->InitiateState(trajectories);
+        ASSERT_TRUE(mdp->IncorporateUntilAction(trajectories));
+
+        std::vector<float> feats(mdp->NumFlatFeatures() * trajectories.size());
+        size_t mask_size = mdp->NumValidActions() * trajectories.size();
+        auto mask_storage = std::make_unique<bool[]>(mask_size);
+        std::span<bool> mask(mask_storage.get(), mask_size);
+
+        //a single trajectory of another mdp, or a single trajectory in the wrong category, makes the call fail.
+        other_mdp->InitiateState({ &trajectories[1],1 });
+        EXPECT_THROW(mdp->IncorporateUntilAction(trajectories), DynaPlex::Error);
+        EXPECT_THROW(mdp->IncorporateAction(trajectories), DynaPlex::Error);
+        EXPECT_THROW(mdp->GetFlatFeatures(trajectories, feats), DynaPlex::Error);
+        EXPECT_THROW(mdp->GetMask(trajectories, mask), DynaPlex::Error);
+
+        mdp->InitiateState({ &trajectories[1],1 });
+        trajectories[2].Category = StateCategory::AwaitEvent();
+        EXPECT_THROW(mdp->IncorporateAction(trajectories), DynaPlex::Error);
+        EXPECT_THROW(mdp->GetFlatFeatures(trajectories, feats), DynaPlex::Error);
+        EXPECT_THROW(mdp->GetMask(trajectories, mask), DynaPlex::Error);
+
+        trajectories[2].Category = StateCategory::AwaitAction();
+        EXPECT_NO_THROW(mdp->GetFlatFeatures(trajectories, feats));
+        EXPECT_NO_THROW(mdp->IncorporateAction(trajectories));
+    }
 }
\ No newline at end of file
@@ -0,0 +1,79 @@
+#include <vector>
+#include <atomic>
+#include <numeric>
+#include "dynaplex/error.h"
+#include "dynaplex/threadpool.h"
+#include "dynaplex/parallel_execute.h"
+#include "dynaplex/dynaplexprovider.h"
+#include <gtest/gtest.h>
+
+namespace DynaPlex::Tests {
+
+	TEST(ThreadPool, covers_all_items_once) {
+		DynaPlex::Parallel::ThreadPool pool(4);
+		for (int64_t total : {0, 1, 3, 17, 1000})
+		{
+			std::vector<std::atomic<int64_t>> visits(total);
+			pool.ForEach(total, 64, [&](int64_t begin, int64_t end) {
+				for (int64_t i = begin; i < end; i++)
+					visits[i]++;
+				});
+			for (auto& count : visits)
+				EXPECT_EQ(count.load(), 1);
+		}
+	}
+
+	TEST(ThreadPool, propagates_exceptions) {
+		DynaPlex::Parallel::ThreadPool pool(3);
+		EXPECT_THROW(pool.ForEach(100, 10, [](int64_t begin, int64_t end) {
+			if (begin <= 42 && 42 < end)
+				throw DynaPlex::Error("chunk failed");
+			}), DynaPlex::Error);
+		//pool remains usable:
+		std::atomic<int64_t> sum = 0;
+		pool.ForEach(10, 10, [&](int64_t begin, int64_t end) { sum += end - begin; });
+		EXPECT_EQ(sum.load(), 10);
+	}
+
+	TEST(ThreadPool, cancellation_skips_remaining_chunks) {
+		DynaPlex::Parallel::ThreadPool pool(1);
+		DynaPlex::Parallel::CancellationToken token;
+		std::atomic<int64_t> executed = 0;
+		pool.ForEach(100, 100, [&](int64_t begin, int64_t end) {
+			if (++executed == 5)
+				token.Cancel();
+			}, token);
+		EXPECT_TRUE(token.IsCancelled());
+		EXPECT_EQ(executed.load(), 5);
+	}
+
+	TEST(ThreadPool, nested_jobs) {
+		DynaPlex::Parallel::ThreadPool pool(2);
+		std::vector<int64_t> results(8, 0);
+		pool.ForEach(8, 8, [&](int64_t begin, int64_t end) {
+			for (int64_t i = begin; i < end; i++)
+			{
+				std::atomic<int64_t> inner = 0;
+				pool.ForEach(100, 10, [&](int64_t b, int64_t e) { inner += e - b; });
+				results[i] = inner;
+			}
+			});
+		for (auto r : results)
+			EXPECT_EQ(r, 100);
+	}
+
+	TEST(ThreadPool, parallel_compute_on_system_pool) {
+		auto& system = DynaPlexProvider::Get().System();
+		std::vector<int64_t> data(1234, 0);
+		DynaPlex::Parallel::parallel_compute<int64_t>(data, [](std::span<int64_t> span, int64_t start) {
+			for (size_t i = 0; i < span.size(); i++)
+				span[i] = start + i;
+			}, system.WorkerPool());
+		std::vector<int64_t> expected(1234);
+		std::iota(expected.begin(), expected.end(), 0);
+		EXPECT_EQ(data, expected);
+		//copies of system share the pool:
+		DynaPlex::System copy = system;
+		EXPECT_EQ(&copy.WorkerPool(), &system.WorkerPool());
+	}
+}
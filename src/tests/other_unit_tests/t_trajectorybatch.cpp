@@ -0,0 +1,211 @@
+#include <vector>
+#include <memory>
+#include "dynaplex/vargroup.h"
+#include "dynaplex/erasure/mdpadapter.h"
+#include "dynaplex/error.h"
+#include "dynaplex/rng.h"
+#include "dynaplex/statecategory.h"
+#include "dynaplex/features.h"
+#include "dynaplex/modelling/discretedist.h"
+#include "dynaplex/trajectory.h"
+#include "dynaplex/trajectoryspanbatch.h"
+#include <gtest/gtest.h>
+
+namespace DynaPlex::Tests {
+
+	namespace AddOn::BatchProblem {
+		//small inventory problem with random demand; used to compare the trajectory-based and batch-based paths.
+		class MDP
+		{
+		public:
+			struct State {
+				DynaPlex::StateCategory cat;
+				int64_t inventory;
+				std::vector<int64_t> pipeline;
+				VarGroup ToVarGroup() const
+				{
+					VarGroup vars;
+					vars.Add("inventory", inventory);
+					vars.Add("pipeline", pipeline);
+					return vars;
+				}
+				bool operator==(const State& other) const = default;
+			};
+			using Event = int64_t;
+		private:
+			DiscreteDist dist;
+			int64_t max_order;
+		public:
+			double ModifyStateWithAction(State& state, int64_t action) const
+			{
+				state.pipeline.push_back(action);
+				state.cat = StateCategory::AwaitEvent();
+				return 0.0;
+			}
+			double ModifyStateWithEvent(State& state, const Event& demand) const
+			{
+				state.inventory += state.pipeline.front();
+				state.pipeline.erase(state.pipeline.begin());
+				state.inventory = std::max<int64_t>(state.inventory - demand, 0);
+				state.cat = StateCategory::AwaitAction();
+				return static_cast<double>(state.inventory);
+			}
+			Event GetEvent(DynaPlex::RNG& rng) const
+			{
+				return dist.GetSample(rng);
+			}
+			void GetFeatures(const State& state, DynaPlex::Features& features) const
+			{
+				features.Add(state.inventory);
+				features.Add(state.pipeline);
+			}
+			bool IsAllowedAction(const State& state, int64_t action) const
+			{
+				return action <= max_order;
+			}
+			DynaPlex::StateCategory GetStateCategory(const State& state) const
+			{
+				return state.cat;
+			}
+			State GetInitialState(DynaPlex::RNG& rng) const
+			{
+				return State{ StateCategory::AwaitEvent(), dist.GetSample(rng), {1,2} };
+			}
+			DynaPlex::VarGroup GetStaticInfo() const
+			{
+				DynaPlex::VarGroup vars;
+				vars.Add("valid_actions", max_order + 1);
+				vars.Add("discount_factor", 0.99);
+				return vars;
+			}
+			explicit MDP(const DynaPlex::VarGroup& vars)
+			{
+				vars.Get("dist", dist);
+				vars.Get("max_order", max_order);
+			}
+		};
+	}
+
+	TEST(trajectorybatch, equivalent_to_trajectories) {
+		using t_MDP = AddOn::BatchProblem::MDP;
+		DynaPlex::VarGroup vars;
+		vars.Add("id", "BatchProblem");
+		vars.Add("dist", DynaPlex::VarGroup({ {"type","poisson"}, {"mean",3.0} }));
+		vars.Add("max_order", 6);
+		auto adapter = std::make_shared<DynaPlex::Erasure::MDPAdapter<t_MDP>>(vars);
+		DynaPlex::MDP mdp = adapter;
+
+		const size_t num_traj = 37;
+		std::vector<DynaPlex::Trajectory> trajectories;
+		DynaPlex::Erasure::TrajectoryBatch<t_MDP> batch(num_traj);
+		for (size_t i = 0; i < num_traj; i++)
+		{
+			trajectories.emplace_back(i);
+			trajectories.back().RNGProvider.SeedEventStreams(true, 1234, i);
+			batch.RNGProvider[i].SeedEventStreams(true, 1234, i);
+		}
+		mdp->InitiateState(trajectories);
+		adapter->InitiateState(batch);
+		ASSERT_TRUE(batch.HasStates());
+
+		auto num_feats = mdp->NumFlatFeatures();
+		ASSERT_EQ(num_feats, 2);
+		std::vector<float> feats(num_feats * num_traj), batch_feats(num_feats * num_traj);
+		for (int64_t period = 0; period < 20; period++)
+		{
+			EXPECT_TRUE(mdp->IncorporateUntilAction(trajectories));
+			EXPECT_TRUE(adapter->IncorporateUntilAction(batch));
+			mdp->GetFlatFeatures(trajectories, feats);
+			adapter->GetFlatFeatures(batch, batch_feats);
+			ASSERT_EQ(feats, batch_feats);
+			for (size_t i = 0; i < num_traj; i++)
+			{
+				trajectories[i].NextAction = (period + i) % 7;
+				batch.NextAction[i] = (period + i) % 7;
+			}
+			mdp->IncorporateAction(trajectories);
+			adapter->IncorporateAction(batch);
+		}
+		for (size_t i = 0; i < num_traj; i++)
+		{
+			EXPECT_EQ(trajectories[i].CumulativeReturn, batch.CumulativeReturn[i]);
+			EXPECT_EQ(trajectories[i].PeriodCount, batch.PeriodCount[i]);
+			EXPECT_EQ(trajectories[i].EffectiveDiscountFactor, batch.EffectiveDiscountFactor[i]);
+			EXPECT_EQ(trajectories[i].Category, batch.Category[i]);
+			EXPECT_EQ(adapter->ToState(trajectories[i].GetState()), batch.States[i]);
+		}
+	}
+
+	TEST(trajectorybatch, partition_and_initiate_from_state) {
+		using t_MDP = AddOn::BatchProblem::MDP;
+		DynaPlex::VarGroup vars;
+		vars.Add("id", "BatchProblem");
+		vars.Add("dist", DynaPlex::VarGroup({ {"type","poisson"}, {"mean",3.0} }));
+		vars.Add("max_order", 6);
+		auto adapter = std::make_shared<DynaPlex::Erasure::MDPAdapter<t_MDP>>(vars);
+
+		DynaPlex::Erasure::TrajectoryBatch<t_MDP> batch(10);
+		for (size_t i = 0; i < batch.Size(); i++)
+			batch.RNGProvider[i].SeedEventStreams(false, 11, i);
+		EXPECT_THROW(adapter->IncorporateUntilAction(batch), DynaPlex::Error);
+
+		DynaPlex::Trajectory traj{};
+		traj.RNGProvider.SeedEventStreams(false);
+		static_cast<const DynaPlex::MDPInterface&>(*adapter).InitiateState({ &traj,1 });
+		adapter->InitiateState(batch, traj.GetState());
+		for (size_t i = 0; i < batch.Size(); i++)
+			EXPECT_EQ(batch.States[i], adapter->ToState(traj.GetState()));
+
+		auto split = batch.Partition(0, batch.Size(), [&](size_t i) { return batch.ExternalIndex[i] % 3 == 0; });
+		EXPECT_EQ(split, 4);
+		for (size_t i = 0; i < batch.Size(); i++)
+			EXPECT_EQ(batch.ExternalIndex[i] % 3 == 0, i < split);
+	}
+
+	TEST(trajectorybatch, create_trajectory_batch) {
+		using t_MDP = AddOn::BatchProblem::MDP;
+		DynaPlex::VarGroup vars;
+		vars.Add("id", "BatchProblem");
+		vars.Add("dist", DynaPlex::VarGroup({ {"type","poisson"}, {"mean",3.0} }));
+		vars.Add("max_order", 6);
+		DynaPlex::MDP mdp = std::make_shared<DynaPlex::Erasure::MDPAdapter<t_MDP>>(vars);
+		auto policy = mdp->GetPolicy("random");
+
+		const size_t num_traj = 23;
+		for (bool skip_trivial_actions : { true, false })
+		{
+			auto batch = mdp->CreateTrajectoryBatch(policy, num_traj);
+			ASSERT_TRUE(batch);
+			ASSERT_EQ(batch->Size(), num_traj);
+			std::vector<DynaPlex::Trajectory> trajectories(num_traj);
+			DynaPlex::TrajectorySpanBatch span_trajectories(*mdp, policy, trajectories);
+			DynaPlex::TrajectoryBatchInterface& span_batch = span_trajectories;
+			for (size_t i = 0; i < num_traj; i++)
+			{
+				batch->RNGProvider(i).SeedEventStreams(true, 4321, i);
+				span_batch.RNGProvider(i).SeedEventStreams(true, 4321, i);
+			}
+			batch->InitiateState();
+			span_batch.InitiateState();
+			batch->Evolve(5, skip_trivial_actions);
+			span_batch.Evolve(5, skip_trivial_actions);
+			batch->Evolve(12, skip_trivial_actions);
+			span_batch.Evolve(12, skip_trivial_actions);
+			for (size_t i = 0; i < num_traj; i++)
+			{
+				EXPECT_EQ(batch->CumulativeReturn(i), span_batch.CumulativeReturn(i));
+				EXPECT_EQ(batch->PeriodCount(i), 12);
+				EXPECT_EQ(span_batch.PeriodCount(i), 12);
+				EXPECT_EQ(batch->Category(i), span_batch.Category(i));
+			}
+			//every period requires an action:
+			EXPECT_THROW(batch->Evolve(20, skip_trivial_actions, 3), DynaPlex::Error);
+			EXPECT_THROW(span_batch.Evolve(20, skip_trivial_actions, 3), DynaPlex::Error);
+		}
+
+		//policies of other mdps cannot be used on a typed batch:
+		vars.Set("max_order", 5);
+		DynaPlex::MDP other_mdp = std::make_shared<DynaPlex::Erasure::MDPAdapter<t_MDP>>(vars);
+		EXPECT_FALSE(mdp->CreateTrajectoryBatch(other_mdp->GetPolicy("random"), num_traj));
+	}
+}
@@ -0,0 +1,72 @@
+#include "dynaplex/vargroup.h"
+#include "dynaplex/error.h"
+#include <gtest/gtest.h>
+#include "dynaplex/dynaplexprovider.h"
+#include "dynaplex/trajectory.h"
+#include "dynaplex/trajectorypool.h"
+
+namespace DynaPlex::Tests {
+
+	TEST(TrajectoryPool, recycles_states) {
+		auto& dp = DynaPlexProvider::Get();
+
+		DynaPlex::VarGroup config;
+		config.Add("id", "lost_sales");
+		config.Add("p", 9.0);
+		config.Add("h", 1.0);
+		config.Add("leadtime", 3);
+		config.Add("demand_dist", DynaPlex::VarGroup({
+			{"type", "poisson"},
+			{"mean", 4.0}
+			}));
+		DynaPlex::MDP mdp = dp.GetMDP(config);
+		auto policy = mdp->GetPolicy("base_stock");
+
+		DynaPlex::Trajectory root{};
+		root.RNGProvider.SeedEventStreams(false, 123);
+		mdp->InitiateState({ &root,1 });
+		mdp->IncorporateUntilAction({ &root,1 });
+
+		DynaPlex::TrajectoryPool pool{};
+		auto trajectories = pool.Get(8);
+		ASSERT_EQ(trajectories.size(), 8);
+		for (auto& traj : trajectories)
+			traj.RNGProvider.SeedEventStreams(false, 123, 0, traj.ExternalIndex);
+		mdp->InitiateState(trajectories, root.GetState());
+		std::vector<const DynaPlex::StateBase*> addresses;
+		for (auto& traj : trajectories)
+			addresses.push_back(traj.GetState().get());
+		//simulate, such that states diverge from root:
+		for (int64_t period = 0; period < 5; period++)
+		{
+			mdp->IncorporateAction(trajectories, policy);
+			mdp->IncorporateUntilAction(trajectories);
+		}
+		EXPECT_EQ(trajectories.front().PeriodCount, 5);
+
+		trajectories = pool.Get(8);
+		for (auto& traj : trajectories)
+		{
+			EXPECT_EQ(traj.PeriodCount, 0);
+			EXPECT_EQ(traj.CumulativeReturn, 0.0);
+		}
+		mdp->InitiateState(trajectories, root.GetState());
+		for (size_t i = 0; i < trajectories.size(); i++)
+		{
+			//same StateAdapter objects, but with value of root:
+			EXPECT_EQ(trajectories[i].GetState().get(), addresses[i]);
+			EXPECT_TRUE(mdp->StatesAreEqual(trajectories[i].GetState(), root.GetState()));
+			EXPECT_TRUE(trajectories[i].Category.IsAwaitAction());
+		}
+
+		//states of another mdp instance are replaced rather than recycled:
+		config.Set("leadtime", 2);
+		DynaPlex::MDP other_mdp = dp.GetMDP(config);
+		DynaPlex::Trajectory other_root{};
+		other_root.RNGProvider.SeedEventStreams(false, 123);
+		other_mdp->InitiateState({ &other_root,1 });
+		EXPECT_NO_THROW(other_mdp->InitiateState(trajectories, other_root.GetState()));
+		for (auto& traj : trajectories)
+			EXPECT_TRUE(other_mdp->StatesAreEqual(traj.GetState(), other_root.GetState()));
+	}
+}